@@ -0,0 +1,1083 @@
+#include <QTest>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QAbstractItemModel>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QThread>
+
+#include "databasemanager.h"
+#include "filetransferengine.h"
+#include "importprocessor.h"
+#include "samplehash.h"
+
+#include <algorithm>
+
+class TestDatabaseManager : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+
+    void testConnectionProfileIsApplied();
+    void testCloseCheckpointsWal();
+    void testStatementCacheReusesStatements();
+    void testBulkImport();
+    void testNameDictionary();
+    void testJournalDayQueries();
+    void testJournalQueryPlans_data();
+    void testJournalQueryPlans();
+    void testPracticeCalendar();
+    void testBackgroundConnection();
+    void testReadConnections();
+    void testSettingsCache();
+    void testImportProcessor();
+    void testImportJournal();
+    void testFailedResumeRemovesEarlierCopies();
+    void testRehashAfterAlgorithmChange();
+    void benchmarkCalendar_data();
+    void benchmarkCalendar();
+    void testMigrationFromFixture_data();
+    void testMigrationFromFixture();
+    void testMigratorRollsBackFailedStep();
+    void benchmarkImport_data();
+    void benchmarkImport();
+    void benchmarkJournalCommits_data();
+    void benchmarkJournalCommits();
+
+private:
+    [[nodiscard]] QString pragma(const QString &name);
+    [[nodiscard]] qlonglong count(const QString &sql);
+    [[nodiscard]] QStringList queryPlan(const QString &sql, int bindValues);
+    [[nodiscard]] bool createFixture(int version);
+    [[nodiscard]] static QList<ImportTask> importTasks(int files, int first = 0);
+    [[nodiscard]] static QList<ImportSong> importSongs(int files, int first = 0);
+
+    QTemporaryDir dir_m;
+    QString dbPath_m;
+};
+
+void TestDatabaseManager::init() {
+    QVERIFY(dir_m.isValid());
+    dbPath_m = dir_m.filePath(QString("%1.db").arg(QTest::currentTestFunction()));
+    QFile::remove(dbPath_m);
+}
+
+void TestDatabaseManager::cleanup() {
+    DatabaseManager::instance().closeDatabase();
+    DatabaseManager::instance().setConnectionProfile(ConnectionProfile());
+}
+
+QString TestDatabaseManager::pragma(const QString &name) {
+    QSqlQuery q(QSqlDatabase::database());
+    if (!q.exec(QString("PRAGMA %1;").arg(name)) || !q.next()) return QString();
+    return q.value(0).toString();
+}
+
+qlonglong TestDatabaseManager::count(const QString &sql) {
+    QSqlQuery q(QSqlDatabase::database());
+    if (!q.exec(sql) || !q.next()) return -1;
+    return q.value(0).toLongLong();
+}
+
+QStringList TestDatabaseManager::queryPlan(const QString &sql, int bindValues) {
+    QSqlQuery q(QSqlDatabase::database());
+    q.prepare("EXPLAIN QUERY PLAN " + sql);
+    for (int i = 0; i < bindValues; ++i) {
+        q.addBindValue(i == 0 ? QVariant(1) : QVariant("2024-01-01"));
+    }
+    QStringList details;
+    if (!q.exec()) return details;
+    while (q.next()) {
+        details << q.value("detail").toString();
+    }
+    return details;
+}
+
+// Databases as older releases left them (PRAGMA user_version = version)
+bool TestDatabaseManager::createFixture(int version) {
+    if (version == 0) return true; // New, empty file
+
+    // Tables of the first release; createInitialTables() adds the ones not listed here
+    QStringList statements = {
+        "CREATE TABLE users (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE, role TEXT, "
+        "created_at DATETIME DEFAULT CURRENT_TIMESTAMP)",
+        "CREATE TABLE songs (id INTEGER PRIMARY KEY AUTOINCREMENT, user_id INTEGER NOT NULL DEFAULT 1, title TEXT, "
+        "artist_id INTEGER, tuning_id INTEGER, base_bpm INTEGER, total_bars INTEGER, current_bpm INTEGER DEFAULT 0, "
+        "is_favorite INTEGER DEFAULT 0, updated_at DATETIME DEFAULT CURRENT_TIMESTAMP)",
+        QString("CREATE TABLE media_files (id INTEGER PRIMARY KEY AUTOINCREMENT, song_id INTEGER, file_path TEXT UNIQUE, "
+                "is_managed INTEGER DEFAULT 0, file_type TEXT, file_size INTEGER, file_hash %1 UNIQUE, "
+                "can_be_practiced BOOL, FOREIGN KEY(song_id) REFERENCES songs(id) ON DELETE CASCADE)")
+            .arg(version == 1 ? "TEXT" : "INTEGER"),
+        "CREATE TABLE practice_journal (id INTEGER PRIMARY KEY AUTOINCREMENT, user_id INTEGER NOT NULL DEFAULT 1, "
+        "song_id INTEGER, practice_date DATETIME DEFAULT CURRENT_TIMESTAMP, start_bar INTEGER, end_bar INTEGER, "
+        "practiced_bpm INTEGER, total_reps INTEGER, successful_streaks INTEGER, rating INTEGER, note_text TEXT)",
+        "CREATE TABLE settings (key TEXT PRIMARY KEY, value TEXT)",
+        "CREATE TABLE artists (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+        "CREATE TABLE tunings (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+        "CREATE INDEX idx_filepath ON media_files(file_path)",
+        "INSERT INTO artists (id, name) VALUES (1, 'Fixture Artist')",
+        "INSERT INTO songs (id, title, artist_id) VALUES (1, 'Fixture Song', 1)",
+        QString("INSERT INTO media_files (song_id, file_path, file_type, file_size, file_hash) "
+                "VALUES (1, 'fixture.gp5', 'gp5', 100, %1)")
+            .arg(version == 1 ? "'00000000000000FF'" : "255"),
+        "INSERT INTO practice_journal (song_id, practice_date, note_text) VALUES (1, '2024-03-05', 'kept')",
+    };
+
+    if (version >= 2) {
+        statements << "CREATE TABLE scan_cache (file_path TEXT PRIMARY KEY, file_size INTEGER NOT NULL, "
+                      "mtime INTEGER NOT NULL, inode INTEGER DEFAULT 0, file_hash INTEGER NOT NULL, "
+                      "scanned_at DATETIME DEFAULT CURRENT_TIMESTAMP)"
+                   << "CREATE INDEX idx_journal_song_date ON practice_journal(song_id, practice_date)"
+                   << "CREATE INDEX idx_journal_date_song ON practice_journal(practice_date, song_id)";
+    }
+    statements << QString("PRAGMA user_version = %1").arg(version);
+
+    bool ok = true;
+    {
+        QSqlDatabase fixture = QSqlDatabase::addDatabase("QSQLITE", "fixture");
+        fixture.setDatabaseName(dbPath_m);
+        ok = fixture.open();
+        QSqlQuery q(fixture);
+        for (const QString &sql : std::as_const(statements)) {
+            if (!ok) break;
+            ok = q.exec(sql);
+            if (!ok) qWarning() << sql << q.lastError().text();
+        }
+        q.finish();
+        fixture.close();
+    }
+    QSqlDatabase::removeDatabase("fixture");
+    return ok;
+}
+
+QList<ImportTask> TestDatabaseManager::importTasks(int files, int first) {
+    QList<ImportTask> tasks;
+    for (int i = first; i < first + files; ++i) {
+        ImportTask task;
+        task.sourcePath = QString("/music/source/song_%1.gp5").arg(i);
+        task.relativePath = QString("Imported/song_%1.gp5").arg(i);
+        task.itemName = QString("song_%1.gp5").arg(i);
+        task.fileSize = 1000 + i;
+        task.fileSuffix = "gp5";
+        task.fileHash = FileHash{quint64(i + 1) * 0x9E3779B97F4A7C15ULL, 0};
+        tasks.append(task);
+    }
+    return tasks;
+}
+
+QList<ImportSong> TestDatabaseManager::importSongs(int files, int first) {
+    QList<ImportSong> songs;
+    for (int i = first; i < first + files; ++i) {
+        ImportSong song;
+        song.title = QString("Song %1").arg(i);
+        song.artist = QString("Artist %1").arg(i % 50);
+        song.tuning = i % 2 ? "Drop D" : "E-Standard";
+        song.bpm = 60 + i % 120;
+        songs.append(song);
+    }
+    return songs;
+}
+
+void TestDatabaseManager::testConnectionProfileIsApplied() {
+    QVERIFY(DatabaseManager::instance().initDatabase(dbPath_m));
+
+    QCOMPARE(pragma("journal_mode"), QString("wal"));
+    QCOMPARE(pragma("synchronous"), QString("1")); // NORMAL
+    QCOMPARE(pragma("temp_store"), QString("2"));  // MEMORY
+    QCOMPARE(pragma("cache_size"), QString::number(-ConnectionProfile().cacheSizeKiB));
+    QCOMPARE(pragma("foreign_keys"), QString("1"));
+}
+
+void TestDatabaseManager::testCloseCheckpointsWal() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    const qlonglong songId = db.createSong("Checkpoint");
+    QVERIFY(songId > 0);
+    QVERIFY(db.updateSongNotes(int(songId), "note", QDate::currentDate()));
+    db.closeDatabase();
+
+    // Everything is in the main file, so it can be renamed or copied on its own
+    const QFileInfo wal(dbPath_m + "-wal");
+    QVERIFY(!wal.exists() || wal.size() == 0);
+
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.getNoteForDay(int(songId), QDate::currentDate()), QString("note"));
+}
+
+void TestDatabaseManager::testStatementCacheReusesStatements() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+    db.resetStatementCacheStats();
+
+    // getSetting() is served by the settings cache, only the writes reach SQLite
+    QVERIFY(db.setSetting("cache_test", "a"));
+    QCOMPARE(db.getSetting("cache_test", QString()), QString("a"));
+    const StatementCache::Stats first = db.statementCacheStats();
+    QCOMPARE(first.hits, quint64(0));
+    QCOMPARE(first.misses, quint64(1));
+
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(db.setSetting("cache_test", QString::number(i)));
+        QCOMPARE(db.getSetting("cache_test", QString()), QString::number(i));
+    }
+    const StatementCache::Stats second = db.statementCacheStats();
+    QCOMPARE(second.hits, quint64(10));
+    QCOMPARE(second.misses, quint64(1));
+
+    // A statement still in use is not handed out twice
+    StatementCache cache;
+    {
+        StatementCache::Handle outer = cache.acquire(QSqlDatabase::database(), "SELECT 1");
+        StatementCache::Handle inner = cache.acquire(QSqlDatabase::database(), "SELECT 1");
+        QVERIFY(&*outer != &*inner);
+        QVERIFY(outer->exec() && outer->next());
+        QVERIFY(inner->exec() && inner->next());
+    }
+    {
+        StatementCache::Handle again = cache.acquire(QSqlDatabase::database(), "SELECT 1");
+        QCOMPARE(cache.stats().hits, quint64(1));
+        QCOMPARE(cache.stats().statements, qsizetype(1));
+    }
+    cache.clear(QSqlDatabase::database().connectionName());
+
+    // Cached statements belong to the connection and are dropped with it
+    db.closeDatabase();
+    QCOMPARE(db.statementCacheStats().statements, qsizetype(0));
+}
+
+void TestDatabaseManager::testBulkImport() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    // Existing data: ids must continue after it, known artists are reused
+    const qlonglong existing = db.createSong("Existing", "Artist 7", "Drop D", 100);
+    QVERIFY(existing > 0);
+
+    // More rows than fit into one statement
+    constexpr int files = 1000;
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.bulkImport(importTasks(files), importSongs(files), true));
+    QVERIFY(db.commit());
+
+    QCOMPARE(count("SELECT COUNT(*) FROM songs"), qlonglong(files + 1));
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files"), qlonglong(files));
+    QCOMPARE(count("SELECT COUNT(*) FROM artists WHERE name LIKE 'Artist %'"), qlonglong(50));
+    QCOMPARE(count("SELECT COUNT(*) FROM tunings WHERE name IN ('Drop D', 'E-Standard')"), qlonglong(2));
+    QCOMPARE(count("SELECT MIN(id) FROM songs WHERE title != 'Existing'"), existing + 1);
+
+    // Every file belongs to the song created for it
+    const DatabaseManager::SongDetails details = db.getSongDetails(existing + 1 + 123);
+    QCOMPARE(details.title, QString("Song 123"));
+    QCOMPARE(details.artist, QString("Artist 23"));
+    QCOMPARE(details.tuning, QString("Drop D"));
+    QCOMPARE(details.bpm, 60 + 123);
+    QCOMPARE(count(QString("SELECT song_id FROM media_files WHERE file_path = 'Imported/song_123.gp5'")),
+             existing + 1 + 123);
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files WHERE can_be_practiced = 1 AND is_managed = 1"), qlonglong(files));
+
+    // Files already in the database are skipped like in addFileToSong
+    QList<qlonglong> songIds;
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.bulkImport(importTasks(10, files - 5), importSongs(10, files - 5), true, &songIds));
+    QVERIFY(db.commit());
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files"), qlonglong(files + 5));
+
+    // The reported ids are the ones SQLite assigned
+    QCOMPARE(songIds.size(), 10);
+    for (qsizetype i = 0; i < songIds.size(); ++i) {
+        QCOMPARE(db.getSongDetails(songIds.at(i)).title, QString("Song %1").arg(files - 5 + i));
+    }
+
+    QVERIFY(!db.bulkImport(importTasks(2), importSongs(1), true));
+}
+
+void TestDatabaseManager::testNameDictionary() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    QAbstractItemModel *model = db.artistModel();
+    const int rowsBefore = model->rowCount();
+
+    const int id = db.getOrCreateArtist("  Zappa ");
+    QVERIFY(id > 0);
+    QCOMPARE(model->rowCount(), rowsBefore + 1);
+    QVERIFY(db.getAllArtists().contains("Zappa"));
+
+    // Known names are answered from memory
+    db.resetStatementCacheStats();
+    QCOMPARE(db.getOrCreateArtist("Zappa"), id);
+    QCOMPARE(db.getAllArtists().count("Zappa"), 1);
+    QCOMPARE(db.statementCacheStats().hits + db.statementCacheStats().misses, quint64(0));
+
+    // The model stays sorted on insert and rename
+    QVERIFY(db.getOrCreateArtist("Abba") > 0);
+    QVERIFY(db.renameArtist(id, "Beatles"));
+    QStringList names;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        names << model->index(row, 0).data().toString();
+    }
+    QVERIFY(names.contains("Beatles"));
+    QVERIFY(!names.contains("Zappa"));
+    QVERIFY(std::is_sorted(names.cbegin(), names.cend()));
+    QCOMPARE(db.getOrCreateArtist("Beatles"), id);
+    QCOMPARE(db.getSongDetails(db.createSong("Yesterday", "Beatles")).artist, QString("Beatles"));
+
+    // Names inserted in a rolled back transaction are not kept
+    QVERIFY(db.beginTransaction());
+    const int temporary = db.getOrCreateTuning("Open G");
+    QVERIFY(temporary > 0);
+    db.rollback();
+    QVERIFY(!db.getAllTunings().contains("Open G"));
+    const int tuningId = db.getOrCreateTuning("Open G");
+    QVERIFY(tuningId > 0);
+    QCOMPARE(count(QString("SELECT COUNT(*) FROM tunings WHERE id = %1 AND name = 'Open G'").arg(tuningId)), qlonglong(1));
+
+    // The writer keeps its dictionaries between imports and reads only the new names
+    const auto importOnWriter = [&db](int files, int first) {
+        return db.enqueueWrite([&db, files, first]() {
+            return db.beginTransaction() && db.bulkImport(importTasks(files, first), importSongs(files, first), true)
+                   && db.commit();
+        }).result();
+    };
+    QVERIFY(importOnWriter(100, 0));
+    db.resetStatementCacheStats();
+    QVERIFY(importOnWriter(100, 100)); // Same artists and tunings
+    QCOMPARE(db.statementCacheStats().hits + db.statementCacheStats().misses, quint64(2)); // Songs, files
+
+    // A rename on the GUI thread reaches the writer
+    const int artist7 = db.getOrCreateArtist("Artist 7");
+    QVERIFY(db.renameArtist(artist7, "Artist Seven"));
+    QVERIFY(importOnWriter(10, 200));
+    QCOMPARE(db.getSongDetails(count("SELECT id FROM songs WHERE title = 'Song 207'")).artist, QString("Artist 7"));
+    QVERIFY(count("SELECT id FROM artists WHERE name = 'Artist 7'") != artist7);
+}
+
+void TestDatabaseManager::testJournalDayQueries() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.getDatabaseVersion(), 4);
+
+    const qlonglong songId = db.createSong("Journal");
+    QVERIFY(songId > 0);
+
+    // Entries written by the app ("yyyy-MM-dd") and by the column default (with a time)
+    QSqlQuery q(QSqlDatabase::database());
+    QVERIFY(q.exec(QString("INSERT INTO practice_journal (song_id, practice_date, start_bar, end_bar) VALUES "
+                           "(%1, '2024-03-05', 1, 8), (%1, '2024-03-05 23:59:59', 9, 16), "
+                           "(%1, '2024-03-06 00:00:00', 17, 24), (%1, '2024-03-04 12:00:00', 25, 32)")
+                       .arg(songId)));
+
+    QCOMPARE(db.getSessionsForDay(int(songId), QDate(2024, 3, 5)).size(), 2);
+    QCOMPARE(db.getSessionsForDay(int(songId), QDate(2024, 3, 6)).size(), 1);
+    QVERIFY(db.getPracticedSongsForDay(QDate(2024, 3, 5)).contains(int(songId)));
+    QVERIFY(db.getPracticedSongsForDay(QDate(2024, 3, 7)).isEmpty());
+    QCOMPARE(db.getPracticeSummaryForDay(QDate(2024, 3, 4)), QString("• Journal"));
+    QCOMPARE(db.getAllPracticeDates().size(), 3);
+}
+
+void TestDatabaseManager::testJournalQueryPlans_data() {
+    QTest::addColumn<QString>("sql");
+    QTest::addColumn<int>("bindValues");
+
+    // Same statements as in DatabaseManager
+    QTest::newRow("getSessionsForDay")
+        << QString("SELECT practice_date, start_bar, end_bar, practiced_bpm, total_reps, successful_streaks "
+                   "FROM practice_journal "
+                   "WHERE song_id = ? AND practice_date >= ? AND practice_date < ? "
+                   "AND start_bar IS NOT NULL")
+        << 3;
+    QTest::newRow("updateSongNotes")
+        << QString("SELECT id FROM practice_journal "
+                   "WHERE song_id = ? AND practice_date >= ? AND practice_date < ?")
+        << 3;
+    QTest::newRow("getPracticedSongsForDay")
+        << QString("SELECT s.id, s.title FROM songs s "
+                   "JOIN practice_journal pj ON s.id = pj.song_id "
+                   "WHERE pj.practice_date >= ? AND pj.practice_date < ? "
+                   "GROUP BY s.id")
+        << 2;
+    QTest::newRow("getAllPracticeDates") << QString("SELECT DISTINCT DATE(practice_date) FROM practice_journal") << 0;
+}
+
+// practice_journal must never be read row by row; only index searches and scans of a covering index
+void TestDatabaseManager::testJournalQueryPlans() {
+    QFETCH(QString, sql);
+    QFETCH(int, bindValues);
+
+    QVERIFY(DatabaseManager::instance().initDatabase(dbPath_m));
+
+    const QStringList plan = queryPlan(sql, bindValues);
+    QVERIFY(!plan.isEmpty());
+
+    bool usesJournalIndex = false;
+    for (const QString &detail : plan) {
+        const bool journal = detail.contains("practice_journal") || detail.contains(" pj ") || detail.endsWith(" pj");
+        if (!journal) continue;
+        QVERIFY2(detail.contains("idx_journal_"), qPrintable(plan.join(" | ")));
+        QVERIFY2(!detail.startsWith("SCAN") || detail.contains("COVERING INDEX"), qPrintable(plan.join(" | ")));
+        usesJournalIndex = true;
+    }
+    QVERIFY2(usesJournalIndex, qPrintable(plan.join(" | ")));
+}
+
+void TestDatabaseManager::testPracticeCalendar() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    const int songA = int(db.createSong("Alpha"));
+    const int songB = int(db.createSong("Beta"));
+    QSqlQuery q(QSqlDatabase::database());
+    QVERIFY(q.exec(QString("INSERT INTO practice_journal (song_id, practice_date, practiced_bpm, total_reps) VALUES "
+                           "(%1, '2024-02-29', 90, 3), "            // Before the range
+                           "(%1, '2024-03-01', 100, 5), (%1, '2024-03-01 18:00:00', 120, 2), "
+                           "(%2, '2024-03-01', 80, 4), "
+                           "(%2, '2024-03-31 23:00:00', 140, 1), "
+                           "(%2, '2024-04-01', 150, 1)")              // After the range
+                       .arg(songA).arg(songB)));
+
+    const QMap<QDate, PracticeDay> days = db.getPracticeCalendar(QDate(2024, 3, 1), QDate(2024, 3, 31));
+    QCOMPARE(days.keys(), (QList<QDate>{QDate(2024, 3, 1), QDate(2024, 3, 31)}));
+
+    const PracticeDay first = days.value(QDate(2024, 3, 1));
+    QCOMPARE(first.songTitles, (QStringList{"Alpha", "Beta"}));
+    QCOMPARE(first.totalReps, 11);
+    QCOMPARE(first.maxBpm, 120);
+    QCOMPARE(days.value(QDate(2024, 3, 31)).songTitles, QStringList{"Beta"});
+
+    // Same songs as the per-day summary
+    QCOMPARE(db.getPracticeSummaryForDay(QDate(2024, 3, 1)), QString("• Alpha\n• Beta"));
+}
+
+void TestDatabaseManager::testBackgroundConnection() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    constexpr int files = 1234; // Catalog in several chunks
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.bulkImport(importTasks(files), importSongs(files), true));
+    QVERIFY(db.commit());
+
+    // Same rows as on the default connection
+    const QList<DatabaseManager::SongDetails> expected = db.getFilteredFiles(true, false, false, false, false);
+    const QList<DatabaseManager::SongDetails> songs = db.getFilteredFilesAsync(true, false, false, false, false).result();
+    QCOMPARE(songs.size(), expected.size());
+    QCOMPARE(songs.first().fullPath, expected.first().fullPath);
+    QCOMPARE(songs.last().fullPath, expected.last().fullPath);
+
+    QFuture<DatabaseManager::CatalogEntry> catalog = db.getCatalogAsync();
+    catalog.waitForFinished();
+    const QList<DatabaseManager::CatalogEntry> entries = catalog.results();
+    QCOMPARE(entries.size(), files);
+    QVERIFY(std::is_sorted(entries.cbegin(), entries.cend(),
+                           [](const auto &a, const auto &b) { return a.filePath < b.filePath; }));
+
+    // Writes run one after another on the worker thread and are visible on the default connection
+    QList<int> order;
+    QThread *writer = nullptr;
+    QList<QFuture<bool>> writes;
+    for (int i = 0; i < 5; ++i) {
+        writes << db.enqueueWrite([&db, &order, &writer, i]() {
+            order << i;
+            writer = QThread::currentThread();
+            return db.setSetting("async_write", i);
+        });
+    }
+    QVERIFY(writes.last().result());
+    QCOMPARE(order, (QList<int>{0, 1, 2, 3, 4}));
+    QVERIFY(writer != QThread::currentThread());
+    QCOMPARE(db.getSetting("async_write", QString()), QString("4"));
+
+    // Queued writes are finished before the database closes
+    QFuture<bool> pending = db.enqueueWrite([&db]() { return db.setSetting("async_close", 1); });
+    db.closeDatabase();
+    QVERIFY(pending.isFinished());
+    QVERIFY(pending.result());
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.getSetting("async_close", QString()), QString("1"));
+}
+
+void TestDatabaseManager::testReadConnections() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.readConnectionCount(), ConnectionProfile().readConnections);
+
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.bulkImport(importTasks(10), importSongs(10), true));
+    QVERIFY(db.commit());
+
+    // Readers see the last commit, not the open transaction of another connection
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.bulkImport(importTasks(5, 10), importSongs(5, 10), true));
+    QCOMPARE(db.getCatalogAsync().results().size(), 10);
+    QVERIFY(db.commit());
+    QCOMPARE(db.getCatalogAsync().results().size(), 15);
+
+    // A read does not queue behind a running write
+    QSemaphore writing;
+    QSemaphore release;
+    QFuture<bool> write = db.enqueueWrite([&writing, &release]() {
+        writing.release();
+        release.acquire();
+        return true;
+    });
+    writing.acquire();
+
+    QFuture<DatabaseManager::CatalogEntry> catalog = db.getCatalogAsync();
+    QDeadlineTimer deadline(5000);
+    while (!catalog.isFinished() && !deadline.hasExpired()) {
+        QThread::msleep(1);
+    }
+    const bool readAlongside = catalog.isFinished();
+    release.release();
+    QVERIFY(write.result());
+    QVERIFY(readAlongside);
+    QCOMPARE(catalog.results().size(), 15);
+
+    // Without WAL the reads run on the writer
+    db.closeDatabase();
+    db.setConnectionProfile(ConnectionProfile::sqliteDefaults());
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.readConnectionCount(), 0);
+    QCOMPARE(db.getCatalogAsync().results().size(), 15);
+}
+
+void TestDatabaseManager::testSettingsCache() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+    QSignalSpy changed(&db, &DatabaseManager::settingChanged);
+
+    QVERIFY(!db.setting<bool>("is_managed"));
+    QVERIFY(db.setSetting("is_managed", true));
+    QVERIFY(db.setSetting("managed_path", "/music/library"));
+    QVERIFY(db.setting<bool>("is_managed"));
+    QCOMPARE(db.setting<int>("missing", 7), 7);
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(changed.at(1).at(0).toString(), QString("managed_path"));
+    QCOMPARE(changed.at(1).at(1).toString(), QString("/music/library"));
+
+    // Same value again: no signal
+    QVERIFY(db.setSetting("is_managed", true));
+    QCOMPARE(changed.count(), 2);
+
+    // Reads come from memory, e.g. the managed path for every row of getFilteredFiles()
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.bulkImport(importTasks(100), importSongs(100), true));
+    QVERIFY(db.commit());
+    db.resetStatementCacheStats();
+    QCOMPARE(db.getFilteredFiles(true, false, false, false, false).size(), 100);
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(db.getManagedPath(), QString("/music/library"));
+    }
+    const StatementCache::Stats stats = db.statementCacheStats();
+    QCOMPARE(stats.hits + stats.misses, quint64(0));
+
+    // A rolled back value is not kept
+    QVERIFY(db.beginTransaction());
+    QVERIFY(db.setSetting("managed_path", "/elsewhere"));
+    QCOMPARE(db.getManagedPath(), QString("/elsewhere"));
+    db.rollback();
+    QCOMPARE(db.getManagedPath(), QString("/music/library"));
+
+    // Written on the writer connection, visible on the default one
+    QVERIFY(db.enqueueWrite([&db]() { return db.setSetting("last_import_date", "2024-03-01"); }).result());
+    QCOMPARE(db.getSetting("last_import_date", QString()), QString("2024-03-01"));
+}
+
+void TestDatabaseManager::testImportProcessor() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    const QString source = dir_m.filePath("import_source");
+    const QString library = dir_m.filePath("import_library");
+    QVERIFY(QDir().mkpath(source));
+
+    QList<ImportTask> tasks;
+    for (int i = 0; i < 20; ++i) {
+        ImportTask task;
+        task.itemName = QString("track_%1.mp3").arg(i);
+        task.sourcePath = source + "/" + task.itemName;
+        task.relativePath = "Audio/" + task.itemName;
+        task.fileSuffix = "mp3";
+        task.fileSize = 100;
+        task.fileHash = FileHash{quint64(i + 1) * 0x9E3779B97F4A7C15ULL, 0};
+        tasks.append(task);
+
+        QFile file(task.sourcePath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(100, char('a' + i)));
+    }
+
+    // Canceled halfway: nothing in the database, the files moved so far are back
+    {
+        ImportProcessor processor;
+        connect(&processor, &ImportProcessor::progressUpdated, &processor, [&processor](int value) {
+            if (value == 5)
+                processor.cancel();
+        }, Qt::DirectConnection); // On the import thread, before the next file
+        QSignalSpy finished(&processor, &ImportProcessor::finished);
+        processor.start(tasks, library, true, true);
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(finished.at(0).at(0).toBool(), false);
+        QVERIFY(processor.wasCanceled());
+    }
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files"), qlonglong(0));
+    QCOMPARE(count("SELECT COUNT(*) FROM songs"), qlonglong(0));
+    QCOMPARE(QDir(source).entryList(QDir::Files).size(), 20);
+    QCOMPARE(QDir(library + "/Audio").entryList(QDir::Files).size(), 0);
+
+    // Complete import (copy mode)
+    {
+        ImportProcessor processor;
+        QSignalSpy progress(&processor, &ImportProcessor::progressUpdated);
+        QSignalSpy finished(&processor, &ImportProcessor::finished);
+        processor.start(tasks, library, true, false);
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(finished.at(0).at(0).toBool(), true);
+        QCOMPARE(progress.last().at(0).toInt(), 20);
+
+        const ImportProcessor::StageUtilisation utilisation = processor.stageUtilisation();
+        for (const double stage : {utilisation.copy, utilisation.parse, utilisation.write}) {
+            QVERIFY(stage >= 0.0 && stage <= 1.0);
+        }
+        QVERIFY(utilisation.write > 0.0);
+    }
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files WHERE is_managed = 1"), qlonglong(20));
+    QCOMPARE(QDir(library + "/Audio").entryList(QDir::Files).size(), 20);
+    QCOMPARE(QDir(source).entryList(QDir::Files).size(), 20);
+    QCOMPARE(db.getManagedPath(), library);
+
+    // More rows than one insert batch; the files need not exist for an unmanaged import
+    {
+        ImportProcessor processor;
+        QSignalSpy finished(&processor, &ImportProcessor::finished);
+        processor.start(importTasks(1200, 100), library, false, false);
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(finished.at(0).at(0).toBool(), true);
+    }
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files WHERE is_managed = 0"), qlonglong(1200));
+    QCOMPARE(count("SELECT COUNT(DISTINCT song_id) FROM media_files"), qlonglong(1220));
+
+    QCOMPARE(ImportProcessor::remainingText(-1), QString());
+    QCOMPARE(ImportProcessor::remainingText(90 * 1000), QString("about 2 min left"));
+}
+
+void TestDatabaseManager::testImportJournal() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.unfinishedImportJob(), qlonglong(0));
+
+    const QString source = dir_m.filePath("journal_source");
+    const QString library = dir_m.filePath("journal_library");
+    QVERIFY(QDir().mkpath(source));
+    QVERIFY(QDir().mkpath(library + "/Audio"));
+
+    QList<ImportTask> tasks;
+    for (int i = 0; i < 10; ++i) {
+        ImportTask task;
+        task.itemName = QString("take_%1.mp3").arg(i);
+        task.sourcePath = source + "/" + task.itemName;
+        task.relativePath = "Audio/" + task.itemName;
+        task.fileSuffix = "mp3";
+        task.fileSize = 100;
+        task.fileHash = FileHash{quint64(i + 1) * 0x9E3779B97F4A7C15ULL, 0};
+        tasks.append(task);
+
+        QFile file(task.sourcePath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(100, char('a' + i)));
+    }
+    const auto target = [&](int task) { return library + "/" + tasks.at(task).relativePath; };
+
+    // A move-mode import the application died in: task 0 is committed, task 1 was moved
+    // after the last checkpoint, task 2 was being copied
+    const auto crash = [&]() {
+        const qlonglong jobId = db.createImportJob(tasks, library, true, true);
+        if (jobId == 0) return jobId;
+
+        QList<ImportJournalEntry> reserved;
+        for (int i = 0; i < tasks.size(); ++i) {
+            reserved.append({i, ImportState::Pending, target(i), ImportFileOperation::None, 0});
+        }
+
+        QList<qlonglong> songIds;
+        if (!db.updateImportJournal(jobId, reserved)
+            || !QFile::rename(tasks.at(0).sourcePath, target(0))
+            || !db.bulkImport({tasks.at(0)}, importSongs(1), true, &songIds)
+            || !db.updateImportJournal(jobId, {{0, ImportState::Copied, target(0), ImportFileOperation::Moved, 0},
+                                               {0, ImportState::Committed, QString(), ImportFileOperation::None, songIds.at(0)}})
+            || !QFile::rename(tasks.at(1).sourcePath, target(1))
+            || !QFile::copy(tasks.at(2).sourcePath, target(2) + FileTransferEngine::kPartialSuffix)) {
+            return qlonglong(0);
+        }
+        return jobId;
+    };
+
+    // Discarded: the files are back in the source, the committed song is gone
+    qlonglong jobId = crash();
+    QVERIFY(jobId > 0);
+    QCOMPARE(db.unfinishedImportJob(), jobId);
+    {
+        ImportProcessor processor;
+        QSignalSpy finished(&processor, &ImportProcessor::finished);
+        processor.discard(jobId);
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(finished.at(0).at(0).toBool(), true);
+    }
+    QCOMPARE(db.unfinishedImportJob(), qlonglong(0));
+    QCOMPARE(count("SELECT COUNT(*) FROM import_journal"), qlonglong(0));
+    QCOMPARE(count("SELECT COUNT(*) FROM songs"), qlonglong(0));
+    QCOMPARE(QDir(source).entryList(QDir::Files).size(), 10);
+    QCOMPARE(QDir(library + "/Audio").entryList(QDir::Files).size(), 0);
+
+    // Resumed: the committed task is kept, the others are imported once
+    jobId = crash();
+    QVERIFY(jobId > 0);
+    {
+        ImportProcessor processor;
+        QSignalSpy progress(&processor, &ImportProcessor::progressUpdated);
+        QSignalSpy finished(&processor, &ImportProcessor::finished);
+        processor.resume(jobId);
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(finished.at(0).at(0).toBool(), true);
+        QCOMPARE(progress.first().at(0).toInt(), 2);
+        QCOMPARE(progress.last().at(0).toInt(), 10);
+    }
+    QCOMPARE(db.unfinishedImportJob(), qlonglong(0));
+    QCOMPARE(count("SELECT COUNT(*) FROM songs"), qlonglong(10));
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files WHERE is_managed = 1"), qlonglong(10));
+    QCOMPARE(QDir(source).entryList(QDir::Files).size(), 0);
+    QCOMPARE(QDir(library + "/Audio").entryList(QDir::Files).size(), 10);
+    QCOMPARE(db.getManagedPath(), library);
+}
+
+// A copy the crashed run made after its last checkpoint is only reserved in the journal; the
+// resumed run must still take it back when it fails, but leave files that were there before,
+// even identical ones
+void TestDatabaseManager::testFailedResumeRemovesEarlierCopies() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    const QString source = dir_m.filePath("resume_source");
+    const QString library = dir_m.filePath("resume_library");
+    QVERIFY(QDir().mkpath(source));
+    QVERIFY(QDir().mkpath(library + "/Audio"));
+
+    QList<ImportTask> tasks;
+    for (int i = 0; i < 3; ++i) {
+        ImportTask task;
+        task.itemName = QString("take_%1.mp3").arg(i);
+        task.sourcePath = source + "/" + task.itemName;
+        task.relativePath = "Audio/" + task.itemName;
+        task.fileSuffix = "mp3";
+        task.fileSize = 100;
+        task.fileHash = FileHash{quint64(i + 1) * 0x9E3779B97F4A7C15ULL, 0};
+        tasks.append(task);
+
+        QFile file(task.sourcePath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(100, char('a' + i)));
+    }
+    const auto target = [&](int task) { return library + "/" + tasks.at(task).relativePath; };
+
+    // Copy mode: task 0 was copied before the crash, task 1 has the same file at its target
+    // from before the import
+    QVERIFY(QFile::copy(tasks.at(1).sourcePath, target(1)));
+    const qlonglong jobId = db.createImportJob(tasks, library, true, false);
+    QVERIFY(jobId > 0);
+    QVERIFY(db.updateImportJournal(jobId, {{0, ImportState::Pending, target(0), ImportFileOperation::None, 0}}));
+    QVERIFY(QFile::copy(tasks.at(0).sourcePath, target(0)));
+    QVERIFY(QFile::remove(tasks.at(2).sourcePath)); // The resumed run fails on it
+
+    {
+        ImportProcessor processor;
+        QSignalSpy finished(&processor, &ImportProcessor::finished);
+        processor.resume(jobId);
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(finished.at(0).at(0).toBool(), false);
+    }
+    QCOMPARE(db.unfinishedImportJob(), qlonglong(0));
+    QCOMPARE(count("SELECT COUNT(*) FROM songs"), qlonglong(0));
+    QCOMPARE(QDir(library + "/Audio").entryList(QDir::Files), QStringList{"take_1.mp3"});
+    QCOMPARE(QDir(source).entryList(QDir::Files).size(), 2);
+}
+
+// Hashes of another algorithm are dropped at once and filled in by the background job
+void TestDatabaseManager::testRehashAfterAlgorithmChange() {
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    const QString folder = dir_m.filePath("rehash");
+    QVERIFY(QDir().mkpath(folder));
+    const auto write = [&folder](const QString &name, const QByteArray &content) {
+        QFile file(folder + "/" + name);
+        return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+    };
+    QVERIFY(write("a.mp3", QByteArray(5000, 'a')));
+    QVERIFY(write("b.mp3", QByteArray(5000, 'b')));
+    QVERIFY(write("copy_of_a.mp3", QByteArray(5000, 'a')));
+
+    QSqlQuery q(QSqlDatabase::database());
+    q.prepare("INSERT INTO media_files (file_path, is_managed, file_type, file_size, file_hash) VALUES (?, 0, 'mp3', 5000, ?)");
+    const QStringList names = {"a.mp3", "b.mp3", "copy_of_a.mp3", "missing.mp3"};
+    for (qsizetype i = 0; i < names.size(); ++i) {
+        q.addBindValue(folder + "/" + names.at(i));
+        q.addBindValue(1000 + i); // "Old algorithm"
+        QVERIFY(q.exec());
+    }
+    q.finish();
+    QVERIFY(db.setSetting("hash_algorithm", "fnv1a"));
+    db.closeDatabase();
+
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.getSetting("hash_algorithm", QString()), QString(SampleHash::kAlgorithmName));
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files WHERE file_hash IS NOT NULL"), qlonglong(0));
+    QVERIFY(db.getAllFileHashes().isEmpty());
+
+    QFuture<int> rehash = db.rehashMediaFilesAsync();
+    rehash.waitForFinished();
+    QCOMPARE(rehash.resultCount(), 1);
+    QCOMPARE(rehash.result(), 2); // The copy (UNIQUE) and the missing file
+    QCOMPARE(rehash.progressMaximum(), 4);
+    QCOMPARE(rehash.progressValue(), 4);
+
+    const QSet<quint64> hashes = db.getAllFileHashes();
+    QCOMPARE(hashes.size(), 2);
+    QVERIFY(hashes.contains(SampleHash::calculate(folder + "/a.mp3")));
+    QVERIFY(hashes.contains(SampleHash::calculate(folder + "/b.mp3")));
+
+    // The files left without hash are tried again
+    QVERIFY(QFile::remove(folder + "/copy_of_a.mp3"));
+    QVERIFY(write("missing.mp3", QByteArray(5000, 'm')));
+    int unhashed = -1;
+    QVERIFY(db.enqueueWrite([&db, &unhashed]() { return db.rehashMediaFiles(nullptr, &unhashed); }).result());
+    QCOMPARE(unhashed, 1);
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files WHERE file_hash IS NULL"), qlonglong(1));
+}
+
+void TestDatabaseManager::benchmarkCalendar_data() {
+    QTest::addColumn<bool>("grouped");
+
+    QTest::newRow("all dates + summary per day") << false;
+    QTest::newRow("getPracticeCalendar, one page") << true;
+}
+
+// Three years of daily practice, as SonarLessonPage::updateCalendarHighlights reads it after each save
+void TestDatabaseManager::benchmarkCalendar() {
+    QFETCH(bool, grouped);
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    QList<int> songIds;
+    for (int i = 0; i < 20; ++i) {
+        songIds << int(db.createSong(QString("Song %1").arg(i)));
+    }
+
+    const QDate lastDay(2024, 12, 31);
+    QVERIFY(db.beginTransaction());
+    QSqlQuery q(QSqlDatabase::database());
+    q.prepare("INSERT INTO practice_journal (song_id, practice_date, practiced_bpm, total_reps) VALUES (?, ?, ?, ?)");
+    for (QDate day = lastDay.addYears(-3); day <= lastDay; day = day.addDays(1)) {
+        for (int i = 0; i < 3; ++i) {
+            q.addBindValue(songIds.at((day.dayOfYear() + i) % songIds.size()));
+            q.addBindValue(day.toString("yyyy-MM-dd"));
+            q.addBindValue(80 + i * 10);
+            q.addBindValue(5);
+            QVERIFY(q.exec());
+        }
+    }
+    q.finish();
+    QVERIFY(db.commit());
+
+    int daysShown = 0;
+    QBENCHMARK {
+        if (grouped) {
+            daysShown = int(db.getPracticeCalendar(QDate(2024, 11, 25), QDate(2025, 1, 5)).size());
+        } else {
+            const QList<QDate> dates = db.getAllPracticeDates();
+            for (const QDate &date : dates) {
+                QVERIFY(!db.getPracticeSummaryForDay(date).isEmpty());
+            }
+            daysShown = int(dates.size());
+        }
+    }
+    QVERIFY(daysShown > 0);
+}
+
+void TestDatabaseManager::testMigrationFromFixture_data() {
+    QTest::addColumn<int>("version");
+    QTest::addColumn<QList<int>>("expectedSteps");
+
+    QTest::newRow("new database") << 0 << QList<int>{1, 2, 3, 4};
+    QTest::newRow("version 1 (TEXT hashes)") << 1 << QList<int>{2, 3, 4};
+    QTest::newRow("version 2 (INTEGER hashes, scan cache)") << 2 << QList<int>{3, 4};
+    QTest::newRow("version 3 (journal indexes)") << 3 << QList<int>{4};
+}
+
+void TestDatabaseManager::testMigrationFromFixture() {
+    QFETCH(int, version);
+    QFETCH(QList<int>, expectedSteps);
+
+    QVERIFY(createFixture(version));
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+    QCOMPARE(db.getDatabaseVersion(), 4);
+
+    QList<int> steps;
+    for (const SchemaMigrator::StepReport &step : db.migrationReport()) {
+        QVERIFY2(step.ok, qPrintable(step.description));
+        QVERIFY(step.elapsedMs >= 0);
+        steps << step.version;
+    }
+    QCOMPARE(steps, expectedSteps);
+
+    // Current schema
+    QCOMPARE(count("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name IN ('scan_cache', 'reminders')"),
+             qlonglong(2));
+    QCOMPARE(count("SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx_journal_%'"), qlonglong(2));
+    QCOMPARE(count("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name IN ('import_jobs', 'import_journal')"),
+             qlonglong(2));
+    QCOMPARE(count("SELECT COUNT(*) FROM pragma_table_info('media_files') WHERE name = 'file_hash' AND type = 'INTEGER'"),
+             qlonglong(1));
+
+    // Data of the old release survives
+    if (version > 0) {
+        QCOMPARE(count("SELECT file_hash FROM media_files WHERE file_path = 'fixture.gp5'"), qlonglong(255));
+        QCOMPARE(db.getSongDetails(1).artist, QString("Fixture Artist"));
+        QCOMPARE(db.getNoteForDay(1, QDate(2024, 3, 5)), QString("kept"));
+        QVERIFY(db.getPracticedSongsForDay(QDate(2024, 3, 5)).contains(1));
+    }
+
+    // Up to date: the next start runs no step
+    db.closeDatabase();
+    QVERIFY(db.initDatabase(dbPath_m));
+    QVERIFY(db.migrationReport().isEmpty());
+}
+
+void TestDatabaseManager::testMigratorRollsBackFailedStep() {
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "migrator");
+        db.setDatabaseName(dbPath_m);
+        QVERIFY(db.open());
+        QSqlQuery q(db);
+
+        bool secondStepWorks = false;
+        const auto addSteps = [&](SchemaMigrator &migrator) {
+            migrator.addStep(1, "create", [&] { return q.exec("CREATE TABLE IF NOT EXISTS t (x INTEGER)"); });
+            migrator.addStep(2, "insert", [&] { return q.exec("INSERT INTO t VALUES (2)") && secondStepWorks; });
+            migrator.addStep(4, "insert more", [&] { return q.exec("INSERT INTO t VALUES (4)"); });
+        };
+
+        SchemaMigrator failing(db);
+        addSteps(failing);
+        QCOMPARE(failing.targetVersion(), 4);
+        QVERIFY(!failing.migrate());
+        QCOMPARE(failing.currentVersion(), 1);
+        QCOMPARE(failing.report().size(), 2);
+        QVERIFY(failing.report().at(0).ok);
+        QVERIFY(!failing.report().at(1).ok);
+        QVERIFY(q.exec("SELECT COUNT(*) FROM t") && q.next());
+        QCOMPARE(q.value(0).toInt(), 0); // The insert of step 2 was rolled back
+        q.finish();
+
+        // The next start continues with the failed step
+        secondStepWorks = true;
+        SchemaMigrator retry(db);
+        addSteps(retry);
+        QVERIFY(retry.migrate());
+        QCOMPARE(retry.currentVersion(), 4);
+        QCOMPARE(retry.report().size(), 2);
+        QCOMPARE(retry.report().at(0).version, 2);
+        QVERIFY(q.exec("SELECT SUM(x) FROM t") && q.next());
+        QCOMPARE(q.value(0).toInt(), 6);
+        q.finish();
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("migrator");
+}
+
+void TestDatabaseManager::benchmarkImport_data() {
+    QTest::addColumn<bool>("bulk");
+    QTest::addColumn<int>("files");
+
+    for (int files : {1000, 10000}) {
+        QTest::addRow("per file, %d files", files) << false << files;
+        QTest::addRow("bulkImport, %d files", files) << true << files;
+    }
+}
+
+// Database part of ImportProcessor::executeImport, without the file copies
+void TestDatabaseManager::benchmarkImport() {
+    QFETCH(bool, bulk);
+    QFETCH(int, files);
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    // The paths are UNIQUE, so a repeated import would need new tasks; one import of
+    // thousands of files is long enough to measure on its own
+    const QList<ImportTask> tasks = importTasks(files);
+    const QList<ImportSong> songs = importSongs(files);
+
+    QBENCHMARK_ONCE {
+        QVERIFY(db.beginTransaction());
+        if (bulk) {
+            QVERIFY(db.bulkImport(tasks, songs, true));
+        } else {
+            for (qsizetype i = 0; i < tasks.size(); ++i) {
+                const ImportSong &song = songs.at(i);
+                const qlonglong songId = db.createSong(song.title, song.artist, song.tuning, song.bpm);
+                QVERIFY(songId > 0);
+                QVERIFY(db.addFileToSong(songId, tasks.at(i).relativePath, true, tasks.at(i).fileSuffix,
+                                         tasks.at(i).fileSize, tasks.at(i).fileHash));
+            }
+        }
+        QVERIFY(db.commit());
+    }
+
+    QCOMPARE(count("SELECT COUNT(*) FROM media_files"), qlonglong(files));
+}
+
+void TestDatabaseManager::benchmarkJournalCommits_data() {
+    QTest::addColumn<bool>("wal");
+
+    QTest::newRow("rollback journal, synchronous=FULL") << false;
+    QTest::newRow("WAL, synchronous=NORMAL") << true;
+}
+
+// One autosave of SonarLessonPage: a single journal note, committed on its own
+void TestDatabaseManager::benchmarkJournalCommits() {
+    QFETCH(bool, wal);
+
+    DatabaseManager &db = DatabaseManager::instance();
+    db.setConnectionProfile(wal ? ConnectionProfile() : ConnectionProfile::sqliteDefaults());
+    QVERIFY(db.initDatabase(dbPath_m));
+
+    const qlonglong songId = db.createSong("Benchmark");
+    QVERIFY(songId > 0);
+
+    constexpr int commitsPerRun = 200; // Per iteration
+    QDate day(2024, 1, 1);
+
+    QBENCHMARK {
+        for (int i = 0; i < commitsPerRun; ++i) {
+            QVERIFY(db.updateSongNotes(int(songId), QString("Note %1").arg(i), day));
+        }
+        day = day.addDays(1);
+    }
+}
+
+// -- ENDE --
+QTEST_GUILESS_MAIN(TestDatabaseManager)
+#include "tst_databasemanager.moc"
@@ -0,0 +1,207 @@
+#include <QTest>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include "samplehash.h"
+#include "fnv1a.h"
+
+class TestSampleHash : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void testEmptyAndMissingFiles();
+    void testDetectsChangedSamples();
+    void testDetectsReorderedSamples();
+    void testFullHashDetectsReorderedContent();
+    void testSmallFilesAreHashedCompletely();
+    void benchmarkHash_data();
+    void benchmarkHash();
+
+private:
+    QString writeFile(const QString &name, const QByteArray &content);
+
+    QTemporaryDir dir_m;
+    QString smallFile_m;
+    QString mediumFile_m;
+    QString hugeFile_m;
+};
+
+void TestSampleHash::initTestCase() {
+    QVERIFY(dir_m.isValid());
+
+    QByteArray medium(8 * 1024 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < medium.size(); ++i) {
+        medium[i] = char((i * 31) ^ (i >> 9));
+    }
+
+    smallFile_m = writeFile("small.gp5", medium.left(2 * 1024));
+    mediumFile_m = writeFile("medium.mp3", medium);
+
+    // Sparse file, so the test does not need 4 GiB of disk space
+    hugeFile_m = dir_m.filePath("huge.mp4");
+    QFile huge(hugeFile_m);
+    QVERIFY(huge.open(QIODevice::WriteOnly));
+    QVERIFY(huge.resize(4LL * 1024 * 1024 * 1024));
+    QVERIFY(huge.seek(huge.size() / 2));
+    QVERIFY(huge.write(medium.left(4096)) == 4096);
+}
+
+QString TestSampleHash::writeFile(const QString &name, const QByteArray &content) {
+    const QString path = dir_m.filePath(name);
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(content);
+    }
+    return path;
+}
+
+void TestSampleHash::testEmptyAndMissingFiles() {
+    bool ok = false;
+    QCOMPARE(SampleHash::calculate(writeFile("empty.pdf", {}), &ok), SampleHash::kEmptyFileHash);
+    QVERIFY(ok);
+
+    QCOMPARE(SampleHash::calculate(dir_m.filePath("missing.pdf"), &ok), SampleHash::kEmptyFileHash);
+    QVERIFY(!ok);
+    QVERIFY(SampleHash::calculateHex(dir_m.filePath("missing.pdf")).isEmpty());
+}
+
+void TestSampleHash::testDetectsChangedSamples() {
+    QFile source(mediumFile_m);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    QByteArray content = source.readAll();
+
+    const quint64 original = SampleHash::calculate(mediumFile_m);
+    QCOMPARE(SampleHash::calculate(writeFile("copy.mp3", content)), original);
+
+    // A byte inside the last sample window
+    const qint64 last = SampleHash::sampleOffset(content.size(), SampleHash::kSampleCount - 1);
+    content[last + 7] = char(content[last + 7] ^ 0x01);
+    QVERIFY(SampleHash::calculate(writeFile("changed.mp3", content)) != original);
+
+    // Same samples, different size
+    QVERIFY(SampleHash::calculate(writeFile("longer.mp3", content + "x")) != original);
+
+    const QString hex = SampleHash::calculateHex(mediumFile_m);
+    QCOMPARE(hex.size(), 16);
+    QCOMPARE(hex, hex.toUpper());
+    QCOMPARE(hex.toULongLong(nullptr, 16), original);
+}
+
+// Same bytes in a different order: every stripe is keyed by its position
+void TestSampleHash::testDetectsReorderedSamples() {
+    QFile source(mediumFile_m);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    const QByteArray content = source.readAll();
+    const quint64 original = SampleHash::calculate(mediumFile_m);
+
+    const auto swapped = [&content](qint64 a, qint64 b, qint64 length) {
+        QByteArray result = content;
+        const QByteArray first = content.mid(a, length);
+        result.replace(a, length, content.mid(b, length));
+        result.replace(b, length, first);
+        return result;
+    };
+
+    // Two stripes inside one sample window
+    const qint64 window = SampleHash::sampleOffset(content.size(), 3);
+    QVERIFY(SampleHash::calculate(writeFile("stripes.mp3", swapped(window, window + 64, 64))) != original);
+
+    // Two sample windows
+    const qint64 first = SampleHash::sampleOffset(content.size(), 1);
+    const qint64 second = SampleHash::sampleOffset(content.size(), 2);
+    QVERIFY(SampleHash::calculate(writeFile("windows.mp3", swapped(first, second, SampleHash::kSampleSize))) != original);
+
+    // A small file, hashed completely
+    const QByteArray small = content.left(SampleHash::kWholeFileLimit);
+    const quint64 smallHash = SampleHash::calculate(writeFile("small_a.pdf", small));
+    QByteArray reordered = small.mid(64, 64) + small.left(64) + small.mid(128);
+    QVERIFY(SampleHash::calculate(writeFile("small_b.pdf", reordered)) != smallHash);
+}
+
+// The full tier verifies sample collisions, so it must see reordering anywhere in the file
+void TestSampleHash::testFullHashDetectsReorderedContent() {
+    QFile source(mediumFile_m);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    QByteArray content = source.readAll();
+
+    // The generated content repeats every 128 KiB; tag the 1 MiB read blocks so they differ
+    constexpr qint64 block = 1024 * 1024;
+    for (qint64 offset = 0; offset < content.size(); offset += block) {
+        content[offset + 100] = char(offset / block);
+    }
+    const QString original = writeFile("full.mp3", content);
+    const quint64 sampled = SampleHash::calculate(original);
+    const quint64 full = SampleHash::calculateFull(original);
+
+    const auto swapped = [&content](qint64 a, qint64 b, qint64 length) {
+        QByteArray result = content;
+        const QByteArray first = content.mid(a, length);
+        result.replace(a, length, content.mid(b, length));
+        result.replace(b, length, first);
+        return result;
+    };
+
+    // Two stripes between the sample windows: only the full hash can tell
+    const qint64 stripes = 3 * block + 12345 * 64;
+    const QString reorderedStripes = writeFile("full_stripes.mp3", swapped(stripes, stripes + 64, 64));
+    QCOMPARE(SampleHash::calculate(reorderedStripes), sampled);
+    QVERIFY(SampleHash::calculateFull(reorderedStripes) != full);
+
+    // Two sample windows
+    const qint64 first = SampleHash::sampleOffset(content.size(), 1);
+    const qint64 second = SampleHash::sampleOffset(content.size(), 2);
+    const QString reorderedWindows = writeFile("full_windows.mp3", swapped(first, second, SampleHash::kSampleSize));
+    QVERIFY(SampleHash::calculateFull(reorderedWindows) != full);
+
+    // Two complete read blocks
+    QVERIFY(SampleHash::calculateFull(writeFile("full_blocks.mp3", swapped(block, 5 * block, block))) != full);
+}
+
+void TestSampleHash::testSmallFilesAreHashedCompletely() {
+    QByteArray content(SampleHash::kSampleCount * SampleHash::kSampleSize, 'a');
+    const quint64 original = SampleHash::calculate(writeFile("a.pdf", content));
+
+    for (qsizetype i : {qsizetype(0), qsizetype(333), content.size() - 1}) {
+        QByteArray changed = content;
+        changed[i] = 'b';
+        QVERIFY(SampleHash::calculate(writeFile("b.pdf", changed)) != original);
+    }
+}
+
+void TestSampleHash::benchmarkHash_data() {
+    QTest::addColumn<QString>("backend");
+    QTest::addColumn<QString>("file");
+
+    for (const QString backend : {"fnv1a", "samplehash"}) {
+        QTest::newRow(qPrintable(backend + " small (2 KiB)")) << backend << smallFile_m;
+        QTest::newRow(qPrintable(backend + " medium (8 MiB)")) << backend << mediumFile_m;
+        QTest::newRow(qPrintable(backend + " huge (4 GiB)")) << backend << hugeFile_m;
+    }
+}
+
+void TestSampleHash::benchmarkHash() {
+    QFETCH(QString, backend);
+    QFETCH(QString, file);
+
+    const bool fnv = (backend == "fnv1a");
+    constexpr int filesPerRun = 1000; // Per iteration
+
+    QBENCHMARK {
+        for (int i = 0; i < filesPerRun; ++i) {
+            if (fnv) {
+                QVERIFY(!FNV1a::calculate(file).isEmpty());
+            } else {
+                bool ok = false;
+                [[maybe_unused]] const quint64 hash = SampleHash::calculate(file, &ok);
+                QVERIFY(ok);
+            }
+        }
+    }
+}
+
+// -- ENDE --
+QTEST_GUILESS_MAIN(TestSampleHash)
+#include "tst_samplehash.moc"
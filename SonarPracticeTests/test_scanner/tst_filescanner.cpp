@@ -0,0 +1,554 @@
+#include <QTest>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QMap>
+#include <QRandomGenerator>
+
+#include "filescanner.h"
+#include "extensionmatcher.h"
+#include "fileutils.h"
+#include "hashgroupindex.h"
+#include "samplehash.h"
+
+class TestFileScanner : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void testParallelMatchesSerial();
+    void testStreamingMatchesBuffered();
+    void testScanCacheReusesUnchangedFiles();
+    void testScanRecords();
+    void testSampleCollisionsAreVerified();
+    void testHashGroupIndex();
+    void testExtensionMatcher();
+    void testWalkerBackendsAgree();
+    void benchmarkScanThroughput_data();
+    void benchmarkScanThroughput();
+    void benchmarkDuplicateGrouping_data();
+    void benchmarkDuplicateGrouping();
+    void benchmarkFilterMatching_data();
+    void benchmarkFilterMatching();
+
+private:
+    ScanRecords runScan(FileScanner &scanner);
+
+    QTemporaryDir tree_m;
+    QStringList filters_m;
+    qsizetype fileCount_m{0};
+};
+
+// Synthetic library: nested folders with tabs, backing tracks, a few duplicates,
+// empty files and files that do not match the filter.
+void TestFileScanner::initTestCase() {
+    QVERIFY(tree_m.isValid());
+
+    filters_m = FileUtils::getAudioFormats() + FileUtils::getGuitarProFormats() +
+                FileUtils::getDocFormats() + FileUtils::getVideoFormats();
+
+    const QStringList suffixes = {"gp5", "mp3", "pdf", "mp4", "zip"};
+    for (int dir = 0; dir < 20; ++dir) {
+        QString dirPath = tree_m.filePath(QString("artist_%1/album_%2").arg(dir % 5).arg(dir));
+        QVERIFY(QDir().mkpath(dirPath));
+
+        for (int i = 0; i < 100; ++i) {
+            const QString suffix = suffixes.at(i % suffixes.size());
+            QFile file(QString("%1/track_%2.%3").arg(dirPath).arg(i).arg(suffix));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+
+            if (i % 50 != 0) { // every 50th file stays empty (defect)
+                // Every 10th file shares its content with the same index in other folders (duplicates)
+                const int seed = (i % 10 == 0) ? i : dir * 1000 + i;
+                QByteArray content(1024 + (seed % 64) * 512, char('a' + seed % 26));
+                content.append(QByteArray::number(seed));
+                file.write(content);
+            }
+            file.close();
+
+            if (suffix != "zip") fileCount_m++;
+        }
+    }
+}
+
+ScanRecords TestFileScanner::runScan(FileScanner &scanner) {
+    ScanRecords result;
+    auto connection = connect(&scanner, &FileScanner::finishWithAllBatches, this,
+                              [&result](const ScanRecords &all, const ReviewStats &) { result = all; });
+    scanner.doScan({tree_m.path()}, filters_m);
+    disconnect(connection);
+    return result;
+}
+
+void TestFileScanner::testParallelMatchesSerial() {
+    FileScanner serial;
+    serial.setWorkerCount(1);
+    FileScanner parallel;
+    parallel.setWorkerCount(4);
+
+    const ScanRecords expected = runScan(serial);
+    const ScanRecords actual = runScan(parallel);
+
+    QCOMPARE(expected.size(), fileCount_m);
+    QCOMPARE(actual.size(), expected.size());
+
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        QCOMPARE(actual.filePath(i), expected.filePath(i));
+        QCOMPARE(actual.at(i).hash, expected.at(i).hash);
+        QCOMPARE(actual.at(i).status, expected.at(i).status);
+        QCOMPARE(actual.at(i).groupId, expected.at(i).groupId);
+    }
+}
+
+void TestFileScanner::testStreamingMatchesBuffered() {
+    FileScanner buffered;
+    FileScanner streaming;
+    streaming.setStreamingBatchSize(64);
+
+    QHash<QString, ScanBatch> expected;
+    const ScanRecords bufferedResult = runScan(buffered);
+    for (qsizetype i = 0; i < bufferedResult.size(); ++i) {
+        expected.insert(bufferedResult.filePath(i), bufferedResult.at(i));
+    }
+
+    ScanRecords streamed;
+    int chunks = 0;
+    QHash<QString, DuplicateResolution> resolutionByPath;
+    bool finishedWithAll = false;
+
+    connect(&streaming, &FileScanner::batchesFound, this, [&](const ScanRecords &batches) {
+        QVERIFY(batches.size() <= 64);
+        QVERIFY(resolutionByPath.isEmpty()); // the delta arrives after the last chunk
+        streamed.append(batches);
+        chunks++;
+    });
+    connect(&streaming, &FileScanner::duplicateGroupsResolved, this, [&](const QHash<QString, DuplicateResolution> &resolutions) {
+        resolutionByPath = resolutions;
+    });
+    connect(&streaming, &FileScanner::finishWithAllBatches, this, [&]() { finishedWithAll = true; });
+
+    streaming.doScan({tree_m.path()}, filters_m);
+
+    QVERIFY(!finishedWithAll);
+    QVERIFY(chunks > 1);
+    QCOMPARE(streamed.size(), expected.size());
+
+    for (qsizetype i = 0; i < streamed.size(); ++i) {
+        // Apply the delta the same way FileManager::applyDuplicateGroups() does
+        ScanBatch batch = streamed.at(i);
+        const QString path = batch.filePath();
+        if (batch.status == StatusReady && resolutionByPath.contains(path)) {
+            const DuplicateResolution resolution = resolutionByPath.value(path);
+            batch.hash = resolution.hash;
+            if (resolution.groupId != 0) {
+                batch.status = StatusDuplicate;
+                batch.groupId = resolution.groupId;
+            }
+        }
+
+        // Group ids follow the arrival order, so only the grouping itself has to match
+        const ScanBatch reference = expected.value(path);
+        QCOMPARE(batch.hash, reference.hash);
+        QCOMPARE(batch.status, reference.status);
+        QCOMPARE(batch.groupId != 0, reference.groupId != 0);
+    }
+}
+
+void TestFileScanner::testScanCacheReusesUnchangedFiles() {
+    FileScanner first;
+    ScanCache fresh;
+    connect(&first, &FileScanner::scanCacheUpdated, this, [&fresh](const ScanCache &entries) { fresh = entries; });
+    const ScanRecords expected = runScan(first);
+
+    // Every non-empty file was hashed and reported
+    QVERIFY(!fresh.isEmpty());
+    QVERIFY(fresh.size() < expected.size());
+
+    // A stale entry (different mtime) must be hashed again, a matching one is taken as is
+    const QString stalePath = fresh.firstKey();
+    ScanCache cache = fresh;
+    cache[stalePath].mtime -= 1000;
+    cache[stalePath].hash = 0xDEADBEEF;
+
+    FileScanner second;
+    second.setScanCache(cache);
+    ScanCache rehashed;
+    connect(&second, &FileScanner::scanCacheUpdated, this, [&rehashed](const ScanCache &entries) { rehashed = entries; });
+    const ScanRecords actual = runScan(second);
+
+    QCOMPARE(rehashed.size(), 1);
+    QVERIFY(rehashed.contains(stalePath));
+    QCOMPARE(rehashed.value(stalePath).hash, fresh.value(stalePath).hash);
+
+    QCOMPARE(actual.size(), expected.size());
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        QCOMPARE(actual.hash(i), expected.hash(i));
+    }
+}
+
+void TestFileScanner::testScanRecords() {
+    const auto file = [](const QString &directory, const QString &fileName, qint64 size) {
+        ScanBatch batch;
+        batch.directory = directory;
+        batch.fileName = fileName;
+        batch.size = size;
+        batch.modified = size * 1000;
+        batch.hash = FileHash{quint64(size), 0};
+        batch.status = StatusReady;
+        return batch;
+    };
+
+    ScanRecords first;
+    first.append(file("/music/a", "one.mp3", 1));
+    first.append(file("/music/a", "two.mp3", 2));
+    first.append(file("/", "root.pdf", 3));
+
+    ScanRecords second;
+    ScanBatch tab = file("/music/b", "three.gp5", 4);
+    tab.song = ImportSong{"Three", "Band", "Drop D", 140};
+    second.append(tab);
+    second.append(file("/music/a", "four.mp3", 5));
+
+    first.append(second);
+    first.setStatus(4, StatusDuplicate);
+    first.setGroupId(4, 7);
+
+    QCOMPARE(first.size(), 5);
+    QCOMPARE(first.directoryCount(), 3); // "/music/a" is stored once
+    QCOMPARE(first.directoryId(4), first.directoryId(0));
+    QCOMPARE(first.filePath(1), QString("/music/a/two.mp3"));
+    QCOMPARE(first.filePath(2), QString("/root.pdf"));
+    QCOMPARE(first.fileName(3), QString("three.gp5"));
+
+    // The parsed song moves with its file
+    QVERIFY(!first.song(0));
+    QVERIFY(first.song(3));
+    QCOMPARE(first.song(3)->artist, QString("Band"));
+    QCOMPARE(first.at(3).song->bpm, 140);
+
+    const ScanBatch last = first.at(4);
+    QCOMPARE(last.filePath(), QString("/music/a/four.mp3"));
+    QCOMPARE(last.size, qint64(5));
+    QCOMPARE(last.modified, qint64(5000));
+    QCOMPARE(last.hash, (FileHash{5, 0}));
+    QCOMPARE(last.status, int(StatusDuplicate));
+    QCOMPARE(last.groupId, 7);
+
+    // The source of append() is not changed
+    QCOMPARE(second.size(), 2);
+    QCOMPARE(second.status(1), int(StatusReady));
+}
+
+void TestFileScanner::testSampleCollisionsAreVerified() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // Same size and same sample windows, they only differ between the windows
+    const qint64 size = 64 * 1024;
+    QByteArray content(size, 'x');
+    const auto writeFile = [&dir](const QString &name, const QByteArray &data) {
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(data), data.size());
+    };
+
+    writeFile("original.mp4", content);
+    writeFile("copy.mp4", content);
+    QByteArray changed = content;
+    changed[SampleHash::sampleOffset(size, 1) + SampleHash::kSampleSize + 100] = 'y';
+    writeFile("lookalike.mp4", changed);
+
+    for (const bool streaming : {false, true}) {
+        FileScanner scanner;
+        scanner.setStreamingBatchSize(streaming ? 1 : 0);
+        scanner.setWorkerCount(1); // One file per chunk, each with its own cache update
+
+        // A stale cache entry must not be taken by the second walk of a streaming scan either
+        const QString lookalikePath = dir.filePath("lookalike.mp4");
+        const qint64 mtime = QFileInfo(lookalikePath).lastModified().toMSecsSinceEpoch();
+        scanner.setScanCache({{lookalikePath, ScanCacheEntry{size, mtime - 1000, 0, 0xDEADBEEF}}});
+
+        int cacheUpdates = 0;
+        ScanCache fresh;
+        connect(&scanner, &FileScanner::scanCacheUpdated, this, [&](const ScanCache &entries) {
+            cacheUpdates++;
+            fresh.insert(entries);
+        });
+
+        QHash<QString, ScanBatch> result;
+        QHash<QString, DuplicateResolution> resolutionByPath;
+        connect(&scanner, &FileScanner::batchesFound, this, [&](const ScanRecords &batches) {
+            for (qsizetype i = 0; i < batches.size(); ++i) result.insert(batches.fileName(i), batches.at(i));
+        });
+        connect(&scanner, &FileScanner::duplicateGroupsResolved, this, [&](const QHash<QString, DuplicateResolution> &resolutions) {
+            resolutionByPath = resolutions;
+        });
+        scanner.doScan({dir.path()}, {"*.mp4"});
+
+        QCOMPARE(result.size(), 3);
+        QCOMPARE(result.value("lookalike.mp4").hash.sample, result.value("original.mp4").hash.sample);
+        QCOMPARE(fresh.size(), 3);
+        QCOMPARE(cacheUpdates, streaming ? 3 : 1);
+
+        if (streaming) {
+            const DuplicateResolution original = resolutionByPath.value(dir.filePath("original.mp4"));
+            const DuplicateResolution copy = resolutionByPath.value(dir.filePath("copy.mp4"));
+            const DuplicateResolution lookalike = resolutionByPath.value(dir.filePath("lookalike.mp4"));
+
+            QCOMPARE(resolutionByPath.size(), 3);
+            QVERIFY(original.groupId != 0);
+            QCOMPARE(copy.groupId, original.groupId);
+            QCOMPARE(copy.hash, original.hash);
+            QCOMPARE(lookalike.groupId, 0);
+            QVERIFY(lookalike.hash != original.hash);
+        } else {
+            QVERIFY(result.value("lookalike.mp4").hash != result.value("original.mp4").hash);
+            QCOMPARE(result.value("original.mp4").status, StatusDuplicate);
+            QCOMPARE(result.value("copy.mp4").status, StatusDuplicate);
+            QCOMPARE(result.value("lookalike.mp4").status, StatusReady);
+            QCOMPARE(result.value("lookalike.mp4").groupId, 0);
+        }
+    }
+}
+
+void TestFileScanner::testHashGroupIndex() {
+    HashGroupIndex index;
+    const FileHash a{0x1234, 0};
+    const FileHash aVerified{0x1234, 0x99};
+    const FileHash empty{0, 0};
+
+    QCOMPARE(index.add(a), 1);
+    QCOMPARE(index.add(a), 2);
+    QCOMPARE(index.add(aVerified), 1);
+    QCOMPARE(index.add(empty), 1); // Empty files are a valid key
+    QCOMPARE(index.count(a), 2);
+    QCOMPARE(index.count(FileHash{0x4321, 0}), 0);
+
+    index.clear(a);
+    QCOMPARE(index.count(a), 0);
+    QCOMPARE(index.size(), 3);
+
+    // Ids in the order they are first asked for, stable afterwards
+    QCOMPARE(index.groupId(aVerified), 1);
+    QCOMPARE(index.groupId(empty), 2);
+    QCOMPARE(index.groupId(aVerified), 1);
+
+    // Growing keeps counts and group ids
+    for (quint64 i = 1; i <= 10000; ++i) {
+        index.add(FileHash{i << 20, 0});
+    }
+    QCOMPARE(index.size(), 10003);
+    QCOMPARE(index.count(aVerified), 1);
+    QCOMPARE(index.groupId(empty), 2);
+    QCOMPARE(index.count(FileHash{5000ULL << 20, 0}), 1);
+    QCOMPARE(index.groupCount(), 2);
+}
+
+void TestFileScanner::testExtensionMatcher() {
+    const QStringList patterns = filters_m + QStringList{"backing_*.zip", "notes?.TXT"};
+    const ExtensionMatcher matcher(patterns);
+
+    const QStringList names = {
+        "song.gp5", "SONG.GP5", "Song.Mp3", "track.flac", "clip.avchd", "a.gp", ".gp",
+        "archive.zip", "backing_01.zip", "Backing_Track.ZIP", "notes1.txt", "notes12.txt",
+        "noextension", "trailingdot.", "song.gp5.bak", "song.gp55", "x.g", "readme.MD", "photo.JPEG"
+    };
+
+    for (const QString &name : names) {
+        const bool expected = std::any_of(patterns.cbegin(), patterns.cend(), [&name](const QString &pattern) {
+            return QDir::match(pattern, name);
+        });
+        QVERIFY2(matcher.matches(name) == expected, qPrintable(name));
+    }
+
+    QVERIFY(ExtensionMatcher().isEmpty());
+    QVERIFY(!ExtensionMatcher().matches(u"song.gp5"));
+}
+
+void TestFileScanner::testWalkerBackendsAgree() {
+    if (!DirectoryWalker::isAvailable(DirectoryWalker::Backend::LinuxGetdents)) {
+        QSKIP("getdents64 walker is only available on Linux");
+    }
+
+    // Neither backend may report hidden files or symbolic links
+    QTemporaryDir extra(tree_m.filePath("artist_0/XXXXXX"));
+    QVERIFY(extra.isValid());
+    QVERIFY(QDir().mkpath(extra.filePath(".hidden")));
+    for (const QString &name : {QString("visible.mp3"), QString(".hidden.mp3"), QString(".hidden/inside.mp3")}) {
+        QFile file(extra.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("content of " + name.toUtf8());
+    }
+    QVERIFY(QFile::link(extra.filePath("visible.mp3"), extra.filePath("link.mp3")));
+
+    const auto scanWith = [this](DirectoryWalker::Backend backend, int workers) {
+        FileScanner scanner;
+        scanner.setWalkerBackend(backend);
+        scanner.setWorkerCount(workers);
+        const ScanRecords records = runScan(scanner);
+
+        QMap<QString, ScanBatch> byPath; // The walk order differs between the backends
+        for (qsizetype i = 0; i < records.size(); ++i) {
+            byPath.insert(records.filePath(i), records.at(i));
+        }
+        return byPath;
+    };
+
+    const QMap<QString, ScanBatch> expected = scanWith(DirectoryWalker::Backend::QtIterator, 1);
+    QCOMPARE(expected.size(), fileCount_m + 1);
+    QVERIFY(expected.contains(extra.filePath("visible.mp3")));
+
+    for (const int workers : {1, 4}) {
+        const QMap<QString, ScanBatch> actual = scanWith(DirectoryWalker::Backend::LinuxGetdents, workers);
+        QCOMPARE(actual.keys(), expected.keys());
+
+        for (auto it = expected.cbegin(); it != expected.cend(); ++it) {
+            const ScanBatch native = actual.value(it.key());
+            QCOMPARE(native.size, it.value().size);
+            QCOMPARE(native.modified, it.value().modified);
+            QCOMPARE(native.hash, it.value().hash);
+            QCOMPARE(native.status, it.value().status);
+        }
+    }
+}
+
+void TestFileScanner::benchmarkScanThroughput_data() {
+    QTest::addColumn<int>("workers");
+    QTest::addColumn<int>("backend"); // DirectoryWalker::Backend
+
+    QTest::newRow("serial QDirIterator") << 1 << int(DirectoryWalker::Backend::QtIterator);
+    QTest::newRow("parallel QDirIterator") << 0 << int(DirectoryWalker::Backend::QtIterator); // one worker per core
+    if (DirectoryWalker::isAvailable(DirectoryWalker::Backend::LinuxGetdents)) {
+        QTest::newRow("serial getdents64") << 1 << int(DirectoryWalker::Backend::LinuxGetdents);
+        QTest::newRow("parallel getdents64") << 0 << int(DirectoryWalker::Backend::LinuxGetdents);
+    }
+}
+
+void TestFileScanner::benchmarkScanThroughput() {
+    QFETCH(int, workers);
+    QFETCH(int, backend);
+
+    FileScanner scanner;
+    scanner.setWorkerCount(workers);
+    scanner.setWalkerBackend(static_cast<DirectoryWalker::Backend>(backend));
+
+    qsizetype files = 0;
+
+    // One iteration scans the fileCount_m files of the fixture
+    QBENCHMARK {
+        files = runScan(scanner).size();
+    }
+
+    QCOMPARE(files, fileCount_m);
+}
+
+void TestFileScanner::benchmarkDuplicateGrouping_data() {
+    QTest::addColumn<QString>("backend");
+    QTest::addColumn<int>("entries");
+
+    for (const QString backend : {"qmap-hex", "qhash", "flat"}) {
+        for (const int entries : {10'000, 100'000, 1'000'000}) {
+            QTest::newRow(qPrintable(QString("%1 %2").arg(backend).arg(entries))) << backend << entries;
+        }
+    }
+}
+
+// Phase 2/3 of a buffered scan on synthetic hashes: count every hash, then hand out
+// group ids in file order. Every tenth entry repeats an earlier hash.
+void TestFileScanner::benchmarkDuplicateGrouping() {
+    QFETCH(QString, backend);
+    QFETCH(int, entries);
+
+    QRandomGenerator random(42);
+    QList<FileHash> hashes;
+    hashes.reserve(entries);
+    for (int i = 0; i < entries; ++i) {
+        hashes.append(i % 10 == 9 ? hashes.at(random.bounded(i)) : FileHash{random.generate64() | 1, 0});
+    }
+
+    QStringList hexHashes; // Former representation, a QString per file
+    if (backend == "qmap-hex") {
+        hexHashes.reserve(entries);
+        for (const FileHash &hash : std::as_const(hashes)) hexHashes.append(hash.toString());
+    }
+
+    int duplicates = 0;
+
+    QBENCHMARK {
+        duplicates = 0;
+
+        if (backend == "qmap-hex") {
+            QMap<QString, int> countMap;
+            QMap<QString, int> groupMap;
+            int nextGroupId = 1;
+            for (const QString &hash : std::as_const(hexHashes)) countMap[hash]++;
+            for (const QString &hash : std::as_const(hexHashes)) {
+                if (countMap.value(hash) > 1) {
+                    if (!groupMap.contains(hash)) groupMap.insert(hash, nextGroupId++);
+                    duplicates += groupMap.value(hash) > 0;
+                }
+            }
+        } else if (backend == "qhash") {
+            QHash<FileHash, int> countMap;
+            QHash<FileHash, int> groupMap;
+            int nextGroupId = 1;
+            for (const FileHash &hash : std::as_const(hashes)) countMap[hash]++;
+            for (const FileHash &hash : std::as_const(hashes)) {
+                if (countMap.value(hash) > 1) {
+                    if (!groupMap.contains(hash)) groupMap.insert(hash, nextGroupId++);
+                    duplicates += groupMap.value(hash) > 0;
+                }
+            }
+        } else {
+            HashGroupIndex index;
+            for (const FileHash &hash : std::as_const(hashes)) index.add(hash);
+            for (const FileHash &hash : std::as_const(hashes)) {
+                if (index.count(hash) > 1) {
+                    duplicates += index.groupId(hash) > 0;
+                }
+            }
+        }
+    }
+
+    QVERIFY(duplicates >= entries / 10);
+}
+
+void TestFileScanner::benchmarkFilterMatching_data() {
+    QTest::addColumn<bool>("matcher");
+
+    QTest::newRow("QDir::match") << false;
+    QTest::newRow("ExtensionMatcher") << true;
+}
+
+void TestFileScanner::benchmarkFilterMatching() {
+    QFETCH(bool, matcher);
+
+    const QStringList filters = FileUtils::getAudioFormats() + FileUtils::getGuitarProFormats() +
+                                FileUtils::getDocFormats() + FileUtils::getVideoFormats();
+    const QStringList names = {"Intro.gp5", "backing.MP3", "cover.jpeg", "setlist.ods", "thumbs.db", "desktop.ini", "live.mkv", "Song.flac"};
+
+    constexpr int namesPerRun = 10000; // Per iteration
+    int matched = 0;
+
+    QBENCHMARK {
+        matched = 0;
+
+        const ExtensionMatcher filter(filters); // Built once per scan, so it is part of the measurement
+        for (int i = 0; i < namesPerRun; ++i) {
+            const QString &name = names.at(i % names.size());
+            const bool match = matcher ? filter.matches(name)
+                                       : std::any_of(filters.cbegin(), filters.cend(), [&name](const QString &f) {
+                                             return QDir::match(f, name);
+                                         });
+            matched += match;
+        }
+    }
+
+    QCOMPARE(matched, namesPerRun / names.size() * 6);
+}
+
+// -- ENDE --
+QTEST_GUILESS_MAIN(TestFileScanner)
+#include "tst_filescanner.moc"
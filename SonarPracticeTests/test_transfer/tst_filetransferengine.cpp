@@ -0,0 +1,196 @@
+#include <QTest>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+#include "filetransferengine.h"
+
+class TestFileTransferEngine : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void testRunCopiesFiles();
+    void testMethodFallback_data();
+    void testMethodFallback();
+    void testFailedCopyRemovesPartialFile_data();
+    void testFailedCopyRemovesPartialFile();
+
+private:
+    QString writeFile(const QString &name, const QByteArray &content);
+
+    QTemporaryDir dir_m;
+    QByteArray content_m; // Larger than the buffer of Method::Buffered, not a multiple of it
+    QString source_m;
+};
+
+void TestFileTransferEngine::initTestCase() {
+    QVERIFY(dir_m.isValid());
+
+    content_m.resize(3 * 1024 * 1024 + 123);
+    for (qsizetype i = 0; i < content_m.size(); ++i) {
+        content_m[i] = char((i * 131) ^ (i >> 11));
+    }
+    source_m = writeFile("source.bin", content_m);
+    QVERIFY(!source_m.isEmpty());
+}
+
+QString TestFileTransferEngine::writeFile(const QString &name, const QByteArray &content) {
+    const QString path = dir_m.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size()) return QString();
+    return path;
+}
+
+void TestFileTransferEngine::testRunCopiesFiles() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir().mkpath(dir.filePath("source")));
+    QVERIFY(QDir().mkpath(dir.filePath("target")));
+
+    // Empty, small and multi-chunk files; the limit lets only a few run at once
+    QList<FileTransferEngine::Transfer> transfers;
+    QList<QByteArray> contents;
+    qint64 totalBytes = 0;
+    for (int i = 0; i < 24; ++i) {
+        const qint64 size = (i % 4 == 0) ? 0 : (i % 4 == 1 ? 100 : (i % 4 == 2 ? 300 * 1024 : 9 * 1024 * 1024 + i));
+        QByteArray data(size, Qt::Uninitialized);
+        for (qsizetype b = 0; b < size; ++b) {
+            data[b] = char((b * 31 + i) & 0xFF);
+        }
+
+        const QString source = dir.filePath(QString("source/file_%1.bin").arg(i));
+        QFile file(source);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(data), size);
+        file.close();
+
+        transfers.append({source, dir.filePath(QString("target/file_%1.bin").arg(i)), size});
+        contents.append(data);
+        totalBytes += size;
+    }
+
+    FileTransferEngine engine;
+    engine.setConcurrency(4);
+    engine.setMaxBytesInFlight(10 * 1024 * 1024);
+
+    QList<int> reported(transfers.size(), 0);
+    const bool copied = engine.run(transfers, [&reported](const FileTransferEngine::Result &result) {
+        if (result.success) reported[result.index]++;
+        return result.success;
+    });
+    QVERIFY(copied);
+    QCOMPARE(reported, QList<int>(transfers.size(), 1));
+    QCOMPARE(engine.bytesTransferred(), totalBytes);
+    QVERIFY(engine.megabytesPerSecond() > 0.0);
+    QCOMPARE(QDir(dir.filePath("target")).entryList(QDir::Files).size(), transfers.size()); // No partial files left
+
+    for (qsizetype i = 0; i < transfers.size(); ++i) {
+        QFile file(transfers.at(i).target);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), contents.at(i));
+    }
+
+    // Existing targets are never overwritten
+    const FileTransferEngine::Result existing = FileTransferEngine::copyFile(transfers.at(1).source, transfers.at(2).target);
+    QVERIFY(!existing.success);
+    QVERIFY(!existing.error.isEmpty());
+    QCOMPARE(QFileInfo(transfers.at(2).target).size(), transfers.at(2).size);
+
+    // A canceled copy leaves no target behind
+    const std::atomic<bool> canceled{true};
+    const QString canceledTarget = dir.filePath("target/canceled.bin");
+    QVERIFY(!FileTransferEngine::copyFile(transfers.at(3).source, canceledTarget, &canceled).success);
+    QVERIFY(!QFile::exists(canceledTarget));
+
+    // Once finished() returns false, no further copy starts
+    QVERIFY(QDir(dir.filePath("target")).removeRecursively());
+    QVERIFY(QDir().mkpath(dir.filePath("target")));
+    engine.setConcurrency(1);
+    int finishedCount = 0;
+    QVERIFY(!engine.run(transfers, [&finishedCount](const FileTransferEngine::Result &) {
+        ++finishedCount;
+        return false;
+    }));
+    QCOMPARE(finishedCount, 1);
+    QCOMPARE(QDir(dir.filePath("target")).entryList(QDir::Files).size(), 1);
+}
+
+void TestFileTransferEngine::testMethodFallback_data() {
+    QTest::addColumn<int>("method"); // FileTransferEngine::Method, the first one tried
+
+    for (const FileTransferEngine::Method method : {FileTransferEngine::Method::Reflink,
+                                                    FileTransferEngine::Method::CopyFileRange,
+                                                    FileTransferEngine::Method::Sendfile,
+                                                    FileTransferEngine::Method::Buffered}) {
+        QTest::newRow(qPrintable(FileTransferEngine::methodName(method))) << int(method);
+    }
+}
+
+// Every method of the chain copies the file exactly; a method the file system lacks
+// hands over to the next one (tmpfs has no reflinks, for example)
+void TestFileTransferEngine::testMethodFallback() {
+    QFETCH(int, method);
+    const auto firstMethod = static_cast<FileTransferEngine::Method>(method);
+
+    const QString target = dir_m.filePath(QString("copy_%1.bin").arg(QTest::currentDataTag()));
+    QFile::remove(target);
+
+    std::atomic<qint64> bytes{0};
+    const FileTransferEngine::Result result = FileTransferEngine::copyFile(source_m, target, nullptr, &bytes, firstMethod);
+    QVERIFY2(result.success, qPrintable(result.error));
+    QVERIFY(result.method >= firstMethod);
+    qInfo().noquote() << QTest::currentDataTag() << "->" << FileTransferEngine::methodName(result.method);
+
+    QCOMPARE(bytes.load(), qint64(content_m.size()));
+    QVERIFY(!QFile::exists(target + FileTransferEngine::kPartialSuffix));
+    QCOMPARE(QFileInfo(target).permissions(), QFileInfo(source_m).permissions());
+
+    QFile copy(target);
+    QVERIFY(copy.open(QIODevice::ReadOnly));
+    QVERIFY(copy.readAll() == content_m);
+}
+
+void TestFileTransferEngine::testFailedCopyRemovesPartialFile_data() {
+    testMethodFallback_data();
+}
+
+// A copy that fails after the partial file was opened removes it again, also one a
+// crash left behind; the target is never created
+void TestFileTransferEngine::testFailedCopyRemovesPartialFile() {
+    QFETCH(int, method);
+    const auto firstMethod = static_cast<FileTransferEngine::Method>(method);
+
+    // Opening a directory for reading works, reading from it fails with EISDIR
+    const QString source = dir_m.filePath("not_a_file");
+    QVERIFY(QDir().mkpath(source));
+
+    const QString target = dir_m.filePath(QString("failed_%1.bin").arg(QTest::currentDataTag()));
+    const QString partial = target + FileTransferEngine::kPartialSuffix;
+    QVERIFY(!writeFile(QFileInfo(partial).fileName(), "left by a crash").isEmpty());
+
+    const FileTransferEngine::Result failed = FileTransferEngine::copyFile(source, target, nullptr, nullptr, firstMethod);
+    QVERIFY(!failed.success);
+    QVERIFY(!failed.error.isEmpty());
+    QVERIFY(!QFile::exists(partial));
+    QVERIFY(!QFile::exists(target));
+
+    // Canceled before the copy starts
+    const std::atomic<bool> canceled{true};
+    QVERIFY(!FileTransferEngine::copyFile(source_m, target, &canceled, nullptr, firstMethod).success);
+    QVERIFY(!QFile::exists(partial));
+    QVERIFY(!QFile::exists(target));
+
+    // An existing target is kept as it is
+    QVERIFY(!writeFile(QFileInfo(target).fileName(), "existing").isEmpty());
+    QVERIFY(!FileTransferEngine::copyFile(source_m, target, nullptr, nullptr, firstMethod).success);
+    QVERIFY(!QFile::exists(partial));
+    QCOMPARE(QFileInfo(target).size(), qint64(8));
+}
+
+// -- ENDE --
+QTEST_GUILESS_MAIN(TestFileTransferEngine)
+#include "tst_filetransferengine.moc"
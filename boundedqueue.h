@@ -0,0 +1,92 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include <deque>
+
+/**
+ * @brief Blocking FIFO with a fixed capacity for producer/consumer stages.
+ *
+ * push() blocks while the queue is full, pop() blocks while it is empty.
+ * After close() no further items are accepted, waiting producers return false
+ * and consumers drain the remaining items before pop() returns false.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    enum class PopStatus {
+        Item,
+        Timeout,
+        Closed // Closed and drained
+    };
+
+    explicit BoundedQueue(qsizetype capacity) : capacity_m(qMax<qsizetype>(1, capacity)) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool push(T item) {
+        QMutexLocker locker(&mutex_m);
+        while (!closed_m && static_cast<qsizetype>(items_m.size()) >= capacity_m) {
+            notFull_m.wait(&mutex_m);
+        }
+        if (closed_m) return false;
+
+        items_m.push_back(std::move(item));
+        notEmpty_m.wakeOne();
+        return true;
+    }
+
+    [[nodiscard]] bool pop(T &out) {
+        QMutexLocker locker(&mutex_m);
+        while (!closed_m && items_m.empty()) {
+            notEmpty_m.wait(&mutex_m);
+        }
+        if (items_m.empty()) return false; // closed and drained
+
+        out = std::move(items_m.front());
+        items_m.pop_front();
+        notFull_m.wakeOne();
+        return true;
+    }
+
+    // pop() that gives up at deadline, so a consumer can also act on time (e.g. flush a batch)
+    [[nodiscard]] PopStatus pop(T &out, QDeadlineTimer deadline) {
+        QMutexLocker locker(&mutex_m);
+        while (!closed_m && items_m.empty()) {
+            if (!notEmpty_m.wait(&mutex_m, deadline)) break;
+        }
+        if (items_m.empty()) return closed_m ? PopStatus::Closed : PopStatus::Timeout;
+
+        out = std::move(items_m.front());
+        items_m.pop_front();
+        notFull_m.wakeOne();
+        return PopStatus::Item;
+    }
+
+    void close() {
+        QMutexLocker locker(&mutex_m);
+        closed_m = true;
+        notEmpty_m.wakeAll();
+        notFull_m.wakeAll();
+    }
+
+    [[nodiscard]] bool isClosed() const {
+        QMutexLocker locker(&mutex_m);
+        return closed_m;
+    }
+
+private:
+    mutable QMutex mutex_m;
+    QWaitCondition notEmpty_m;
+    QWaitCondition notFull_m;
+    std::deque<T> items_m;
+    const qsizetype capacity_m;
+    bool closed_m{false};
+};
+
+#endif // BOUNDEDQUEUE_H
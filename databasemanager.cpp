@@ -25,18 +25,31 @@
  * - tunings: Guitar tuning options
  * - file_relations: Links between related media files
  * - settings: Application configuration key-value pairs
+ * - scan_cache: Hashes of scanned files, so unchanged files are not read again
  *
  * @warning Foreign key constraints are enabled via PRAGMA. Ensure ON DELETE CASCADE is
  *          properly configured in foreign key definitions for cascading deletes.
  */
 #include "databasemanager.h"
 #include "fileutils.h"
+#include "samplehash.h"
 
 #include <QDir>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QThread>
 #include <QUrl>
 
+#include <numeric>
+
+namespace {
+// practice_date holds ISO text ("yyyy-MM-dd", possibly followed by a time), so all entries
+// of a day sort between the day and the next day. Comparing the column itself instead of
+// DATE(practice_date) lets SQLite use the practice_journal indexes.
+QString dayBegin(QDate date) { return date.toString("yyyy-MM-dd"); }
+QString dayEnd(QDate date) { return date.addDays(1).toString("yyyy-MM-dd"); }
+} // namespace
+
 // =============================================================================
 // --- Singleton & Lifecycle
 // =============================================================================
@@ -58,9 +71,11 @@ DatabaseManager &DatabaseManager::instance()
  *
  * Upon successful connection, this function:
  * - Enables foreign key constraints via PRAGMA
- * - Checks the database schema version
- * - Creates initial tables if the database is new
- * - Sets the database version if newly created
+ * - Applies the connection profile (journal mode, synchronous, mmap, cache, temp store)
+ * - Runs the schema migrations (registerMigrations()) from the stored version up to the
+ *   current one; a new database gets all tables in the first step
+ * - Drops the stored hashes if they were made with an older algorithm (resetFileHashes())
+ * - Opens the background connections (startWorkers())
  *
  * @param dbPath The file path to the SQLite database file.
  *
@@ -81,33 +96,32 @@ bool DatabaseManager::initDatabase(const QString &dbPath)
             return true;
         }
 
+        stopWorkers();
+        statements_m.clear(existingDb.connectionName());
+        clearCaches();
         existingDb = QSqlDatabase(); // Release handle
         QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
     }
 
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName(dbPath);
-
-    if (!db.open()) {
-        qCritical() << "Connection failed:" << db.lastError().text();
+    if (!openConnection(db, dbPath))
         return false;
-    }
 
-    QSqlQuery q(db);
-    if (!q.exec("PRAGMA foreign_keys = ON;")) {
-        qWarning() << "Could not activate foreign keys: " << q.lastError().text();
-    }
-
-    int currentVersion = getDatabaseVersion();
-    const int targetVersion = 1;
+    SchemaMigrator migrator(db);
+    registerMigrations(migrator);
+    const bool migrated = migrator.migrate();
+    migrationReport_m = migrator.report();
+    if (!migrated)
+        return false;
 
-    if (currentVersion < targetVersion) {
-        if (!createInitialTables())
-            return false;
-        if (!setDatabaseVersion(targetVersion))
-            return false;
+    // rehashMediaFilesAsync() fills the dropped hashes in after the start
+    if (getSetting("hash_algorithm", QString()) != SampleHash::kAlgorithmName) {
+        if (!resetFileHashes()) {
+            qWarning() << "[DatabaseManager] hashes of the old algorithm could not be dropped, duplicates may not be detected";
+        }
     }
 
+    startWorkers(dbPath);
     return true;
 }
 
@@ -128,17 +142,216 @@ bool DatabaseManager::initDatabase(const QString &dbPath)
  */
 void DatabaseManager::closeDatabase()
 {
+    // Finish the queued jobs first, they may still write
+    stopWorkers();
+
     // Remember names
     QSqlDatabase db = QSqlDatabase::database();
 
+    // Prepared statements must not outlive the connection
+    const StatementCache::Stats stats = statements_m.stats();
+    qDebug() << "[DatabaseManager] statement cache:" << stats.hits << "hits," << stats.misses << "misses";
+    statements_m.clear(db.connectionName());
+    clearCaches();
+
     // Close database
     if (db.isOpen()) {
+        // Move the WAL content into the database file, so the file is complete on its own
+        // (e.g. MappingPage renames it right after closing)
+        QSqlQuery q(db);
+        if (!q.exec("PRAGMA wal_checkpoint(TRUNCATE);")) {
+            qWarning() << "[DatabaseManager] wal_checkpoint error: " << q.lastError().text();
+        }
+        q.finish();
         db.close();
     }
 
     db = QSqlDatabase();
 }
 
+/**
+ * @brief Opens db (added, not yet open) on dbPath and sets it up like every connection.
+ *
+ * Used for the default connection and, on their own threads, for those of the DatabaseWorkers.
+ * A read-only connection is opened with SQLITE_OPEN_READONLY, so a write on it fails.
+ *
+ * @return false if the database could not be opened; a profile that could not be applied
+ *         completely is only logged.
+ */
+bool DatabaseManager::openConnection(QSqlDatabase &db, const QString &dbPath, bool readOnly)
+{
+    db.setDatabaseName(dbPath);
+
+    QStringList options;
+    if (profile_m.busyTimeoutMs > 0) {
+        options << QString("QSQLITE_BUSY_TIMEOUT=%1").arg(profile_m.busyTimeoutMs);
+    }
+    if (readOnly) {
+        options << "QSQLITE_OPEN_READONLY";
+    }
+    db.setConnectOptions(options.join(';'));
+
+    if (!db.open()) {
+        qCritical() << "Connection failed:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db);
+    if (!q.exec("PRAGMA foreign_keys = ON;")) {
+        qWarning() << "Could not activate foreign keys: " << q.lastError().text();
+    }
+
+    if (!applyConnectionProfile(db)) {
+        qWarning() << "[DatabaseManager] connection profile could not be applied completely, using SQLite defaults";
+    }
+    return true;
+}
+
+/**
+ * @brief Applies profile_m to a freshly opened connection.
+ *
+ * WAL journaling lets a commit append to the log instead of rewriting and syncing a
+ * rollback journal; with synchronous = NORMAL only checkpoints are synced. This makes
+ * the autosaves of SonarLessonPage (notes, practice table) cheap. Memory mapping, a
+ * larger page cache and in-memory temp tables speed up the read queries.
+ *
+ * journal_mode is checked, because SQLite silently keeps the old mode where WAL is not
+ * possible (e.g. on some network file systems).
+ *
+ * @return false if one of the pragmas failed or WAL was refused.
+ */
+bool DatabaseManager::applyConnectionProfile(QSqlDatabase &db)
+{
+    QSqlQuery q(db);
+    bool ok = true;
+
+    if (!q.exec(QString("PRAGMA journal_mode = %1;").arg(profile_m.journalMode)) || !q.next()) {
+        qCritical() << "[DatabaseManager] journal_mode error: " << q.lastError().text();
+        ok = false;
+    } else if (q.value(0).toString().compare(profile_m.journalMode, Qt::CaseInsensitive) != 0) {
+        qWarning() << "[DatabaseManager] journal_mode" << profile_m.journalMode << "refused, using" << q.value(0).toString();
+        ok = false;
+    }
+    q.finish();
+
+    const QStringList pragmas = {
+        QString("PRAGMA synchronous = %1;").arg(profile_m.synchronous),
+        QString("PRAGMA mmap_size = %1;").arg(profile_m.mmapSize),
+        QString("PRAGMA cache_size = -%1;").arg(profile_m.cacheSizeKiB), // negative: KiB instead of pages
+        QString("PRAGMA temp_store = %1;").arg(profile_m.tempStore),
+    };
+
+    for (const QString &pragma : pragmas) {
+        if (!q.exec(pragma)) {
+            qCritical() << "[DatabaseManager] applyConnectionProfile error: " << q.lastError().text();
+            qDebug() << "[DatabaseManager] applyConnectionProfile fullquery: " << pragma;
+            ok = false;
+        }
+        q.finish();
+    }
+
+    return ok;
+}
+
+QSqlDatabase DatabaseManager::connection() const
+{
+    const QString workerConnection = DatabaseWorker::currentConnectionName();
+    if (!workerConnection.isEmpty())
+        return QSqlDatabase::database(workerConnection, false);
+
+    // Qt SQL connections must stay on the thread that opened them; any other thread has
+    // to go through a DatabaseWorker
+    Q_ASSERT_X(QThread::currentThread() == thread(), "DatabaseManager::connection",
+               "default connection used outside the GUI thread");
+    return QSqlDatabase::database();
+}
+
+/**
+ * @brief Opens the background connections to dbPath: the writer and the read-only pool.
+ *
+ * The writer (worker_m) serves enqueueWrite(). The profile_m.readConnections readers serve the
+ * *Async reads. In WAL mode readers neither block the writer nor the default connection, nor
+ * wait for them, so a long catalog read and a journal autosave run side by side. Without WAL a
+ * reader would hold the lock the writers need, so the reads then run on the writer.
+ *
+ * An in-memory database would be a different, empty one on a second connection; then no
+ * worker is started and the *Async calls run on the default connection.
+ */
+void DatabaseManager::startWorkers(const QString &dbPath)
+{
+    if (dbPath == ":memory:")
+        return;
+
+    if (!worker_m.start(kWorkerConnection, [this, dbPath](QSqlDatabase &db) { return openConnection(db, dbPath); })) {
+        qWarning() << "[DatabaseManager] background connection not available, async queries run on the GUI thread";
+        return;
+    }
+
+    if (profile_m.journalMode.compare("WAL", Qt::CaseInsensitive) != 0)
+        return;
+
+    for (int i = 0; i < profile_m.readConnections; ++i) {
+        auto reader = std::make_unique<DatabaseWorker>();
+        if (!reader->start(kReaderConnection.arg(i), [this, dbPath](QSqlDatabase &db) { return openConnection(db, dbPath, true); })) {
+            qWarning() << "[DatabaseManager] read connection" << i << "not available";
+            break;
+        }
+        readers_m.push_back(std::move(reader));
+    }
+}
+
+void DatabaseManager::stopWorkers()
+{
+    for (qsizetype i = 0; i < qsizetype(readers_m.size()); ++i) {
+        stopWorker(*readers_m[i], kReaderConnection.arg(i));
+    }
+    readers_m.clear();
+    stopWorker(worker_m, kWorkerConnection);
+}
+
+void DatabaseManager::stopWorker(DatabaseWorker &worker, const QString &connectionName)
+{
+    if (!worker.isRunning())
+        return;
+
+    // Prepared statements of the worker connection go on its own thread, before it is closed
+    (void)worker.enqueue([this, connectionName]() { statements_m.clear(connectionName); });
+    worker.stop();
+}
+
+DatabaseWorker &DatabaseManager::reader()
+{
+    DatabaseWorker *idlest = &worker_m;
+    for (const auto &reader : readers_m) {
+        if (idlest == &worker_m || reader->pendingJobs() < idlest->pendingJobs()) {
+            idlest = reader.get();
+        }
+    }
+    return *idlest;
+}
+
+StatementCache::Handle DatabaseManager::cachedQuery(const QString &sql)
+{
+    return statements_m.acquire(connection(), sql);
+}
+
+/**
+ * @brief The schema history, applied by SchemaMigrator on every start.
+ *
+ * Never change a step that has been released; add a new one with the next version.
+ * Every step has to work on a database that already contains its changes, because
+ * step 1 creates the complete current schema for new databases.
+ */
+void DatabaseManager::registerMigrations(SchemaMigrator &migrator)
+{
+    migrator.addStep(1, "initial schema", [this] { return createInitialTables(); });
+    migrator.addStep(2, "integer file hashes, scan cache", [this] {
+        return migrateFileHashColumns() && createInitialTables();
+    });
+    migrator.addStep(3, "practice_journal indexes", [this] { return createJournalIndexes(); });
+    migrator.addStep(4, "import journal", [this] { return createImportJournalTables(); });
+}
+
 // =============================================================================
 // --- Setup & Metadata (Initialization & Versioning)
 // =============================================================================
@@ -158,6 +371,7 @@ void DatabaseManager::closeDatabase()
  * - artists: Artist/band names referenced by songs
  * - tunings: Guitar tuning standards (populated with E-Standard, Eb-Standard, Drop D, Drop C, D-Standard)
  * - file_relations: Relationships between media files
+ * - scan_cache: Hash per scanned file path together with size, modification time and inode
  *
  * Additionally creates:
  * - Index on media_files.file_path for optimized file lookups
@@ -172,7 +386,7 @@ void DatabaseManager::closeDatabase()
  */
 bool DatabaseManager::createInitialTables()
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
     if (!q.exec("PRAGMA foreign_keys = ON"))
         return false;
@@ -223,7 +437,7 @@ bool DatabaseManager::createInitialTables()
                 "is_managed INTEGER DEFAULT 0, " // 1 = Relativ zu SonarPath, 0 = Absolut
                 "file_type TEXT, "
                 "file_size INTEGER, "
-                "file_hash TEXT UNIQUE,"
+                "file_hash INTEGER UNIQUE, " // Sampled hash (FileHash::sample, stored bit for bit)
                 "can_be_practiced BOOL, "
                 "FOREIGN KEY(song_id) REFERENCES songs(id) ON DELETE CASCADE)")) {
         qCritical() << "[DatabaseManager] create table media_files failed, error: "
@@ -364,6 +578,21 @@ bool DatabaseManager::createInitialTables()
         return false;
     }
 
+    // 13. SCAN_CACHE (FileScanner skips hashing files whose size/mtime/inode did not change)
+    if (!q.exec("CREATE TABLE IF NOT EXISTS scan_cache ("
+                "file_path TEXT PRIMARY KEY, "
+                "file_size INTEGER NOT NULL, "
+                "mtime INTEGER NOT NULL, "  // msecs since epoch
+                "inode INTEGER DEFAULT 0, " // 0 = unknown
+                "file_hash INTEGER NOT NULL, "
+                "scanned_at DATETIME DEFAULT CURRENT_TIMESTAMP)")) {
+        qCritical() << "[DatabaseManager] create table scan_cache failed, error: "
+                    << q.lastError().text();
+        qDebug() << "[DatabaseManager] create table scan_cache failed, fullquery: "
+                 << q.executedQuery();
+        return false;
+    }
+
     if (!q.exec("INSERT OR IGNORE INTO settings (key, value) VALUES ('managed_path', '')")) {
         qCritical() << "[DatabaseManager] insert into settings managed_path failed, error: "
                     << q.lastError().text();
@@ -404,6 +633,69 @@ bool DatabaseManager::createInitialTables()
         return false;
     }
 
+    return createJournalIndexes() && createImportJournalTables();
+}
+
+/**
+ * @brief Creates the practice_journal indexes (schema version 3).
+ *
+ * The day queries compare practice_date with a range (see dayBegin()), so they can
+ * search these indexes: one song on one day (lesson page) and all songs of a day
+ * (calendar).
+ */
+bool DatabaseManager::createJournalIndexes()
+{
+    QSqlQuery q(connection());
+    if (!q.exec("CREATE INDEX IF NOT EXISTS idx_journal_song_date ON practice_journal(song_id, practice_date)")
+        || !q.exec("CREATE INDEX IF NOT EXISTS idx_journal_date_song ON practice_journal(practice_date, song_id)")) {
+        qCritical() << "[DatabaseManager] create index for practice_journal failed, error: "
+                    << q.lastError().text();
+        qDebug() << "[DatabaseManager] create index for practice_journal failed, fullquery: "
+                 << q.executedQuery();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Creates the import journal tables (schema version 4).
+ *
+ * import_jobs holds one row per import that has not finished yet, import_journal the
+ * tasks of it with their ImportState. The task columns repeat ImportTask, so an import
+ * interrupted by a crash can be resumed without the dialog that started it.
+ */
+bool DatabaseManager::createImportJournalTables()
+{
+    QSqlQuery q(connection());
+    if (!q.exec("CREATE TABLE IF NOT EXISTS import_jobs ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "base_path TEXT, "
+                "is_managed INTEGER, "
+                "is_moved INTEGER, "
+                "created_at DATETIME DEFAULT CURRENT_TIMESTAMP)")
+        || !q.exec("CREATE TABLE IF NOT EXISTS import_journal ("
+                   "job_id INTEGER NOT NULL, "
+                   "task_index INTEGER NOT NULL, "
+                   "source_path TEXT, "
+                   "relative_path TEXT, "
+                   "item_name TEXT, "
+                   "file_size INTEGER, "
+                   "file_suffix TEXT, "
+                   "category_path TEXT, "
+                   "file_hash INTEGER, "
+                   "full_hash INTEGER, "
+                   "state INTEGER NOT NULL DEFAULT 0, "          // ImportState
+                   "target_path TEXT, "
+                   "file_operation INTEGER NOT NULL DEFAULT 0, " // ImportFileOperation
+                   "song_id INTEGER, "
+                   "PRIMARY KEY (job_id, task_index), "
+                   "FOREIGN KEY(job_id) REFERENCES import_jobs(id) ON DELETE CASCADE) WITHOUT ROWID")) {
+        qCritical() << "[DatabaseManager] create import journal tables failed, error: "
+                    << q.lastError().text();
+        qDebug() << "[DatabaseManager] create import journal tables failed, fullquery: "
+                 << q.executedQuery();
+        return false;
+    }
     return true;
 }
 
@@ -414,7 +706,7 @@ bool DatabaseManager::createInitialTables()
  */
 bool DatabaseManager::hasData()
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
     q.prepare("SELECT id FROM songs LIMIT 1");
     return q.exec() && q.next();
@@ -431,10 +723,9 @@ bool DatabaseManager::hasData()
  */
 int DatabaseManager::getDatabaseVersion()
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
-    q.prepare("PRAGMA user_version");
-    if (q.next()) {
+    if (q.exec("PRAGMA user_version") && q.next()) {
         return q.value(0).toInt();
     }
     return 0;
@@ -458,7 +749,7 @@ int DatabaseManager::getDatabaseVersion()
  */
 bool DatabaseManager::setDatabaseVersion(int version)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
     // PRAGMA user_version cannot be used with bind values ​​(?).
     // Therefore, .arg() is the correct way to go here.
@@ -486,7 +777,8 @@ bool DatabaseManager::setDatabaseVersion(int version)
  * @param isManaged Whether the file is managed by the application.
  * @param fileType The type/category of the media file (e.g., "audio", "guitar_pro").
  * @param fileSize The size of the file in bytes.
- * @param fileHash The hash value of the file for integrity verification.
+ * @param fileHash The hash value of the file for integrity verification. Only the sampled
+ *                 hash is stored; an invalid hash is stored as NULL.
  *
  * @return true if the file was successfully added to the database, false otherwise.
  *
@@ -500,32 +792,29 @@ bool DatabaseManager::addFileToSong(qlonglong songId,
                                     bool isManaged,
                                     const QString &fileType,
                                     qint64 fileSize,
-                                    QString fileHash)
+                                    const FileHash &fileHash)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
     // Logic: Is it a Guitar Pro file?
     // Take the ending (e.g., "gp5") and add "*." before it.
     // so that it matches QStringLists in FileUtils exactly.
     QString suffix = "*." + QFileInfo(filePath).suffix().toLower();
     bool isPracticeTarget = FileUtils::getGuitarProFormats().contains(suffix);
 
-    q.prepare("INSERT OR IGNORE INTO media_files (song_id, file_path, is_managed, file_type, "
-              "file_size, file_hash, can_be_practiced) "
-              "VALUES (?, ?, ?, ?, ?, ?, ?)");
-
-    q.addBindValue(songId);
-    q.addBindValue(filePath);
-    q.addBindValue(isManaged ? 1 : 0);
-    q.addBindValue(fileType);
-    q.addBindValue(fileSize);
-    q.addBindValue(fileHash);
-    q.addBindValue(isPracticeTarget ? 1 : 0);
-
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] Error addFileToSong: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] Error addFileToSong, fullquery: " << q.executedQuery();
+    StatementCache::Handle q = cachedQuery("INSERT OR IGNORE INTO media_files (song_id, file_path, is_managed, file_type, "
+                                           "file_size, file_hash, can_be_practiced) "
+                                           "VALUES (?, ?, ?, ?, ?, ?, ?)");
+
+    q->addBindValue(songId);
+    q->addBindValue(filePath);
+    q->addBindValue(isManaged ? 1 : 0);
+    q->addBindValue(fileType);
+    q->addBindValue(fileSize);
+    q->addBindValue(fileHash.isValid() ? QVariant(FileHash::toDatabase(fileHash.sample)) : QVariant());
+    q->addBindValue(isPracticeTarget ? 1 : 0);
+
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] Error addFileToSong: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] Error addFileToSong, fullquery: " << q->executedQuery();
         return false;
     }
     return true;
@@ -567,20 +856,18 @@ qlonglong DatabaseManager::createSong(const QString &title,
     int artistId = getOrCreateArtist(artist);
     int tuningId = getOrCreateTuning(tuning);
 
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-    q.prepare("INSERT INTO songs (title, artist_id, tuning_id, base_bpm) VALUES (?, ?, ?, ?)");
-    q.addBindValue(title);
-    q.addBindValue(artistId);
-    q.addBindValue(tuningId);
-    // q.addBindValue(bpm > 0 ? bpm : 120); // Default 120 falls 0
-    q.addBindValue(bpm);
+    StatementCache::Handle q = cachedQuery("INSERT INTO songs (title, artist_id, tuning_id, base_bpm) VALUES (?, ?, ?, ?)");
+    q->addBindValue(title);
+    q->addBindValue(artistId);
+    q->addBindValue(tuningId);
+    // q->addBindValue(bpm > 0 ? bpm : 120); // Default 120 falls 0
+    q->addBindValue(bpm);
 
-    if (q.exec()) {
-        return q.lastInsertId().toLongLong();
+    if (q->exec()) {
+        return q->lastInsertId().toLongLong();
     } else {
-        qCritical() << "[DatabaseManager] Error createSong:" << q.lastError().text();
-        qDebug() << "[DatabaseManager] Error createSong, fullquery: " << q.executedQuery();
+        qCritical() << "[DatabaseManager] Error createSong:" << q->lastError().text();
+        qDebug() << "[DatabaseManager] Error createSong, fullquery: " << q->executedQuery();
         return -1;
     }
 }
@@ -588,130 +875,903 @@ qlonglong DatabaseManager::createSong(const QString &title,
 /**
  * @brief Retrieves the ID of an artist by name, creating a new artist record if it doesn't exist.
  *
- * This method searches the artists table for an existing artist with the specified name.
- * If found, it returns the artist's ID. If not found, a new artist record is created with
- * the provided name and its ID is returned.
+ * The name is looked up in the artist dictionary (loaded once per database). Only
+ * a name that is not known yet reaches the database: it is inserted and added to
+ * the dictionary and to artistModel().
  *
  * @param name The name of the artist to retrieve or create. Leading and trailing whitespace
  *             will be automatically trimmed.
  *
- * @return The ID of the artist (either existing or newly created).
+ * @return The ID of the artist (either existing or newly created), 0 if the insert failed.
  *
  * @note The artist name is trimmed of whitespace before both querying and inserting.
  *
- * @see QSqlQuery, QSqlDatabase
+ * @see NameDictionary
  */
 int DatabaseManager::getOrCreateArtist(const QString &name)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-    q.prepare("SELECT id FROM artists WHERE name = ?");
-    q.addBindValue(name.trimmed());
+    return internName(artists_m, "artists", name.trimmed());
+}
 
-    if (q.exec() && q.next()) {
-        return q.value(0).toInt();
+/**
+ * @brief Retrieves or creates a tuning record in the database.
+ *
+ * Same as getOrCreateArtist(), with the tuning dictionary and tuningModel().
+ *
+ * @param name The name of the tuning to search for or create. Whitespace is
+ *             trimmed before the operation.
+ *
+ * @return The ID of the existing or newly created tuning record, 0 if the insert failed.
+ */
+int DatabaseManager::getOrCreateTuning(const QString &name)
+{
+    return internName(tunings_m, "tunings", name.trimmed());
+}
+
+/**
+ * @brief Renames an artist; all songs of the artist show the new name.
+ *
+ * @return false if the name is taken by another artist (UNIQUE) or the update failed.
+ */
+bool DatabaseManager::renameArtist(int artistId, const QString &name)
+{
+    return renameName(artists_m, "artists", artistId, name.trimmed());
+}
+
+bool DatabaseManager::renameTuning(int tuningId, const QString &name)
+{
+    return renameName(tunings_m, "tunings", tuningId, name.trimmed());
+}
+
+QAbstractItemModel *DatabaseManager::artistModel()
+{
+    (void) loadNames(artists_m, "artists");
+    return artists_m.model();
+}
+
+QAbstractItemModel *DatabaseManager::tuningModel()
+{
+    (void) loadNames(tunings_m, "tunings");
+    return tunings_m.model();
+}
+
+bool DatabaseManager::loadNames(NameDictionary &dictionary, const QString &table)
+{
+    if (dictionary.isLoaded())
+        return true;
+
+    QSqlQuery q(connection());
+    q.setForwardOnly(true);
+    if (!q.exec(QString("SELECT id, name FROM %1").arg(table))) {
+        qCritical() << "[DatabaseManager] loadNames" << table << "error: " << q.lastError().text();
+        return false;
+    }
+
+    QHash<QString, int> ids;
+    while (q.next()) {
+        ids.insert(q.value(1).toString(), q.value(0).toInt());
+    }
+    dictionary.load(ids);
+    return true;
+}
+
+int DatabaseManager::internName(NameDictionary &dictionary, const QString &table, const QString &name)
+{
+    if (!loadNames(dictionary, table))
+        return 0;
+
+    if (const int id = dictionary.id(name); id != 0)
+        return id;
+
+    StatementCache::Handle q = cachedQuery(QString("INSERT INTO %1 (name) VALUES (?)").arg(table));
+    q->addBindValue(name);
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] internName" << table << "error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] internName fullquery: " << q->executedQuery();
+        return 0;
+    }
+
+    const int id = q->lastInsertId().toInt();
+    dictionary.insert(name, id);
+    return id;
+}
+
+bool DatabaseManager::renameName(NameDictionary &dictionary, const QString &table, int id, const QString &name)
+{
+    StatementCache::Handle q = cachedQuery(QString("UPDATE %1 SET name = ? WHERE id = ?").arg(table));
+    q->addBindValue(name);
+    q->addBindValue(id);
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] renameName" << table << "error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] renameName fullquery: " << q->executedQuery();
+        return false;
+    }
+
+    if (dictionary.isLoaded())
+        dictionary.rename(id, name);
+    ++nameGeneration_m; // The writer dictionaries still have the old name
+    return true;
+}
+
+void DatabaseManager::clearCaches()
+{
+    settings_m.clear();
+    if (DatabaseWorker::currentConnectionName().isEmpty()) {
+        artists_m.clear();
+        tunings_m.clear();
+        ++nameGeneration_m;
     } else {
-        q.prepare("INSERT INTO artists (name) VALUES (?)");
-        q.addBindValue(name.trimmed());
-        if (!q.exec()) {
-            qCritical() << "[DatabaseManager] getOrCreateArtist, error: " << q.lastError().text();
-            qDebug() << "[DatabaseManager] getOrCreateArtist, fullquery: " << q.executedQuery();
+        writerArtists_m.clear();
+        writerTunings_m.clear();
+    }
+}
+
+void DatabaseManager::reloadNameDictionaries()
+{
+    // Views keep the models, so fill them again right away instead of on the next use
+    const bool artistsLoaded = artists_m.isLoaded();
+    const bool tuningsLoaded = tunings_m.isLoaded();
+    artists_m.clear();
+    tunings_m.clear();
+    if (artistsLoaded)
+        (void) loadNames(artists_m, "artists");
+    if (tuningsLoaded)
+        (void) loadNames(tunings_m, "tunings");
+}
+
+/**
+ * @brief Imports many files at once (import dialog, setup wizard).
+ *
+ * Has the same result as createSong() and addFileToSong() for every task, without the
+ * SELECT-then-INSERT round trips: artists and tunings are resolved with the name dictionaries,
+ * songs and media files are written with multi-row INSERTs. SQLite assigns the song ids;
+ * they are taken from last_insert_rowid() after each songs statement (see insertRows()).
+ *
+ * @param tasks The files to import.
+ * @param songs The song for each task (same index).
+ * @param isManaged true if the files were copied into the managed folder; then the
+ *                  relative path is stored instead of the source path.
+ * @param songIds If given, receives the id of the song of each task (import journal).
+ *
+ * @return true if all rows were written, false on the first failing statement.
+ *
+ * @note Run it inside a transaction (ImportProcessor::executeImport does); otherwise
+ *       every statement is committed on its own.
+ * @note As in addFileToSong(), files whose path or hash is already in media_files are
+ *       skipped (INSERT OR IGNORE); their song is still created.
+ * @note On a DatabaseWorker thread (ImportProcessor) the names are resolved in the writer's
+ *       own dictionaries, loaded once and extended with the names each batch inserts; the
+ *       shared ones belong to the GUI thread (reloadNameDictionaries()).
+ */
+bool DatabaseManager::bulkImport(const QList<ImportTask> &tasks, const QList<ImportSong> &songs, bool isManaged,
+                                 QList<qlonglong> *songIds)
+{
+    if (tasks.size() != songs.size()) {
+        qCritical() << "[DatabaseManager] bulkImport:" << tasks.size() << "tasks but" << songs.size() << "songs";
+        return false;
+    }
+    if (tasks.isEmpty())
+        return true;
+
+    QStringList artists;
+    QStringList tunings;
+    artists.reserve(songs.size());
+    tunings.reserve(songs.size());
+    for (const ImportSong &song : songs) {
+        artists.append(song.artist.trimmed());
+        tunings.append(song.tuning.trimmed());
+    }
+
+    const bool onWorker = !DatabaseWorker::currentConnectionName().isEmpty();
+    if (onWorker && writerNameGeneration_m != nameGeneration_m) {
+        writerArtists_m.clear();
+        writerTunings_m.clear();
+        writerNameGeneration_m = nameGeneration_m;
+    }
+    NameDictionary &artistIds = onWorker ? writerArtists_m : artists_m;
+    NameDictionary &tuningIds = onWorker ? writerTunings_m : tunings_m;
+
+    if (!resolveNames(artistIds, "artists", artists) || !resolveNames(tuningIds, "tunings", tunings))
+        return false;
+
+    QVariantList songValues;
+    songValues.reserve(songs.size() * 4);
+    for (qsizetype i = 0; i < songs.size(); ++i) {
+        const ImportSong &song = songs.at(i);
+        songValues << song.title << artistIds.id(artists.at(i)) << tuningIds.id(tunings.at(i)) << song.bpm;
+    }
+
+    QList<qlonglong> ids;
+    if (!insertRows("INSERT INTO songs (title, artist_id, tuning_id, base_bpm)", 4, songValues, &ids))
+        return false;
+    if (songIds)
+        *songIds = ids;
+
+    const QStringList practiceFormats = FileUtils::getGuitarProFormats();
+    QVariantList fileValues;
+    fileValues.reserve(tasks.size() * 7);
+
+    for (qsizetype i = 0; i < tasks.size(); ++i) {
+        const ImportTask &task = tasks.at(i);
+        const qlonglong songId = ids.at(i);
+
+        const QString filePath = isManaged ? task.relativePath : QDir::cleanPath(task.sourcePath);
+        const QString suffix = "*." + QFileInfo(filePath).suffix().toLower();
+        fileValues << songId << filePath << (isManaged ? 1 : 0) << task.fileSuffix << task.fileSize
+                   << (task.fileHash.isValid() ? QVariant(FileHash::toDatabase(task.fileHash.sample)) : QVariant())
+                   << (practiceFormats.contains(suffix) ? 1 : 0);
+    }
+
+    return insertRows("INSERT OR IGNORE INTO media_files (song_id, file_path, is_managed, file_type, "
+                      "file_size, file_hash, can_be_practiced)",
+                      7, fileValues);
+}
+
+/**
+ * @brief Writes values row after row with as few multi-row INSERTs as kMaxBindValues allows.
+ *
+ * SQLite runs one statement at a time on a database, so the rows of one plain INSERT get
+ * consecutive rowids ending at last_insert_rowid(), even with other writers around. That
+ * does not hold for INSERT OR IGNORE (skipped rows) or when the rows carry their own ids.
+ *
+ * @param rowIds If given, receives the rowid of every inserted row, in the order of values.
+ */
+bool DatabaseManager::insertRows(const QString &insert, int columns, const QVariantList &values,
+                                 QList<qlonglong> *rowIds)
+{
+    if (rowIds) {
+        rowIds->clear();
+        rowIds->reserve(values.size() / columns);
+    }
+
+    const qsizetype valuesPerStatement = (kMaxBindValues / columns) * columns;
+    const QString row = u'(' + QStringList(columns, QStringLiteral("?")).join(", ") + u')';
+
+    for (qsizetype first = 0; first < values.size(); first += valuesPerStatement) {
+        const qsizetype count = qMin(valuesPerStatement, values.size() - first);
+
+        // All full chunks share one SQL text, so they share one prepared statement
+        StatementCache::Handle q = cachedQuery(insert + " VALUES " + QStringList(count / columns, row).join(", "));
+        for (qsizetype i = first; i < first + count; ++i) {
+            q->addBindValue(values.at(i));
+        }
+
+        if (!q->exec()) {
+            qCritical() << "[DatabaseManager] insertRows, error: " << q->lastError().text();
+            qDebug() << "[DatabaseManager] insertRows, fullquery: " << q->executedQuery();
+            return false;
+        }
+
+        if (rowIds) {
+            const qlonglong rows = count / columns;
+            const qlonglong lastId = q->lastInsertId().toLongLong();
+            if (q->numRowsAffected() != rows || lastId < rows) {
+                qCritical() << "[DatabaseManager] insertRows: wrote" << q->numRowsAffected() << "of" << rows
+                            << "rows, their ids are unknown";
+                return false;
+            }
+            rowIds->resize(rowIds->size() + rows);
+            std::iota(rowIds->end() - rows, rowIds->end(), lastId - rows + 1);
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::resolveNames(NameDictionary &dictionary, const QString &table, const QStringList &names)
+{
+    if (!loadNames(dictionary, table))
+        return false;
+
+    QSet<QString> seen;
+    QVariantList missing;
+    for (const QString &name : names) {
+        if (dictionary.id(name) == 0 && !seen.contains(name)) {
+            seen.insert(name);
+            missing.append(name);
+        }
+    }
+    if (missing.isEmpty())
+        return true;
+
+    // The multi-row insert does not report the new ids, so read back just these names
+    // (also the ones another connection inserted since the dictionary was loaded)
+    if (!insertRows(QString("INSERT OR IGNORE INTO %1 (name)").arg(table), 1, missing))
+        return false;
+
+    for (qsizetype first = 0; first < missing.size(); first += kMaxBindValues) {
+        const qsizetype count = qMin<qsizetype>(kMaxBindValues, missing.size() - first);
+        StatementCache::Handle q = cachedQuery(QString("SELECT id, name FROM %1 WHERE name IN (%2)")
+                                                   .arg(table, QStringList(count, QStringLiteral("?")).join(", ")));
+        for (qsizetype i = first; i < first + count; ++i) {
+            q->addBindValue(missing.at(i));
+        }
+
+        if (!q->exec()) {
+            qCritical() << "[DatabaseManager] resolveNames" << table << "error: " << q->lastError().text();
+            qDebug() << "[DatabaseManager] resolveNames fullquery: " << q->executedQuery();
+            return false;
+        }
+        while (q->next()) {
+            dictionary.insert(q->value(1).toString(), q->value(0).toInt());
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Retrieves all file hashes from the media_files table.
+ *
+ * Executes a SQL query to fetch all file_hash values from the database.
+ * The stored integers are the sampled hashes (FileHash::sample) bit for bit.
+ *
+ * @return QSet<quint64> A set containing all unique file hashes from the database.
+ *                       Returns an empty set if the query fails or no hashes exist.
+ *
+ * @note If the database query fails, a warning message is logged via qWarning().
+ * @see QSqlQuery, QSet
+ */
+QSet<quint64> DatabaseManager::getAllFileHashes()
+{
+    QSet<quint64> hashSet;
+    QSqlDatabase db = connection();
+
+    if(!db.isOpen()) return hashSet;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT file_hash FROM media_files WHERE file_hash IS NOT NULL");
+
+    if (!query.exec()) {
+        qCritical() << "[DatabaseManager] getAllFileHashes - Error fetching hashes:"
+                    << query.lastError().text();
+        qDebug() << "[DatabaseManager] getAllFileHashes - Error fetching hashes, fullquery: "
+                 << query.executedQuery();
+        return hashSet;
+    }
+
+    while (query.next()) {
+        hashSet.insert(FileHash::fromDatabase(query.value(0)));
+    }
+
+    return hashSet;
+}
+
+bool DatabaseManager::updateFileHash(int songId, quint64 fileHash) {
+    StatementCache::Handle q = cachedQuery("UPDATE media_files SET file_hash = ? WHERE song_id = ?");
+    q->addBindValue(FileHash::toDatabase(fileHash));
+    q->addBindValue(songId);
+
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] updateFileHash failed:" << q->lastError().text();
+        return false;
+    }
+    return true;
+
+    return false;
+}
+
+/**
+ * @brief Converts the hash columns of databases from older versions from TEXT to INTEGER.
+ *
+ * Older versions stored hashes as 16 hex digits. media_files is rebuilt (SQLite cannot
+ * change a column type): the old table is renamed, createInitialTables() creates the
+ * new one and the rows are copied with their hashes converted; hashes that cannot be
+ * converted become NULL. The scan cache only holds hashes that can be computed again,
+ * so it is simply dropped and created anew.
+ *
+ * Does nothing if the columns are already INTEGER. Schema step 2; runs inside the
+ * transaction of the step.
+ *
+ * @return true if the columns are INTEGER now, false otherwise.
+ */
+bool DatabaseManager::migrateFileHashColumns()
+{
+    QSqlDatabase db = connection();
+
+    const auto hashColumnType = [&db](const QString &table) {
+        QSqlQuery info(db);
+        if (info.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+            while (info.next()) {
+                if (info.value("name").toString() == "file_hash") {
+                    return info.value("type").toString().toUpper();
+                }
+            }
+        }
+        return QString();
+    };
+
+    const bool rebuildMediaFiles = hashColumnType("media_files") == "TEXT";
+    const bool rebuildScanCache = hashColumnType("scan_cache") == "TEXT";
+    if (!rebuildMediaFiles && !rebuildScanCache) return true;
+
+    QSqlQuery q(db);
+    const auto run = [&](const QString &sql) {
+        if (q.exec(sql)) return true;
+        qCritical() << "[DatabaseManager] migrateFileHashColumns error: " << q.lastError().text();
+        qDebug() << "[DatabaseManager] migrateFileHashColumns fullquery: " << q.executedQuery();
+        return false;
+    };
+
+    if (rebuildScanCache && !run("DROP TABLE scan_cache")) {
+        return false;
+    }
+
+    if (rebuildMediaFiles) {
+        // The index moves with the renamed table and would block CREATE INDEX IF NOT EXISTS
+        if (!run("DROP INDEX IF EXISTS idx_filepath") ||
+            !run("ALTER TABLE media_files RENAME TO media_files_text")) {
+            return false;
+        }
+    }
+
+    if (!createInitialTables()) {
+        return false;
+    }
+
+    if (rebuildMediaFiles) {
+        QSqlQuery select(db);
+        select.setForwardOnly(true);
+        if (!select.exec("SELECT id, song_id, file_path, is_managed, file_type, file_size, file_hash, "
+                         "can_be_practiced FROM media_files_text")) {
+            qCritical() << "[DatabaseManager] migrateFileHashColumns select error: " << select.lastError().text();
+            return false;
+        }
+
+        QSqlQuery insert(db);
+        insert.prepare("INSERT OR IGNORE INTO media_files (id, song_id, file_path, is_managed, file_type, "
+                       "file_size, file_hash, can_be_practiced) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+
+        while (select.next()) {
+            bool ok = false;
+            const quint64 hash = select.value(6).toString().trimmed().toULongLong(&ok, 16);
+
+            for (int column = 0; column < 8; ++column) {
+                insert.addBindValue(column == 6 ? (ok && hash != 0 ? QVariant(FileHash::toDatabase(hash)) : QVariant())
+                                                : select.value(column));
+            }
+            if (!insert.exec()) {
+                qCritical() << "[DatabaseManager] migrateFileHashColumns insert error: " << insert.lastError().text();
+                qDebug() << "[DatabaseManager] migrateFileHashColumns fullquery: " << insert.executedQuery();
+                return false;
+            }
+        }
+
+        if (!run("DROP TABLE media_files_text")) {
+            return false;
+        }
+    }
+
+    qDebug() << "[DatabaseManager] hash columns converted to INTEGER";
+    return true;
+}
+
+/**
+ * @brief Drops all stored hashes after a change of the hash algorithm (SampleHash).
+ *
+ * Hashes of different algorithms cannot be compared, so an old hash would only miss
+ * its file in the next import. Setting them to NULL is a single statement, so opening
+ * the database stays fast; rehashMediaFiles() fills them in later, in the background.
+ * A NULL hash never matches, it only means "not known". The scan cache is cleared as
+ * it holds hashes of the old algorithm as well. The algorithm in use is remembered in
+ * the setting "hash_algorithm".
+ *
+ * @return true if the hashes were dropped and the setting was written,
+ *         false otherwise (the transaction is rolled back).
+ */
+bool DatabaseManager::resetFileHashes()
+{
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qCritical() << "[DatabaseManager] resetFileHashes Could not start transaction:"
+                    << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db);
+    for (const QString &sql : {QString("UPDATE media_files SET file_hash = NULL WHERE file_hash IS NOT NULL"),
+                               QString("DELETE FROM scan_cache")}) {
+        if (!q.exec(sql)) {
+            qCritical() << "[DatabaseManager] resetFileHashes error: " << q.lastError().text();
+            qDebug() << "[DatabaseManager] resetFileHashes fullquery: " << q.executedQuery();
+            rollback();
+            return false;
+        }
+    }
+
+    if (!setSetting("hash_algorithm", SampleHash::kAlgorithmName)) {
+        rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+/**
+ * @brief Hashes the media files whose hash is NULL with SampleHash.
+ *
+ * The files of a chunk are hashed first and written in one short transaction
+ * afterwards, so the write lock is not held while the disk is read, and a stop keeps
+ * the chunks already written. Files that are missing, unreadable or empty, and files
+ * with the same content as another media file (file_hash is UNIQUE), stay NULL and
+ * are logged; they are tried again on the next call.
+ *
+ * @return false on database errors.
+ */
+bool DatabaseManager::rehashMediaFiles(const std::function<bool (int done, int total)> &progress, int *unhashed)
+{
+    struct Pending {
+        int id{0};
+        QString path;
+    };
+
+    const QString managedPath = getManagedPath();
+    QList<Pending> pending;
+    {
+        QSqlQuery select(connection());
+        select.setForwardOnly(true);
+        if (!select.exec("SELECT id, file_path, is_managed FROM media_files WHERE file_hash IS NULL ORDER BY id")) {
+            qCritical() << "[DatabaseManager] rehashMediaFiles select error: " << select.lastError().text();
+            qDebug() << "[DatabaseManager] rehashMediaFiles fullquery: " << select.executedQuery();
+            return false;
+        }
+        while (select.next()) {
+            const QString storedPath = select.value(1).toString();
+            pending.append({select.value(0).toInt(),
+                            select.value(2).toBool() ? QDir::cleanPath(managedPath + "/" + storedPath) : storedPath});
         }
-        return q.lastInsertId().toInt();
     }
+
+    const int total = int(pending.size());
+    int failed = 0;
+    int done = 0;
+    bool stopped = progress && !progress(0, total);
+
+    while (!stopped && done < total) {
+        const int end = qMin(done + kRehashChunk, total);
+
+        QList<std::pair<int, quint64>> hashes; // Media file id, hash
+        hashes.reserve(end - done);
+        for (int i = done; i < end; ++i) {
+            bool ok = false;
+            const quint64 hash = SampleHash::calculate(pending.at(i).path, &ok);
+            if (!ok || hash == SampleHash::kEmptyFileHash) {
+                qWarning() << "[DatabaseManager] rehashMediaFiles: no hash for" << pending.at(i).path
+                           << (ok ? "(empty)" : "(missing or unreadable)");
+                failed++;
+                continue;
+            }
+            hashes.append({pending.at(i).id, hash});
+        }
+
+        QSqlDatabase db = connection();
+        if (!db.transaction()) {
+            qCritical() << "[DatabaseManager] rehashMediaFiles Could not start transaction:"
+                        << db.lastError().text();
+            return false;
+        }
+
+        for (const auto &[id, hash] : std::as_const(hashes)) {
+            StatementCache::Handle q = cachedQuery("UPDATE OR IGNORE media_files SET file_hash = ? WHERE id = ?");
+            q->addBindValue(FileHash::toDatabase(hash));
+            q->addBindValue(id);
+            if (!q->exec()) {
+                qCritical() << "[DatabaseManager] rehashMediaFiles update error: " << q->lastError().text();
+                qDebug() << "[DatabaseManager] rehashMediaFiles fullquery: " << q->executedQuery();
+                rollback();
+                return false;
+            }
+            if (q->numRowsAffected() == 0) {
+                qWarning() << "[DatabaseManager] rehashMediaFiles: media file" << id
+                           << "has the same content as another one, it keeps no hash";
+                failed++;
+            }
+        }
+
+        if (!db.commit()) {
+            qCritical() << "[DatabaseManager] rehashMediaFiles commit error: " << db.lastError().text();
+            rollback();
+            return false;
+        }
+
+        done = end;
+        stopped = progress && !progress(done, total);
+    }
+
+    const int rehashed = done - failed;
+    failed += total - done; // Not reached before the stop
+    if (unhashed) *unhashed = failed;
+    qDebug() << "[DatabaseManager] re-hashed" << rehashed << "of" << total
+             << "media files with" << SampleHash::kAlgorithmName;
+    return true;
+}
+
+/**
+ * @brief Runs rehashMediaFiles() on the writer.
+ *
+ * Progress range and value of the future are the files done and the files to do; a
+ * QFutureWatcher hands them to the GUI thread. Canceling the future stops after the
+ * current chunk. The result (none on database errors) is the number of files still
+ * without hash.
+ */
+QFuture<int> DatabaseManager::rehashMediaFilesAsync()
+{
+    return worker_m.stream<int>([this](QPromise<int> &promise) {
+        int unhashed = 0;
+        const bool rehashed = rehashMediaFiles([&promise](int done, int total) {
+            promise.setProgressRange(0, total);
+            promise.setProgressValue(done);
+            return !promise.isCanceled();
+        }, &unhashed);
+
+        if (rehashed) {
+            promise.addResult(unhashed);
+        }
+    });
+}
+
+/**
+ * @brief Loads the complete scan cache.
+ *
+ * The result is handed to FileScanner::setScanCache() before a scan, so files
+ * whose size, modification time and inode did not change are not read again.
+ *
+ * @return ScanCache Entries keyed by absolute file path. Empty if the database
+ *         is not open (e.g. during the first setup) or the query fails.
+ */
+ScanCache DatabaseManager::loadScanCache()
+{
+    ScanCache cache;
+    QSqlDatabase db = connection();
+
+    if (!db.isOpen()) return cache;
+
+    QSqlQuery q(db);
+    q.setForwardOnly(true);
+    if (!q.exec("SELECT file_path, file_size, mtime, inode, file_hash FROM scan_cache")) {
+        qCritical() << "[DatabaseManager] loadScanCache error: " << q.lastError().text();
+        qDebug() << "[DatabaseManager] loadScanCache fullquery: " << q.executedQuery();
+        return cache;
+    }
+
+    while (q.next()) {
+        ScanCacheEntry entry;
+        entry.size = q.value(1).toLongLong();
+        entry.mtime = q.value(2).toLongLong();
+        entry.inode = q.value(3).toULongLong();
+        entry.hash = FileHash::fromDatabase(q.value(4));
+        cache.insert(q.value(0).toString(), entry);
+    }
+
+    return cache;
 }
 
 /**
- * @brief Retrieves or creates a tuning record in the database.
- *
- * Searches the tunings table for a record with the given name. If found,
- * returns its ID. If not found, creates a new tuning record with the provided
- * name and returns the ID of the newly inserted record.
- *
- * @param name The name of the tuning to search for or create. Whitespace is
- *             trimmed before the operation.
+ * @brief Inserts or replaces scan cache entries in one transaction.
  *
- * @return The ID of the existing or newly created tuning record.
+ * @param entries Entries reported by FileScanner::scanCacheUpdated().
  *
- * @note The name parameter is trimmed of leading and trailing whitespace
- *       before being used in database operations.
+ * @return true if all entries were written, false otherwise (nothing is written then).
  */
-int DatabaseManager::getOrCreateTuning(const QString &name)
+bool DatabaseManager::storeScanCache(const ScanCache &entries)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    if (entries.isEmpty()) return true;
+
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qCritical() << "[DatabaseManager] storeScanCache Could not start transaction:"
+                    << db.lastError().text();
+        return false;
+    }
+
     QSqlQuery q(db);
-    q.prepare("SELECT id FROM tunings WHERE name = ?");
-    q.addBindValue(name.trimmed());
+    q.prepare("INSERT OR REPLACE INTO scan_cache (file_path, file_size, mtime, inode, file_hash) "
+              "VALUES (?, ?, ?, ?, ?)");
+
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        q.addBindValue(it.key());
+        q.addBindValue(it.value().size);
+        q.addBindValue(it.value().mtime);
+        q.addBindValue(static_cast<qint64>(it.value().inode));
+        q.addBindValue(FileHash::toDatabase(it.value().hash));
 
-    if (q.exec() && q.next()) {
-        return q.value(0).toInt();
-    } else {
-        q.prepare("INSERT INTO tunings (name) VALUES (?)");
-        q.addBindValue(name.trimmed());
         if (!q.exec()) {
-            qCritical() << "[DatabaseManager] getOrCreateTuning, error: " << q.lastError().text();
-            qDebug() << "[DatabaseManager] getOrCreateTuning, fullquery: " << q.executedQuery();
+            qCritical() << "[DatabaseManager] storeScanCache error: " << q.lastError().text();
+            qDebug() << "[DatabaseManager] storeScanCache fullquery: " << q.executedQuery();
+            db.rollback();
+            return false;
         }
-        return q.lastInsertId().toInt();
     }
+
+    return db.commit();
 }
 
+// =============================================================================
+// --- Import journal
+// =============================================================================
+
 /**
- * @brief Retrieves all file hashes from the media_files table.
- *
- * Executes a SQL query to fetch all file_hash values from the database.
- * Each hash is trimmed of whitespace, converted to uppercase, and added
- * to the result set if non-empty.
+ * @brief Records a new import with all its tasks as pending.
  *
- * @return QSet<QString> A set containing all unique file hashes from the database.
- *                       Returns an empty set if the query fails or no hashes exist.
+ * Runs in its own transaction and commits at once, so the job survives a crash of the
+ * import that follows.
  *
- * @note If the database query fails, a warning message is logged via qWarning().
- * @see QSqlQuery, QSet
+ * @return The id of the job, 0 on error.
  */
-QSet<QString> DatabaseManager::getAllFileHashes()
+qlonglong DatabaseManager::createImportJob(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved)
 {
-    QSet<QString> hashSet;
-    QSqlDatabase db = QSqlDatabase::database();
-
-    if(!db.isOpen()) return hashSet;
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qCritical() << "[DatabaseManager] createImportJob Could not start transaction:"
+                    << db.lastError().text();
+        return 0;
+    }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT file_hash FROM media_files");
+    QSqlQuery q(db);
+    q.prepare("INSERT INTO import_jobs (base_path, is_managed, is_moved) VALUES (?, ?, ?)");
+    q.addBindValue(basePath);
+    q.addBindValue(isManaged ? 1 : 0);
+    q.addBindValue(isMoved ? 1 : 0);
+    if (!q.exec()) {
+        qCritical() << "[DatabaseManager] createImportJob error: " << q.lastError().text();
+        qDebug() << "[DatabaseManager] createImportJob fullquery: " << q.executedQuery();
+        db.rollback();
+        return 0;
+    }
+    const qlonglong jobId = q.lastInsertId().toLongLong();
 
-    if (!query.exec()) {
-        qCritical() << "[DatabaseManager] getAllFileHashes - Error fetching hashes:"
-                    << query.lastError().text();
-        qDebug() << "[DatabaseManager] getAllFileHashes - Error fetching hashes, fullquery: "
-                 << query.executedQuery();
-        return hashSet;
+    QVariantList values;
+    values.reserve(tasks.size() * 10);
+    for (qsizetype i = 0; i < tasks.size(); ++i) {
+        const ImportTask &task = tasks.at(i);
+        values << jobId << i << task.sourcePath << task.relativePath << task.itemName << task.fileSize
+               << task.fileSuffix << task.categoryPath
+               << (task.fileHash.isValid() ? QVariant(FileHash::toDatabase(task.fileHash.sample)) : QVariant())
+               << (task.fileHash.isVerified() ? QVariant(FileHash::toDatabase(task.fileHash.full)) : QVariant());
     }
 
-    while (query.next()) {
-        QString h = query.value(0).toString().trimmed().toUpper();
-        if (!h.isEmpty()) {
-            hashSet.insert(h);
-        }
+    if (!insertRows("INSERT INTO import_journal (job_id, task_index, source_path, relative_path, item_name, "
+                    "file_size, file_suffix, category_path, file_hash, full_hash)",
+                    10, values)
+        || !db.commit()) {
+        db.rollback();
+        return 0;
     }
+    return jobId;
+}
 
-    return hashSet;
+/**
+ * @brief The oldest import that did not finish, e.g. because the application crashed.
+ * @return Its id, 0 if there is none.
+ */
+qlonglong DatabaseManager::unfinishedImportJob()
+{
+    QSqlQuery q(connection());
+    if (!q.exec("SELECT MIN(id) FROM import_jobs") || !q.next()) {
+        qCritical() << "[DatabaseManager] unfinishedImportJob error: " << q.lastError().text();
+        return 0;
+    }
+    return q.value(0).toLongLong(); // NULL without jobs
 }
 
-bool DatabaseManager::updateFileHash(int songId, const QString &fileHash) {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
+/**
+ * @brief Reads a job with all its tasks and their journal entries.
+ * @return std::nullopt if the job does not exist or cannot be read.
+ */
+std::optional<ImportJob> DatabaseManager::loadImportJob(qlonglong jobId)
+{
+    QSqlQuery q(connection());
+    q.prepare("SELECT base_path, is_managed, is_moved FROM import_jobs WHERE id = ?");
+    q.addBindValue(jobId);
+    if (!q.exec()) {
+        qCritical() << "[DatabaseManager] loadImportJob error: " << q.lastError().text();
+        qDebug() << "[DatabaseManager] loadImportJob fullquery: " << q.executedQuery();
+        return std::nullopt;
+    }
+    if (!q.next())
+        return std::nullopt;
+
+    ImportJob job;
+    job.id = jobId;
+    job.basePath = q.value(0).toString();
+    job.isManaged = q.value(1).toBool();
+    job.isMoved = q.value(2).toBool();
+
+    q.setForwardOnly(true);
+    q.prepare("SELECT task_index, source_path, relative_path, item_name, file_size, file_suffix, category_path, "
+              "file_hash, full_hash, state, target_path, file_operation, song_id "
+              "FROM import_journal WHERE job_id = ? ORDER BY task_index");
+    q.addBindValue(jobId);
+    if (!q.exec()) {
+        qCritical() << "[DatabaseManager] loadImportJob error: " << q.lastError().text();
+        qDebug() << "[DatabaseManager] loadImportJob fullquery: " << q.executedQuery();
+        return std::nullopt;
+    }
 
-    q.prepare("UPDATE media_files SET file_hash = ? WHERE song_id = ?");
-    q.addBindValue(fileHash);
-    q.addBindValue(songId);
+    while (q.next()) {
+        ImportTask task;
+        task.sourcePath = q.value(1).toString();
+        task.relativePath = q.value(2).toString();
+        task.itemName = q.value(3).toString();
+        task.fileSize = q.value(4).toLongLong();
+        task.fileSuffix = q.value(5).toString();
+        task.categoryPath = q.value(6).toString();
+        task.fileHash = FileHash{FileHash::fromDatabase(q.value(7)), FileHash::fromDatabase(q.value(8))};
+
+        ImportJournalEntry entry;
+        entry.task = job.tasks.size(); // task_index counts from 0 without gaps
+        entry.state = static_cast<ImportState>(q.value(9).toInt());
+        entry.targetPath = q.value(10).toString();
+        entry.operation = static_cast<ImportFileOperation>(q.value(11).toInt());
+        entry.songId = q.value(12).toLongLong();
+
+        job.tasks.append(task);
+        job.entries.append(entry);
+    }
+    return job;
+}
 
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] updateFileHash failed:" << q.lastError().text();
-        return false;
+/**
+ * @brief Stores the progress of a job; entries only ever move forward.
+ *
+ * The state never goes back, and an empty target path, ImportFileOperation::None or
+ * song id 0 keep the stored value.
+ *
+ * @note Run it in the transaction of the rows it describes (ImportProcessor commits both
+ *       together at every checkpoint).
+ */
+bool DatabaseManager::updateImportJournal(qlonglong jobId, const QList<ImportJournalEntry> &entries)
+{
+    for (const ImportJournalEntry &entry : entries) {
+        StatementCache::Handle q = cachedQuery(
+            "UPDATE import_journal SET state = MAX(state, ?), target_path = COALESCE(?, target_path), "
+            "file_operation = COALESCE(?, file_operation), song_id = COALESCE(?, song_id) "
+            "WHERE job_id = ? AND task_index = ?");
+        q->addBindValue(static_cast<int>(entry.state));
+        q->addBindValue(entry.targetPath.isEmpty() ? QVariant() : QVariant(entry.targetPath));
+        q->addBindValue(entry.operation == ImportFileOperation::None ? QVariant() : QVariant(static_cast<int>(entry.operation)));
+        q->addBindValue(entry.songId != 0 ? QVariant(entry.songId) : QVariant());
+        q->addBindValue(jobId);
+        q->addBindValue(entry.task);
+
+        if (!q->exec()) {
+            qCritical() << "[DatabaseManager] updateImportJournal error: " << q->lastError().text();
+            qDebug() << "[DatabaseManager] updateImportJournal fullquery: " << q->executedQuery();
+            return false;
+        }
     }
     return true;
+}
 
-    return false;
+/**
+ * @brief Removes a job and its journal.
+ *
+ * @param withSongs Also deletes the songs the job committed and their media files
+ *                  (a discarded import); false when the import finished.
+ *
+ * @note Run it inside a transaction; the file operations are undone by ImportProcessor.
+ */
+bool DatabaseManager::removeImportJob(qlonglong jobId, bool withSongs)
+{
+    QStringList statements;
+    if (withSongs) {
+        statements << "DELETE FROM media_files WHERE song_id IN "
+                      "(SELECT song_id FROM import_journal WHERE job_id = ? AND song_id IS NOT NULL)"
+                   << "DELETE FROM songs WHERE id IN "
+                      "(SELECT song_id FROM import_journal WHERE job_id = ? AND song_id IS NOT NULL)";
+    }
+    statements << "DELETE FROM import_journal WHERE job_id = ?"
+               << "DELETE FROM import_jobs WHERE id = ?";
+
+    QSqlQuery q(connection());
+    for (const QString &statement : std::as_const(statements)) {
+        q.prepare(statement);
+        q.addBindValue(jobId);
+        if (!q.exec()) {
+            qCritical() << "[DatabaseManager] removeImportJob error: " << q.lastError().text();
+            qDebug() << "[DatabaseManager] removeImportJob fullquery: " << q.executedQuery();
+            return false;
+        }
+    }
+    return true;
 }
 
 // =============================================================================
@@ -739,15 +1799,12 @@ bool DatabaseManager::addFileRelation(int idA, int idB)
     if (idA == idB)
         return false;
 
-    QSqlDatabase db = QSqlDatabase::database();
-
-    QSqlQuery q(db);
-    q.prepare("INSERT OR IGNORE INTO file_relations (file_id_a, file_id_b) VALUES (?, ?)");
-    q.addBindValue(qMin(idA, idB)); // Sorting prevents duplicate pairs (1,2 and 2,1)
-    q.addBindValue(qMax(idA, idB));
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] update addFileRelation failed:" << q.lastError().text();
-        qDebug() << "[DatabaseManager] update addFileRelation fullquery: " << q.executedQuery();
+    StatementCache::Handle q = cachedQuery("INSERT OR IGNORE INTO file_relations (file_id_a, file_id_b) VALUES (?, ?)");
+    q->addBindValue(qMin(idA, idB)); // Sorting prevents duplicate pairs (1,2 and 2,1)
+    q->addBindValue(qMax(idA, idB));
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] update addFileRelation failed:" << q->lastError().text();
+        qDebug() << "[DatabaseManager] update addFileRelation fullquery: " << q->executedQuery();
         return false;
     }
     return true;
@@ -755,16 +1812,13 @@ bool DatabaseManager::addFileRelation(int idA, int idB)
 
 bool DatabaseManager::updateFilePath(int songId, const QString &newPath)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
     // Wichtig: Da songId in media_files der FK ist, nutzen wir diesen oder die ID
-    q.prepare("UPDATE media_files SET file_path = ? WHERE song_id = ?");
-    q.addBindValue(newPath);
-    q.addBindValue(songId);
+    StatementCache::Handle q = cachedQuery("UPDATE media_files SET file_path = ? WHERE song_id = ?");
+    q->addBindValue(newPath);
+    q->addBindValue(songId);
 
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] updateFilePath failed:" << q.lastError().text();
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] updateFilePath failed:" << q->lastError().text();
         return false;
     }
     return true;
@@ -788,7 +1842,7 @@ bool DatabaseManager::updateFilePath(int songId, const QString &newPath)
  */
 bool DatabaseManager::removeRelation(int fileIdA, int fileIdB)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
 
     QSqlQuery query(db);
 
@@ -824,7 +1878,7 @@ bool DatabaseManager::removeRelation(int fileIdA, int fileIdB)
  */
 bool DatabaseManager::deleteFileRecord(int songId)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
 
     q.prepare("DELETE FROM songs WHERE id = ?");
@@ -863,25 +1917,22 @@ QList<DatabaseManager::RelatedFile> DatabaseManager::getFilesByRelation(int song
 {
     QList<RelatedFile> list;
 
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
-    q.prepare("SELECT mf.id, mf.file_path, mf.file_type "
-              "FROM media_files mf "
-              "JOIN file_relations fr ON (mf.id = fr.file_id_b AND fr.file_id_a = ?) "
-              "OR (mf.id = fr.file_id_a AND fr.file_id_b = ?)");
-    q.addBindValue(songId);
-    q.addBindValue(songId);
+    StatementCache::Handle q = cachedQuery("SELECT mf.id, mf.file_path, mf.file_type "
+                                           "FROM media_files mf "
+                                           "JOIN file_relations fr ON (mf.id = fr.file_id_b AND fr.file_id_a = ?) "
+                                           "OR (mf.id = fr.file_id_a AND fr.file_id_b = ?)");
+    q->addBindValue(songId);
+    q->addBindValue(songId);
 
-    bool isManaged = getSetting("is_managed", QString("false")) == "true";
+    bool isManaged = setting<bool>("is_managed");
 
-    if (q.exec()) {
-        while (q.next()) {
+    if (q->exec()) {
+        while (q->next()) {
             RelatedFile rf;
-            rf.id = q.value("id").toInt();
-            rf.fileName = QFileInfo(q.value("file_path").toString()).fileName();
-            rf.type = q.value("file_type").toString();
-            QString relpath = QFileInfo(q.value("file_path").toString()).filePath();
+            rf.id = q->value("id").toInt();
+            rf.fileName = QFileInfo(q->value("file_path").toString()).fileName();
+            rf.type = q->value("file_type").toString();
+            QString relpath = QFileInfo(q->value("file_path").toString()).filePath();
             // qDebug() << "isManaged: " << isManaged << " with managed Path: " << getManagedPath();
             if(isManaged) {
                 rf.absolutePath = QDir::cleanPath(getManagedPath() + "/" + relpath);
@@ -892,8 +1943,8 @@ QList<DatabaseManager::RelatedFile> DatabaseManager::getFilesByRelation(int song
             list.append(rf);
         }
     } else {
-        qCritical() << "[DatabaseManager] getFilesBySongId Error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getFilesBySongId fullquery: " << q.executedQuery();
+        qCritical() << "[DatabaseManager] getFilesBySongId Error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] getFilesBySongId fullquery: " << q->executedQuery();
     }
     return list;
 }
@@ -929,47 +1980,47 @@ bool DatabaseManager::saveTableSessions(int songId,
                                         QDate date,
                                         const QList<PracticeSession> &sessions)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     if (!db.transaction()) {
         qCritical() << "[DatabaseManager] saveTableSessions Could not start transaction:"
                     << db.lastError().text();
         return false;
     }
 
-    QSqlQuery q(db);
     QString dateStr = date.toString("yyyy-MM-dd");
 
     // INSERT now the note_text or make insert or update the practice_journal
-
-    q.prepare("DELETE FROM practice_journal WHERE song_id = :sId AND practice_date = :pDate");
-    q.bindValue(":sId", songId);
-    q.bindValue(":pDate", dateStr);
-
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] saveTableSessions Delete Error saveTableSessions:"
-                    << q.lastError().text();
-        db.rollback();
-        return false;
+    {
+        StatementCache::Handle remove = cachedQuery("DELETE FROM practice_journal WHERE song_id = :sId AND practice_date = :pDate");
+        remove->bindValue(":sId", songId);
+        remove->bindValue(":pDate", dateStr);
+
+        if (!remove->exec()) {
+            qCritical() << "[DatabaseManager] saveTableSessions Delete Error saveTableSessions:"
+                        << remove->lastError().text();
+            db.rollback();
+            return false;
+        }
     }
 
-    q.prepare("INSERT INTO practice_journal (song_id, practice_date, start_bar, end_bar, "
-              "practiced_bpm, total_reps, successful_streaks) "
-              "VALUES (:songId, :date, :start, :end, :bpm, :reps, :streaks)");
+    StatementCache::Handle q = cachedQuery("INSERT INTO practice_journal (song_id, practice_date, start_bar, end_bar, "
+                                           "practiced_bpm, total_reps, successful_streaks) "
+                                           "VALUES (:songId, :date, :start, :end, :bpm, :reps, :streaks)");
 
     for (const auto &s : sessions) {
-        q.bindValue(":songId", songId);
-        q.bindValue(":date", dateStr);
-        q.bindValue(":start", s.startBar);
-        q.bindValue(":end", s.endBar);
-        q.bindValue(":bpm", s.bpm);
-        q.bindValue(":reps", s.reps);
-        q.bindValue(":streaks", s.streaks);
-
-        if (!q.exec()) {
+        q->bindValue(":songId", songId);
+        q->bindValue(":date", dateStr);
+        q->bindValue(":start", s.startBar);
+        q->bindValue(":end", s.endBar);
+        q->bindValue(":bpm", s.bpm);
+        q->bindValue(":reps", s.reps);
+        q->bindValue(":streaks", s.streaks);
+
+        if (!q->exec()) {
             qCritical() << "[DatabaseManager] saveTableSessions insert Error: "
-                        << q.lastError().text();
+                        << q->lastError().text();
             qDebug() << "[DatabaseManager] saveTableSessions insert fullquery: "
-                     << q.executedQuery();
+                     << q->executedQuery();
             db.rollback();
             return false;
         }
@@ -1005,29 +2056,27 @@ QList<PracticeSession> DatabaseManager::getSessionsForDay(int songId, QDate date
 {
     QList<PracticeSession> sessions;
 
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
-    q.prepare(
+    StatementCache::Handle q = cachedQuery(
         "SELECT practice_date, start_bar, end_bar, practiced_bpm, total_reps, successful_streaks "
         "FROM practice_journal "
-        "WHERE song_id = ? AND DATE(practice_date) = ? "
+        "WHERE song_id = ? AND practice_date >= ? AND practice_date < ? "
         "AND start_bar IS NOT NULL"); // Only entries with table data
-    q.addBindValue(songId);
-    q.addBindValue(date.toString("yyyy-MM-dd"));
-
-    if (q.exec()) {
-        while (q.next()) {
-            sessions.append({q.value(0).toDate(),
-                             q.value(1).toInt(),
-                             q.value(2).toInt(),
-                             q.value(3).toInt(),
-                             q.value(4).toInt(),
-                             q.value(5).toInt()});
+    q->addBindValue(songId);
+    q->addBindValue(dayBegin(date));
+    q->addBindValue(dayEnd(date));
+
+    if (q->exec()) {
+        while (q->next()) {
+            sessions.append({q->value(0).toDate(),
+                             q->value(1).toInt(),
+                             q->value(2).toInt(),
+                             q->value(3).toInt(),
+                             q->value(4).toInt(),
+                             q->value(5).toInt()});
         }
     } else {
-        qCritical() << "[DatabaseManager] getSessionsForDay error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getSessionsForDay fullquery: " << q.executedQuery();
+        qCritical() << "[DatabaseManager] getSessionsForDay error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] getSessionsForDay fullquery: " << q->executedQuery();
     }
     return sessions;
 }
@@ -1053,7 +2102,7 @@ QList<PracticeSession> DatabaseManager::getLastSessions(int songId, int limit)
 {
     QList<PracticeSession> sessions;
 
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
 
     // Sort by date and ID in descending order to get the very latest entries.
@@ -1120,34 +2169,42 @@ QList<PracticeSession> DatabaseManager::getLastSessions(int songId, int limit)
  */
 bool DatabaseManager::updateSongNotes(int songId, const QString &notes, QDate date)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
     QString dateStr = date.toString("yyyy-MM-dd");
 
     // Check if an entry already exists for this song on this day.
-    q.prepare("SELECT id FROM practice_journal WHERE song_id = ? AND DATE(practice_date) = ?");
-    q.addBindValue(songId);
-    q.addBindValue(dateStr);
+    int entryId = 0;
+    {
+        StatementCache::Handle select = cachedQuery("SELECT id FROM practice_journal "
+                                                    "WHERE song_id = ? AND practice_date >= ? AND practice_date < ?");
+        select->addBindValue(songId);
+        select->addBindValue(dayBegin(date));
+        select->addBindValue(dayEnd(date));
+        if (select->exec() && select->next()) {
+            entryId = select->value(0).toInt();
+        }
+    }
 
-    if (q.exec() && q.next()) {
+    if (entryId != 0) {
         // Update existing entry
-        int entryId = q.value(0).toInt();
-        q.prepare("UPDATE practice_journal SET note_text = ? WHERE id = ?");
-        q.addBindValue(notes);
-        q.addBindValue(entryId);
-    } else {
-        // Create a new entry for this day
-        q.prepare(
-            "INSERT INTO practice_journal (song_id, note_text, practice_date) VALUES (?, ?, ?)");
-        q.addBindValue(songId);
-        q.addBindValue(notes);
-        q.addBindValue(dateStr);
+        StatementCache::Handle q = cachedQuery("UPDATE practice_journal SET note_text = ? WHERE id = ?");
+        q->addBindValue(notes);
+        q->addBindValue(entryId);
+        if (q->exec()) return true;
+
+        qCritical() << "[DatabaseManager] updateSongNotes error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] updateSongNotes fullquery: " << q->executedQuery();
+        return false;
     }
 
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] updateSongNotes error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] updateSongNotes fullquery: " << q.executedQuery();
+    // Create a new entry for this day
+    StatementCache::Handle q = cachedQuery("INSERT INTO practice_journal (song_id, note_text, practice_date) VALUES (?, ?, ?)");
+    q->addBindValue(songId);
+    q->addBindValue(notes);
+    q->addBindValue(dateStr);
+
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] updateSongNotes error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] updateSongNotes fullquery: " << q->executedQuery();
         return false;
     }
 
@@ -1168,28 +2225,25 @@ bool DatabaseManager::updateSongNotes(int songId, const QString &notes, QDate da
  */
 QString DatabaseManager::getNoteForDay(int songId, QDate date)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
     // Convert date to ISO format yyyy-MM-dd
     QString dateStr = date.toString("yyyy-MM-dd");
 
-    q.prepare("SELECT note_text, practice_date FROM practice_journal "
-              "WHERE song_id = ? "
-              "AND note_text IS NOT NULL "
-              "AND note_text != '' "
-              "AND practice_date <= ? "
-              "ORDER BY practice_date DESC "
-              "LIMIT 1;");
-    q.addBindValue(songId);
-    q.addBindValue(dateStr);
-
-    if (q.exec() && q.next()) {
-        return q.value(0).toString();
+    StatementCache::Handle q = cachedQuery("SELECT note_text, practice_date FROM practice_journal "
+                                           "WHERE song_id = ? "
+                                           "AND note_text IS NOT NULL "
+                                           "AND note_text != '' "
+                                           "AND practice_date <= ? "
+                                           "ORDER BY practice_date DESC "
+                                           "LIMIT 1;");
+    q->addBindValue(songId);
+    q->addBindValue(dateStr);
+
+    if (q->exec() && q->next()) {
+        return q->value(0).toString();
     } else {
-        if (!q.lastError().text().isEmpty()) {
-            qCritical() << "[DatabaseManager] getNoteForDay error: " << q.lastError().text();
-            qDebug() << "[DatabaseManager] getNoteForDay fullquery: " << q.executedQuery();
+        if (!q->lastError().text().isEmpty()) {
+            qCritical() << "[DatabaseManager] getNoteForDay error: " << q->lastError().text();
+            qDebug() << "[DatabaseManager] getNoteForDay fullquery: " << q->executedQuery();
         }
     }
 
@@ -1203,34 +2257,31 @@ DatabaseManager::SongDetails DatabaseManager::getSongDetails(qlonglong songId)
         return details;
     details.id = -1; // Fehler-Indikator
 
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
-    q.prepare("SELECT s.id, s.title, a.name AS artist_name, t.name AS tuning_name, s.base_bpm, "
-              "       pj.practiced_bpm AS last_practice_bpm "
-              "FROM songs s "
-              "LEFT JOIN artists a ON s.artist_id = a.id "
-              "LEFT JOIN tunings t ON s.tuning_id = t.id "
-              "LEFT JOIN practice_journal pj ON pj.id = ("
-              "    SELECT id FROM practice_journal "
-              "    WHERE song_id = s.id "
-              "    ORDER BY practice_date DESC, id DESC LIMIT 1"
-              ") "
-              "WHERE s.id = ?");
-
-    q.addBindValue(songId);
-
-    if (q.exec() && q.next()) {
-        details.id = q.value("id").toLongLong();
-        details.title = q.value("title").toString();
-        details.artist = q.value("artist_name").toString();
-        details.tuning = q.value("tuning_name").toString();
-        details.bpm = q.value("base_bpm").toInt();
-        details.practice_bpm = q.value("last_practice_bpm").toInt();
+    StatementCache::Handle q = cachedQuery("SELECT s.id, s.title, a.name AS artist_name, t.name AS tuning_name, s.base_bpm, "
+                                           "       pj.practiced_bpm AS last_practice_bpm "
+                                           "FROM songs s "
+                                           "LEFT JOIN artists a ON s.artist_id = a.id "
+                                           "LEFT JOIN tunings t ON s.tuning_id = t.id "
+                                           "LEFT JOIN practice_journal pj ON pj.id = ("
+                                           "    SELECT id FROM practice_journal "
+                                           "    WHERE song_id = s.id "
+                                           "    ORDER BY practice_date DESC, id DESC LIMIT 1"
+                                           ") "
+                                           "WHERE s.id = ?");
+
+    q->addBindValue(songId);
+
+    if (q->exec() && q->next()) {
+        details.id = q->value("id").toLongLong();
+        details.title = q->value("title").toString();
+        details.artist = q->value("artist_name").toString();
+        details.tuning = q->value("tuning_name").toString();
+        details.bpm = q->value("base_bpm").toInt();
+        details.practice_bpm = q->value("last_practice_bpm").toInt();
     } else {
         qCritical() << "[DatabaseManager] getSongDetails songId" << songId
-                    << "not found: " << q.lastError().text();
-        qCritical() << "[DatabaseManager] getSongDetails fullqueryL: " << q.executedQuery();
+                    << "not found: " << q->lastError().text();
+        qCritical() << "[DatabaseManager] getSongDetails fullqueryL: " << q->executedQuery();
     }
 
     return details;
@@ -1250,7 +2301,7 @@ QList<DatabaseManager::SongDetails> DatabaseManager::getFilteredFiles(bool gp, b
 
     if (extensions.isEmpty()) return songs;
 
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
 
     QString sql = "SELECT "
                   "mf.id AS file_id, "
@@ -1279,6 +2330,8 @@ QList<DatabaseManager::SongDetails> DatabaseManager::getFilteredFiles(bool gp, b
 
     sql += " ORDER BY s.title ASC, mf.file_path ASC";
 
+    const QString managedPath = getManagedPath(); // Same for every row
+
     QSqlQuery q(db);
 
     if(q.exec(sql)) {
@@ -1288,7 +2341,6 @@ QList<DatabaseManager::SongDetails> DatabaseManager::getFilteredFiles(bool gp, b
             details.id = q.value("file_id").toInt();
 
             QString rawPath = q.value("file_path").toString();
-            QString managedPath = getManagedPath();
 
             QString path = managedPath.isEmpty() ? rawPath : QDir(managedPath).filePath(rawPath);
             QString cleaned = QDir::cleanPath(path);
@@ -1334,23 +2386,21 @@ QMap<int, QString> DatabaseManager::getPracticedSongsForDay(QDate date)
 {
     QMap<int, QString> songMap;
 
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
     // Get song ID and title for all entries this day
-    q.prepare("SELECT s.id, s.title FROM songs s "
-              "JOIN practice_journal pj ON s.id = pj.song_id "
-              "WHERE DATE(pj.practice_date) = ? "
-              "GROUP BY s.id");
-    q.addBindValue(date.toString("yyyy-MM-dd"));
-
-    if (q.exec()) {
-        while (q.next()) {
-            songMap.insert(q.value(0).toInt(), q.value(1).toString());
+    StatementCache::Handle q = cachedQuery("SELECT s.id, s.title FROM songs s "
+                                           "JOIN practice_journal pj ON s.id = pj.song_id "
+                                           "WHERE pj.practice_date >= ? AND pj.practice_date < ? "
+                                           "GROUP BY s.id");
+    q->addBindValue(dayBegin(date));
+    q->addBindValue(dayEnd(date));
+
+    if (q->exec()) {
+        while (q->next()) {
+            songMap.insert(q->value(0).toInt(), q->value(1).toString());
         }
     } else {
-        qCritical() << "[DatabaseManager] getPracticedSongsForDay error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getPracticedSongsForDay fullquery: " << q.executedQuery();
+        qCritical() << "[DatabaseManager] getPracticedSongsForDay error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] getPracticedSongsForDay fullquery: " << q->executedQuery();
     }
     return songMap;
 }
@@ -1374,23 +2424,21 @@ QMap<int, QString> DatabaseManager::getPracticedSongsForDay(QDate date)
  */
 QString DatabaseManager::getPracticeSummaryForDay(QDate date)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
-    q.prepare("SELECT s.title FROM songs s "
-              "JOIN practice_journal pj ON s.id = pj.song_id "
-              "WHERE DATE(pj.practice_date) = ? "
-              "GROUP BY s.id");
-    q.addBindValue(date.toString("yyyy-MM-dd"));
+    StatementCache::Handle q = cachedQuery("SELECT s.title FROM songs s "
+                                           "JOIN practice_journal pj ON s.id = pj.song_id "
+                                           "WHERE pj.practice_date >= ? AND pj.practice_date < ? "
+                                           "GROUP BY s.id");
+    q->addBindValue(dayBegin(date));
+    q->addBindValue(dayEnd(date));
 
     QStringList songs;
-    if (q.exec()) {
-        while (q.next()) {
-            songs << "• " + q.value(0).toString();
+    if (q->exec()) {
+        while (q->next()) {
+            songs << "• " + q->value(0).toString();
         }
     } else {
-        qCritical() << "[DatabaseManager] getPracticeSummaryForDay error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getPracticeSummaryForDay fullquery: " << q.executedQuery();
+        qCritical() << "[DatabaseManager] getPracticeSummaryForDay error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] getPracticeSummaryForDay fullquery: " << q->executedQuery();
     }
     return songs.isEmpty() ? "" : songs.join("\n");
 }
@@ -1415,10 +2463,11 @@ QList<QDate> DatabaseManager::getAllPracticeDates()
 {
     QList<QDate> dates;
 
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     QSqlQuery q(db);
 
-    // DISTINCT ensures that we only receive each date once.
+    // DISTINCT ensures that we only receive each date once. The (practice_date, song_id)
+    // index covers the query, so the table itself is not read.
     if (!q.exec("SELECT DISTINCT DATE(practice_date) FROM practice_journal")) {
         qCritical() << "[DatabaseManager] getAllPracticeDates error: " << q.lastError().text();
         qDebug() << "[DatabaseManager] getAllPracticeDates fullquery: " << q.executedQuery();
@@ -1429,6 +2478,111 @@ QList<QDate> DatabaseManager::getAllPracticeDates()
     return dates;
 }
 
+/**
+ * @brief Retrieves everything the calendar shows for a range of days in one query.
+ *
+ * Replaces getAllPracticeDates() followed by getPracticeSummaryForDay() per date:
+ * the journal is grouped by day and song in SQL (searching idx_journal_date_song),
+ * and the rows are folded into one PracticeDay per date here.
+ *
+ * @param from First day of the range.
+ * @param to Last day of the range (inclusive).
+ *
+ * @return Practiced days of the range with their songs, total repetitions and highest
+ *         BPM. Days without entries are not contained. Empty if the query fails.
+ */
+QMap<QDate, PracticeDay> DatabaseManager::getPracticeCalendar(QDate from, QDate to)
+{
+    QMap<QDate, PracticeDay> days;
+
+    StatementCache::Handle q = cachedQuery("SELECT DATE(pj.practice_date) AS day, s.title, "
+                                           "SUM(pj.total_reps), MAX(pj.practiced_bpm) "
+                                           "FROM practice_journal pj "
+                                           "JOIN songs s ON s.id = pj.song_id "
+                                           "WHERE pj.practice_date >= ? AND pj.practice_date < ? "
+                                           "GROUP BY day, s.id "
+                                           "ORDER BY day");
+    q->addBindValue(dayBegin(from));
+    q->addBindValue(dayEnd(to));
+
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] getPracticeCalendar error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] getPracticeCalendar fullquery: " << q->executedQuery();
+        return days;
+    }
+
+    while (q->next()) {
+        PracticeDay &day = days[QDate::fromString(q->value(0).toString(), "yyyy-MM-dd")];
+        day.songTitles << q->value(1).toString();
+        day.totalReps += q->value(2).toInt();
+        day.maxBpm = qMax(day.maxBpm, q->value(3).toInt());
+    }
+    return days;
+}
+
+// =============================================================================
+// --- Background queries (DatabaseWorker)
+// =============================================================================
+
+QFuture<QList<DatabaseManager::SongDetails>> DatabaseManager::getFilteredFilesAsync(bool gp, bool audio, bool video, bool doc, bool unlinkedOnly)
+{
+    return reader().enqueue([this, gp, audio, video, doc, unlinkedOnly]() {
+        return getFilteredFiles(gp, audio, video, doc, unlinkedOnly);
+    });
+}
+
+/**
+ * @brief Streams the media catalog from the background connection.
+ *
+ * The entries are added to the future in chunks of kCatalogChunk, so a QFutureWatcher
+ * (resultsReadyAt) can fill a view while the rest is still being read. Canceling the
+ * future stops the query at the next row.
+ *
+ * @return Future with one result per media file, sorted by file_path.
+ */
+QFuture<DatabaseManager::CatalogEntry> DatabaseManager::getCatalogAsync()
+{
+    return reader().stream<CatalogEntry>([this](QPromise<CatalogEntry> &promise) {
+        StatementCache::Handle q = cachedQuery("SELECT id, file_path, song_id FROM media_files ORDER BY file_path ASC");
+        if (!q->exec()) {
+            qCritical() << "[DatabaseManager] getCatalogAsync error: " << q->lastError().text();
+            qDebug() << "[DatabaseManager] getCatalogAsync fullquery: " << q->executedQuery();
+            return;
+        }
+
+        QList<CatalogEntry> chunk;
+        chunk.reserve(kCatalogChunk);
+        while (q->next()) {
+            if (promise.isCanceled())
+                return;
+
+            chunk.append({q->value(0).toInt(), q->value(2).toInt(), q->value(1).toString()});
+            if (chunk.size() == kCatalogChunk) {
+                promise.addResults(chunk);
+                chunk.clear();
+            }
+        }
+        if (!chunk.isEmpty()) {
+            promise.addResults(chunk);
+        }
+    });
+}
+
+QFuture<QMap<QDate, PracticeDay>> DatabaseManager::getPracticeCalendarAsync(QDate from, QDate to)
+{
+    return reader().enqueue([this, from, to]() { return getPracticeCalendar(from, to); });
+}
+
+QFuture<QVariantList> DatabaseManager::getRemindersForDateAsync(const QDate &date)
+{
+    return reader().enqueue([this, date]() { return getRemindersForDate(date); });
+}
+
+QFuture<bool> DatabaseManager::enqueueWrite(std::function<bool ()> write)
+{
+    return worker_m.enqueue(std::move(write));
+}
+
 // =============================================================================
 // --- Reminder
 // =============================================================================
@@ -1443,7 +2597,7 @@ bool DatabaseManager::addReminder(int songId,
                                   int weekday,
                                   const QString &reminderDate)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     if (!db.transaction())
         return false;
 
@@ -1493,7 +2647,7 @@ bool DatabaseManager::addReminder(int songId,
 
 QVariantList DatabaseManager::getRemindersForDate(const QDate &date)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     if (!db.isValid() || !db.isOpen()) {
         qCritical() << "[DatabaseManager] No valid database connection!";
         return {};
@@ -1635,7 +2789,7 @@ ReminderDialog::ReminderData DatabaseManager::getReminder(int reminderId)
 }
 
 bool DatabaseManager::updateReminder(int reminderId, const ReminderDialog::ReminderData &data) {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
     if (!db.transaction()) {
         return false;
     }
@@ -1683,7 +2837,7 @@ bool DatabaseManager::updateReminder(int reminderId, const ReminderDialog::Remin
 
 bool DatabaseManager::deleteReminder(int reminderId)
 {
-    QSqlDatabase db = QSqlDatabase::database();
+    QSqlDatabase db = connection();
 
     QSqlQuery q(db);
     q.prepare("DELETE FROM reminder_completion_conditions WHERE reminder_id = :id");
@@ -1727,126 +2881,99 @@ bool DatabaseManager::deleteReminder(int reminderId)
  *
  * @note Uses INSERT OR REPLACE SQL statement to handle both insertion and updating.
  * @note Boolean QVariant values are automatically converted to "true"/"false" strings.
+ * @note The value is written through to the settings cache; settingChanged() is emitted
+ *       if it differs from the cached one.
  */
 bool DatabaseManager::setSetting(const QString &key, const QVariant &value)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
+    const QString text = value.toString(); // QVariant automatically converts boolean values to "true"/"false".
 
-    q.prepare("INSERT OR REPLACE INTO settings (key, value) VALUES (?, ?)");
-    q.addBindValue(key);
-    q.addBindValue(
-        value.toString()); // QVariant automatically converts boolean values ​​to "true"/"false".
+    StatementCache::Handle q = cachedQuery("INSERT OR REPLACE INTO settings (key, value) VALUES (?, ?)");
+    q->addBindValue(key);
+    q->addBindValue(text);
 
-    if (!q.exec()) {
-        qCritical() << "[DatabaseManager] setSetting error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] setSetting fullquery: " << q.executedQuery();
+    if (!q->exec()) {
+        qCritical() << "[DatabaseManager] setSetting error: " << q->lastError().text();
+        qDebug() << "[DatabaseManager] setSetting fullquery: " << q->executedQuery();
         return false;
     }
 
+    if (settings_m.insert(key, text)) {
+        emit settingChanged(key, text);
+    }
     return true;
 }
 
 /**
- * @brief Retrieves a string setting value from the database.
+ * @brief Retrieves a string setting value.
  *
- * Queries the settings table for a value associated with the given key.
- * If the key exists, returns its corresponding value. If the key does not exist
- * or if the query fails, returns the provided default value.
+ * Looks the key up in the settings cache, which is filled from the settings table
+ * on first use (settingValue()).
  *
- * @param key The setting key to look up in the database.
- * @param defaultValue The value to return if the key is not found or query fails.
+ * @param key The setting key to look up.
+ * @param defaultValue The value to return if the key is not found or the table could not be read.
  *
  * @return The setting value as a QString if found, otherwise the defaultValue.
- *         On database error, logs the error and returns defaultValue.
- *
- * @note Logs database errors to qDebug() if the query fails.
  */
 QString DatabaseManager::getSetting(const QString &key, const QString &defaultValue)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-
-    q.prepare("SELECT value FROM settings WHERE key = :key");
-    q.bindValue(":key", key);
-
-    if (q.exec() && q.next()) {
-        return q.value(0).toString();
-    } else {
-        qCritical() << "[DatabaseManager] getSetting error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getSetting fullquery: " << q.executedQuery();
-    }
-    return defaultValue;
+    return settingValue(key).value_or(defaultValue);
 }
 
 /**
- * @brief Retrieves a setting value from the database.
+ * @brief Retrieves a setting value.
  *
- * Queries the settings table for a value associated with the given key.
- * If the key exists in the database, returns its value. If the query fails
- * or the key is not found, returns the provided default value.
+ * Same as the QString overload; the value is returned as a QVariant holding the stored
+ * text. setting<T>() converts it to a type instead.
  *
- * @param key The settings key to look up in the database.
- * @param defaultValue The value to return if the key is not found or query fails.
+ * @param key The settings key to look up.
+ * @param defaultValue The value to return if the key is not found or the table could not be read.
  *
  * @return The setting value if found, otherwise the defaultValue.
- *         The return type is QVariant to support multiple data types.
- *
- * @note On query failure, an error message is logged to qDebug().
  */
 QVariant DatabaseManager::getSetting(const QString &key, const QVariant &defaultValue)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
+    const std::optional<QString> value = settingValue(key);
+    return value ? QVariant(*value) : defaultValue;
+}
 
-    q.prepare("SELECT value FROM settings WHERE key = ?");
-    q.addBindValue(key);
+/**
+ * @brief Value of key from the settings cache, loading the whole table on first use.
+ *
+ * The settings table holds a handful of rows, so one SELECT replaces the query per
+ * getSetting() call (getFilteredFiles() used to run one per row). The cache is cleared
+ * with the connection and on rollback().
+ *
+ * @return The stored text, or std::nullopt if the key does not exist or the table could not be read.
+ */
+std::optional<QString> DatabaseManager::settingValue(const QString &key)
+{
+    const bool loaded = settings_m.load([this](QHash<QString, QString> &values) {
+        StatementCache::Handle q = cachedQuery("SELECT key, value FROM settings");
+        if (!q->exec()) {
+            qCritical() << "[DatabaseManager] settingValue error: " << q->lastError().text();
+            qDebug() << "[DatabaseManager] settingValue fullquery: " << q->executedQuery();
+            return false;
+        }
+        while (q->next()) {
+            values.insert(q->value(0).toString(), q->value(1).toString());
+        }
+        return true;
+    });
 
-    if (q.exec() && q.next()) {
-        return q.value(0);
-    } else {
-        qCritical() << "[DatabaseManager] getSetting (QVariant) error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getSetting (QVariant): fullquery: " << q.executedQuery();
-    }
-    return defaultValue;
+    return loaded ? settings_m.value(key) : std::nullopt;
 }
 
 // Privat
 
 QStringList DatabaseManager::getAllArtists() {
-    QStringList artists;
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-    q.prepare("SELECT name FROM artists ORDER BY name ASC");
-
-    if (q.exec()) {
-        while (q.next()) {
-            artists << q.value(0).toString();
-        }
-    } else {
-        qCritical() << "[DatabaseManager] getAllArtists, error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getAllArtists, fullquery: " << q.executedQuery();
-    }
-
-    return artists;
+    (void) loadNames(artists_m, "artists");
+    return artists_m.names();
 }
 
 QStringList DatabaseManager::getAllTunings() {
-    QStringList tunings;
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery q(db);
-    q.prepare("SELECT name FROM tunings ORDER BY name ASC");
-
-    if (q.exec()) {
-        while (q.next()) {
-            tunings << q.value(0).toString();
-        }
-    } else {
-        qCritical() << "[DatabaseManager] getAllTunings, error: " << q.lastError().text();
-        qDebug() << "[DatabaseManager] getAllTunings, fullquery: " << q.executedQuery();
-    }
-
-    return tunings;
+    (void) loadNames(tunings_m, "tunings");
+    return tunings_m.names();
 }
 
 bool DatabaseManager::updateSong(int songId, const QString &title, int artistId, int tuningId, int bpm) {
@@ -1,13 +1,27 @@
 #ifndef DATABASEMANAGER_H
 #define DATABASEMANAGER_H
 
+#include "databaseworker.h"
+#include "namedictionary.h"
 #include "reminderdialog.h"
+#include "schemamigrator.h"
+#include "settingscache.h"
+#include "sonarstructs.h"
+#include "statementcache.h"
 
 #include <QSqlDatabase>
 #include <QString>
 #include <QObject>
 #include <QVariant>
 #include <QDate>
+#include <QFuture>
+
+#include <atomic>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
 
 struct PracticeSession {
     QDate date;
@@ -18,6 +32,29 @@ struct PracticeSession {
     int streaks{0};
 };
 
+// One day of the practice calendar (DatabaseManager::getPracticeCalendar)
+struct PracticeDay {
+    QStringList songTitles; // Songs practiced that day, each once
+    int totalReps{0};
+    int maxBpm{0};
+};
+
+// SQLite settings applied whenever DatabaseManager opens a database
+struct ConnectionProfile {
+    QString journalMode{"WAL"};    // PRAGMA journal_mode
+    QString synchronous{"NORMAL"}; // PRAGMA synchronous; NORMAL is durable across app crashes in WAL mode
+    qint64 mmapSize{256LL * 1024 * 1024}; // PRAGMA mmap_size in bytes, 0 = off
+    int cacheSizeKiB{16 * 1024};   // PRAGMA cache_size (page cache per connection)
+    QString tempStore{"MEMORY"};   // PRAGMA temp_store
+    int busyTimeoutMs{5000};       // Wait for locks of other connections instead of failing at once
+    int readConnections{2};        // Read-only connections for the *Async reads (WAL only), 0 = none
+
+    // SQLite's own defaults: rollback journal with an fsync per commit
+    [[nodiscard]] static ConnectionProfile sqliteDefaults() {
+        return {"DELETE", "FULL", 0, 2000, "DEFAULT", 0};
+    }
+};
+
 class DatabaseManager : public QObject {
     Q_OBJECT
 public:
@@ -45,6 +82,13 @@ public:
 
     };
 
+    // One row of the media catalog (LibraryPage)
+    struct CatalogEntry {
+        int fileId{0};
+        int songId{0};
+        QString filePath;
+    };
+
     // Singleton & Lifecycle
     static DatabaseManager& instance();
     DatabaseManager(const DatabaseManager&) = delete;
@@ -53,14 +97,20 @@ public:
     [[nodiscard]] bool initDatabase(const QString &dbPath);
     void closeDatabase();
 
+    // Takes effect the next time initDatabase() opens a database
+    void setConnectionProfile(const ConnectionProfile &profile) { profile_m = profile; }
+    [[nodiscard]] const ConnectionProfile &connectionProfile() const { return profile_m; }
+
     // Setup & Metadata (Initialization & Versioning)
     [[nodiscard]] bool createInitialTables();
     [[nodiscard]] bool hasData();
     [[nodiscard]] int getDatabaseVersion();
     [[nodiscard]] bool setDatabaseVersion(int version);
+    // Schema steps applied by the last initDatabase() (empty if it was up to date)
+    [[nodiscard]] const QList<SchemaMigrator::StepReport> &migrationReport() const { return migrationReport_m; }
 
     // File Management & Media (Files & Relations)
-    [[nodiscard]] bool addFileToSong(qlonglong songId, const QString &filePath, bool isManaged, const QString &fileType, qint64 fileSize, QString fileHash);
+    [[nodiscard]] bool addFileToSong(qlonglong songId, const QString &filePath, bool isManaged, const QString &fileType, qint64 fileSize, const FileHash &fileHash);
     [[nodiscard]] QString getManagedPath();
     [[nodiscard]] qlonglong createSong(const QString &title,
                                        const QString &artist = "Unknown",
@@ -71,9 +121,42 @@ public:
     [[nodiscard]] int getOrCreateTuning(const QString &name);
     [[nodiscard]] QStringList getAllArtists();
     [[nodiscard]] QStringList getAllTunings();
+    [[nodiscard]] bool renameArtist(int artistId, const QString &name);
+    [[nodiscard]] bool renameTuning(int tuningId, const QString &name);
 
-    [[nodiscard]] QSet<QString> getAllFileHashes();
-    [[nodiscard]] bool updateFileHash(int songId, const QString &fileHash);
+    // Sorted names for combo boxes and completers; updated in place on insert and rename
+    [[nodiscard]] QAbstractItemModel *artistModel();
+    [[nodiscard]] QAbstractItemModel *tuningModel();
+    // Reads the name tables again after another connection added names (ImportProcessor)
+    void reloadNameDictionaries();
+
+    // Import of many files in one go; songs[i] is the song for tasks[i], songIds gets their ids
+    [[nodiscard]] bool bulkImport(const QList<ImportTask> &tasks, const QList<ImportSong> &songs, bool isManaged,
+                                  QList<qlonglong> *songIds = nullptr);
+
+    // Import journal (ImportProcessor): the tasks of an import and how far each got, committed
+    // at every checkpoint, so an import interrupted by a crash can be resumed or undone later
+    [[nodiscard]] qlonglong createImportJob(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved);
+    [[nodiscard]] qlonglong unfinishedImportJob(); // 0 = none
+    [[nodiscard]] std::optional<ImportJob> loadImportJob(qlonglong jobId);
+    [[nodiscard]] bool updateImportJournal(qlonglong jobId, const QList<ImportJournalEntry> &entries);
+    [[nodiscard]] bool removeImportJob(qlonglong jobId, bool withSongs);
+
+    [[nodiscard]] QSet<quint64> getAllFileHashes();
+    [[nodiscard]] bool updateFileHash(int songId, quint64 fileHash);
+    // Re-hashes the media files without a hash (all of them after a hash algorithm change, see
+    // initDatabase()). progress(done, total) comes before and after every kRehashChunk files;
+    // returning false stops. unhashed gets the number of files still without hash.
+    [[nodiscard]] bool rehashMediaFiles(const std::function<bool (int done, int total)> &progress = nullptr,
+                                        int *unhashed = nullptr);
+    // The same as a job on the writer; the future reports the progress and can be canceled,
+    // its result is the number of files still without hash
+    [[nodiscard]] QFuture<int> rehashMediaFilesAsync();
+    [[nodiscard]] bool migrateFileHashColumns();
+
+    // Scan cache (hashes of scanned files, keyed by path)
+    [[nodiscard]] ScanCache loadScanCache();
+    [[nodiscard]] bool storeScanCache(const ScanCache &entries);
 
     // Linking
     [[nodiscard]] bool addFileRelation(int idA, int idB);
@@ -103,6 +186,20 @@ public:
     [[nodiscard]] QMap<int, QString> getPracticedSongsForDay(QDate date);
     [[nodiscard]] QString getPracticeSummaryForDay(QDate date);
     [[nodiscard]] QList<QDate> getAllPracticeDates();
+    [[nodiscard]] QMap<QDate, PracticeDay> getPracticeCalendar(QDate from, QDate to); // Days from..to (inclusive)
+
+    // Background connections (DatabaseWorker). The *Async reads run on the least busy read-only
+    // connection, next to the writer; continue with QFuture::then(context, ...) or a QFutureWatcher
+    // to get the results on the GUI thread. A read does not wait for writes still queued.
+    [[nodiscard]] QFuture<QList<SongDetails>> getFilteredFilesAsync(bool gp, bool audio, bool video, bool doc, bool unlinkedOnly);
+    [[nodiscard]] QFuture<CatalogEntry> getCatalogAsync(); // All media files sorted by path, in chunks
+    [[nodiscard]] QFuture<QMap<QDate, PracticeDay>> getPracticeCalendarAsync(QDate from, QDate to);
+    [[nodiscard]] QFuture<QVariantList> getRemindersForDateAsync(const QDate &date);
+    [[nodiscard]] int readConnectionCount() const { return int(readers_m.size()); }
+    // Serialised write queue on the background connection, in the order of the calls. write must
+    // not use createSong, getOrCreateArtist/-Tuning or rename* (they update the GUI models);
+    // bulkImport() is fine, call reloadNameDictionaries() on the GUI thread afterwards.
+    [[nodiscard]] QFuture<bool> enqueueWrite(std::function<bool ()> write);
 
     [[nodiscard]] bool addReminder(int songId,
                                    int startBar,
@@ -121,16 +218,85 @@ public:
     [[nodiscard]] ReminderDialog::ReminderData getReminder(int reminderId);
     [[nodiscard]] QString getWeekdayName(int weekday) const;
 
-    // Settings (configuration)
+    // Settings (configuration), read from an in-memory copy of the settings table
     [[nodiscard]] bool setSetting(const QString &key, const QVariant &value);
     [[nodiscard]] QString getSetting(const QString &key, const QString &defaultValue = QString());
     [[nodiscard]] QVariant getSetting(const QString &key, const QVariant &defaultValue = QVariant());
 
+    // Typed read of a setting (stored as text), e.g. setting<bool>("is_managed")
+    template<typename T>
+    [[nodiscard]] T setting(const QString &key, const T &defaultValue = T()) {
+        const std::optional<QString> value = settingValue(key);
+        return value ? QVariant(*value).value<T>() : defaultValue;
+    }
+
+    // Prepared statement cache (counters for diagnostics and tests)
+    [[nodiscard]] StatementCache::Stats statementCacheStats() const { return statements_m.stats(); }
+    void resetStatementCacheStats() { statements_m.resetStats(); }
+
     // Transaction Management
-    [[nodiscard]] bool beginTransaction() { return QSqlDatabase::database().transaction(); }
-    [[nodiscard]] bool commit() { return QSqlDatabase::database().commit(); }
-    void rollback() { QSqlDatabase::database().rollback(); }
+    [[nodiscard]] bool beginTransaction() { return connection().transaction(); }
+    [[nodiscard]] bool commit() { return connection().commit(); }
+    void rollback() {
+        connection().rollback();
+        clearCaches(); // May hold names and settings written in the transaction
+    }
+
+signals:
+    // Emitted by setSetting() when the stored value changes; may come from a DatabaseWorker thread
+    void settingChanged(const QString &key, const QString &value);
+
+private:
+    // The connection of the calling thread: a worker's on a DatabaseWorker thread, else the default one
+    [[nodiscard]] QSqlDatabase connection() const;
+    [[nodiscard]] bool openConnection(QSqlDatabase &db, const QString &dbPath, bool readOnly = false);
+    [[nodiscard]] bool applyConnectionProfile(QSqlDatabase &db);
+    void startWorkers(const QString &dbPath);
+    void stopWorkers();
+    void stopWorker(DatabaseWorker &worker, const QString &connectionName);
+    // Least busy read-only connection; the writer if there are none
+    [[nodiscard]] DatabaseWorker &reader();
+    void registerMigrations(SchemaMigrator &migrator);
+    [[nodiscard]] bool createJournalIndexes();
+    [[nodiscard]] bool createImportJournalTables();
+    [[nodiscard]] bool resetFileHashes();
+
+    // Prepared statement on connection(), prepared once per SQL text
+    [[nodiscard]] StatementCache::Handle cachedQuery(const QString &sql);
+
+    // Multi-row INSERT of values (row after row), split so no statement exceeds kMaxBindValues.
+    // rowIds receives the rowid SQLite assigned to each row (plain INSERTs only, no OR IGNORE).
+    [[nodiscard]] bool insertRows(const QString &insert, int columns, const QVariantList &values,
+                                  QList<qlonglong> *rowIds = nullptr);
+    // Name tables (artists, tunings) through their dictionaries
+    [[nodiscard]] bool loadNames(NameDictionary &dictionary, const QString &table);
+    [[nodiscard]] int internName(NameDictionary &dictionary, const QString &table, const QString &name);
+    [[nodiscard]] bool renameName(NameDictionary &dictionary, const QString &table, int id, const QString &name);
+    // Adds all missing names to table and dictionary in multi-row inserts
+    [[nodiscard]] bool resolveNames(NameDictionary &dictionary, const QString &table, const QStringList &names);
+    // Settings, and on the GUI thread the name dictionaries (workers never write to them)
+    void clearCaches();
+    [[nodiscard]] std::optional<QString> settingValue(const QString &key);
+
+    static constexpr int kMaxBindValues = 999; // SQLITE_MAX_VARIABLE_NUMBER before SQLite 3.32
+    static constexpr int kCatalogChunk = 500;   // Entries per result batch of getCatalogAsync()
+    static constexpr int kRehashChunk = 200;    // Files per transaction of rehashMediaFiles()
+    static inline const QString kWorkerConnection = QStringLiteral("sonar_worker");
+    static inline const QString kReaderConnection = QStringLiteral("sonar_reader_%1");
 
+    ConnectionProfile profile_m;
+    QList<SchemaMigrator::StepReport> migrationReport_m;
+    StatementCache statements_m;
+    NameDictionary artists_m;
+    NameDictionary tunings_m;
+    // bulkImport() on the writer thread; loaded once, extended with the names it inserts
+    NameDictionary writerArtists_m;
+    NameDictionary writerTunings_m;
+    std::atomic<int> nameGeneration_m{0}; // Bumped by renames and reopening; the writer ones reload then
+    int writerNameGeneration_m{0};
+    SettingsCache settings_m;
+    DatabaseWorker worker_m; // The writer
+    std::vector<std::unique_ptr<DatabaseWorker>> readers_m;
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,70 @@
+#include "databaseworker.h"
+
+#include <QDebug>
+
+namespace {
+thread_local QString threadConnection; // Set on worker threads while their connection is open
+} // namespace
+
+bool DatabaseWorker::start(const QString &connectionName, const std::function<bool (QSqlDatabase &)> &open)
+{
+    stop();
+
+    connectionName_m = connectionName;
+    thread_m.setObjectName(connectionName);
+    thread_m.start();
+    context_m = new QObject;
+    context_m->moveToThread(&thread_m);
+
+    const bool opened = enqueue([connectionName, open]() {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        if (!open(db)) {
+            return false;
+        }
+        threadConnection = connectionName;
+        return true;
+    }).result();
+
+    if (!opened) {
+        qWarning() << "[DatabaseWorker] connection" << connectionName << "could not be opened";
+        stop();
+    }
+    return opened;
+}
+
+void DatabaseWorker::stop()
+{
+    if (!context_m)
+        return;
+
+    // Queued last, so every job queued before still runs
+    post([name = connectionName_m]() {
+        QSqlDatabase::database(name, false).close();
+        QSqlDatabase::removeDatabase(name);
+        threadConnection.clear();
+        QThread::currentThread()->quit();
+    });
+    thread_m.wait();
+
+    delete context_m;
+    context_m = nullptr;
+}
+
+QString DatabaseWorker::currentConnectionName()
+{
+    return threadConnection;
+}
+
+void DatabaseWorker::post(std::function<void ()> job)
+{
+    if (!context_m) {
+        job();
+        return;
+    }
+
+    pending_m++;
+    QMetaObject::invokeMethod(context_m, [this, job = std::move(job)]() {
+        job();
+        pending_m--;
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,105 @@
+#ifndef DATABASEWORKER_H
+#define DATABASEWORKER_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief A thread with its own database connection that runs queued jobs in order.
+ *
+ * Qt SQL connections may only be used by the thread that opened them, so all jobs run
+ * on the worker thread, where DatabaseManager::connection() returns the worker's
+ * connection. Jobs are executed one after another in the order they were queued. This
+ * makes the worker a serialised write queue as well: two writes never overlap, and a
+ * read queued after a write sees its result.
+ *
+ * Results are delivered through QFuture; QFuture::then(context, ...) or a QFutureWatcher
+ * hands them to the GUI thread. Without a running worker a job runs at once on the
+ * calling thread and the returned future is already finished.
+ *
+ * start(), stop() and the queueing functions are called from the thread owning the worker.
+ */
+class DatabaseWorker {
+public:
+    DatabaseWorker() = default;
+    DatabaseWorker(const DatabaseWorker &) = delete;
+    DatabaseWorker &operator=(const DatabaseWorker &) = delete;
+    ~DatabaseWorker() { stop(); }
+
+    // Starts the thread, adds connectionName on it and lets open() configure and open it
+    [[nodiscard]] bool start(const QString &connectionName, const std::function<bool (QSqlDatabase &)> &open);
+    // Runs the jobs still queued, then removes the connection and stops the thread
+    void stop();
+    [[nodiscard]] bool isRunning() const { return context_m != nullptr; }
+    // Jobs queued or running; DatabaseManager hands a read to the least busy reader
+    [[nodiscard]] int pendingJobs() const { return pending_m.load(std::memory_order_relaxed); }
+
+    // Connection of the worker running on the calling thread; empty on all other threads
+    [[nodiscard]] static QString currentConnectionName();
+
+    template<typename Job>
+    [[nodiscard]] QFuture<std::invoke_result_t<Job>> enqueue(Job job);
+
+    // job gets the promise and adds the results itself, so they can arrive in chunks
+    template<typename T>
+    [[nodiscard]] QFuture<T> stream(std::function<void (QPromise<T> &)> job);
+
+private:
+    // Queues job on the worker thread, or runs it at once if the worker is not running
+    void post(std::function<void ()> job);
+
+    QThread thread_m;
+    QObject *context_m{nullptr}; // Lives on thread_m; queued jobs are delivered to it
+    QString connectionName_m;
+    std::atomic<int> pending_m{0};
+};
+
+template<typename Job>
+QFuture<std::invoke_result_t<Job>> DatabaseWorker::enqueue(Job job)
+{
+    using T = std::invoke_result_t<Job>;
+
+    // QPromise is move-only, std::function needs a copyable job
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+
+    post([promise, job = std::move(job)]() mutable {
+        if (!promise->isCanceled()) {
+            if constexpr (std::is_void_v<T>) {
+                job();
+            } else {
+                promise->addResult(job());
+            }
+        }
+        promise->finish();
+    });
+    return future;
+}
+
+template<typename T>
+QFuture<T> DatabaseWorker::stream(std::function<void (QPromise<T> &)> job)
+{
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+
+    post([promise, job = std::move(job)]() {
+        if (!promise->isCanceled()) {
+            job(*promise);
+        }
+        promise->finish();
+    });
+    return future;
+}
+
+#endif // DATABASEWORKER_H
@@ -0,0 +1,57 @@
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include "sonarstructs.h"
+
+#include <QString>
+
+#include <functional>
+
+/**
+ * @brief Recursive enumeration of the regular files below a folder (FileScanner stage 1).
+ *
+ * Visits the same files as QDirIterator with QDir::Files | QDir::NoSymLinks: no symbolic
+ * links, no hidden files and no hidden folders. The order differs between backends.
+ *
+ * - QtIterator: QDirIterator; the size and modification time are filled while walking.
+ * - LinuxGetdents: reads whole directory blocks with getdents64 and classifies entries
+ *   by their d_type, so walking needs no stat at all. Size, modification time and inode
+ *   are read later with statx() by stat(), on the hashing workers, where the metadata
+ *   calls of several files run in parallel and overlap with hashing.
+ */
+class DirectoryWalker {
+public:
+    enum class Backend {
+        Auto,         // LinuxGetdents where available, else QtIterator
+        QtIterator,
+        LinuxGetdents
+    };
+
+    explicit DirectoryWalker(Backend backend = Backend::Auto);
+
+    [[nodiscard]] static bool isAvailable(Backend backend);
+    [[nodiscard]] Backend backend() const { return backend_m; } // Never Auto
+
+    // True if walk() leaves size, modification time and inode to stat()
+    [[nodiscard]] bool defersStat() const { return backend_m == Backend::LinuxGetdents; }
+
+    /**
+     * @brief Calls visit for every file below root; directory and fileName are set.
+     * @return false if visit returned false (abort).
+     */
+    bool walk(const QString &root, const std::function<bool (ScanBatch &&file)> &visit) const;
+
+    /**
+     * @brief Fills size, modification time and (where known) inode of a walked file.
+     * @return false if the file does not exist anymore; the fields are left at 0.
+     */
+    [[nodiscard]] bool stat(ScanBatch &file) const;
+
+private:
+    bool walkQt(const QString &root, const std::function<bool (ScanBatch &&file)> &visit) const;
+    bool walkLinux(const QString &root, const std::function<bool (ScanBatch &&file)> &visit) const;
+
+    Backend backend_m;
+};
+
+#endif // DIRECTORYWALKER_H
@@ -0,0 +1,52 @@
+#include "extensionmatcher.h"
+
+#include <algorithm>
+
+namespace {
+    [[nodiscard]] bool lessCaseInsensitive(QStringView a, QStringView b) {
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    }
+
+    // "*.ext" with a plain extension (no wildcards, brackets or further dots)
+    [[nodiscard]] bool isSuffixPattern(const QString &pattern) {
+        if (!pattern.startsWith(QLatin1String("*.")) || pattern.size() == 2) return false;
+        const QStringView suffix = QStringView(pattern).sliced(2);
+        return std::none_of(suffix.begin(), suffix.end(), [](QChar c) {
+            return c == u'*' || c == u'?' || c == u'[' || c == u']' || c == u'.' || c == u'/' || c == u'\\';
+        });
+    }
+}
+
+ExtensionMatcher::ExtensionMatcher(const QStringList &patterns) {
+    for (const QString &pattern : patterns) {
+        if (isSuffixPattern(pattern)) {
+            suffixes_m.append(pattern.sliced(2));
+            longestSuffix_m = qMax(longestSuffix_m, pattern.size() - 2);
+        } else if (!pattern.isEmpty()) {
+            // Same rules as QDir::match(): the whole name, case-insensitive
+            wildcards_m.append(QRegularExpression(QRegularExpression::wildcardToRegularExpression(pattern),
+                                                  QRegularExpression::CaseInsensitiveOption));
+            wildcards_m.last().optimize();
+        }
+    }
+
+    std::sort(suffixes_m.begin(), suffixes_m.end(), lessCaseInsensitive);
+    suffixes_m.erase(std::unique(suffixes_m.begin(), suffixes_m.end(), [](const QString &a, const QString &b) {
+        return a.compare(b, Qt::CaseInsensitive) == 0;
+    }), suffixes_m.end());
+}
+
+bool ExtensionMatcher::matches(QStringView fileName) const {
+    const qsizetype dot = fileName.lastIndexOf(u'.');
+    if (dot >= 0) {
+        const QStringView suffix = fileName.sliced(dot + 1);
+        if (!suffix.isEmpty() && suffix.size() <= longestSuffix_m) {
+            const auto it = std::lower_bound(suffixes_m.cbegin(), suffixes_m.cend(), suffix, lessCaseInsensitive);
+            if (it != suffixes_m.cend() && suffix.compare(*it, Qt::CaseInsensitive) == 0) return true;
+        }
+    }
+
+    return std::any_of(wildcards_m.cbegin(), wildcards_m.cend(), [fileName](const QRegularExpression &wildcard) {
+        return wildcard.matchView(fileName).hasMatch(); // Anchored by wildcardToRegularExpression()
+    });
+}
@@ -0,0 +1,34 @@
+#ifndef EXTENSIONMATCHER_H
+#define EXTENSIONMATCHER_H
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/**
+ * @brief Case-insensitive file name filter, built once from wildcard patterns.
+ *
+ * Patterns of the form "*.ext" (all of FileUtils::get*Formats()) go into a sorted
+ * suffix table; a file name is matched by one binary search on its last suffix
+ * without any allocation. Every other pattern is compiled to a QRegularExpression
+ * once and only tried when the table does not match.
+ *
+ * Matches the same names as QDir::match() for each pattern.
+ */
+class ExtensionMatcher {
+public:
+    ExtensionMatcher() = default;
+    explicit ExtensionMatcher(const QStringList &patterns);
+
+    [[nodiscard]] bool matches(QStringView fileName) const;
+    [[nodiscard]] bool isEmpty() const { return suffixes_m.isEmpty() && wildcards_m.isEmpty(); }
+
+private:
+    QStringList suffixes_m; // Without the dot, sorted case-insensitively
+    QList<QRegularExpression> wildcards_m;
+    qsizetype longestSuffix_m{0};
+};
+
+#endif // EXTENSIONMATCHER_H
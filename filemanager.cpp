@@ -68,95 +68,118 @@ QString FileManager::getStatusText(int status)
 }
 
 /**
- * @brief Inserts a list of ScanBatch objects into the model, automatically creating the folder hierarchy.
+ * @brief Returns the folder item for a path, creating the missing part of the folder hierarchy.
  *
- * @param batches: List of ScanBatch objects with file information
+ * @param folderPath: Absolute folder path
  */
-void FileManager::addBatchesToModel(const QList<ScanBatch> &batches)
+QStandardItem *FileManager::folderItemForPath(const QString &folderPath)
 {
-    if (batches.isEmpty())
-        return;
+    QString fullFolderPath = QDir::cleanPath(folderPath);
+    QStringList pathParts = fullFolderPath.split('/', Qt::SkipEmptyParts);
 
-    QStandardItem *root = model_m->invisibleRootItem();
+    QStandardItem *currentParent = model_m->invisibleRootItem();
+    QString currentAccumulatedPath;
 
-    for (const ScanBatch &batch : batches)
+    // Folder hierarchy with cache support
+    for (const QString &part : std::as_const(pathParts))
     {
-        QFileInfo fileInfo(batch.info);
-        QString fullFolderPath = QDir::cleanPath(fileInfo.absolutePath());
-        QStringList pathParts = fullFolderPath.split('/', Qt::SkipEmptyParts);
-
-        QStandardItem *currentParent = root;
-        QString currentAccumulatedPath;
-
-        // Folder hierarchy with cache support
-        for (const QString &part : std::as_const(pathParts))
+        // Build the path step by step for the cache key
+        if (currentAccumulatedPath.isEmpty() && folderPath.startsWith("/"))
         {
-            // Build the path step by step for the cache key
-            if (currentAccumulatedPath.isEmpty() && fileInfo.absolutePath().startsWith("/"))
-            {
-                // Linux/Unix Root
-                currentAccumulatedPath = QDir(currentAccumulatedPath).filePath(part);
-            }
-            else if (currentAccumulatedPath.isEmpty())
+            // Linux/Unix Root
+            currentAccumulatedPath = QDir(currentAccumulatedPath).filePath(part);
+        }
+        else if (currentAccumulatedPath.isEmpty())
+        {
+            if (part.contains(":") && part.length() == 2)
             {
-                if (part.contains(":") && part.length() == 2)
-                {
-                    currentAccumulatedPath = part + "/";
-                }
-                else
-                {
-                    currentAccumulatedPath = part;
-                }
+                currentAccumulatedPath = part + "/";
             }
             else
             {
-                currentAccumulatedPath = QDir::cleanPath(currentAccumulatedPath + "/" + part);
+                currentAccumulatedPath = part;
             }
+        }
+        else
+        {
+            currentAccumulatedPath = QDir::cleanPath(currentAccumulatedPath + "/" + part);
+        }
 
-            QString cleanKey = QDir::cleanPath(currentAccumulatedPath);
+        QString cleanKey = QDir::cleanPath(currentAccumulatedPath);
 
-            // Search in cache (faster than the for loop!)
-            if (pathCache_m.contains(cleanKey))
-            {
-                currentParent = pathCache_m.value(cleanKey);
-            }
-            else
-            {
-                QStandardItem *folderItem = new QStandardItem(part);
-                folderItem->setData(cleanKey, RoleFilePath);
-                folderItem->setData(ColFolderType, RoleItemType);
-                folderItem->setEditable(false);
-
-                // ALWAYS define visible columns for the row.
-                QList<QStandardItem *> folderRow;
-                folderRow << folderItem             // Spalte 0: Name/Tree
-                          << new QStandardItem("")  // Spalte 1: Size
-                          << new QStandardItem("")  // Spalte 2: Status
-                          << new QStandardItem(""); // Spalte 3: ID
-
-                currentParent->appendRow(folderRow);
-
-                // Add to cache (We only cache the first item of the row)
-                pathCache_m.insert(cleanKey, folderItem);
-                currentParent = folderItem;
-            }
+        // Search in cache (faster than the for loop!)
+        if (pathCache_m.contains(cleanKey))
+        {
+            currentParent = pathCache_m.value(cleanKey);
         }
+        else
+        {
+            QStandardItem *folderItem = new QStandardItem(part);
+            folderItem->setData(cleanKey, RoleFilePath);
+            folderItem->setData(ColFolderType, RoleItemType);
+            folderItem->setEditable(false);
+
+            // ALWAYS define visible columns for the row.
+            QList<QStandardItem *> folderRow;
+            folderRow << folderItem             // Spalte 0: Name/Tree
+                      << new QStandardItem("")  // Spalte 1: Size
+                      << new QStandardItem("")  // Spalte 2: Status
+                      << new QStandardItem(""); // Spalte 3: ID
+
+            currentParent->appendRow(folderRow);
+
+            // Add to cache (We only cache the first item of the row)
+            pathCache_m.insert(cleanKey, folderItem);
+            currentParent = folderItem;
+        }
+    }
+    return currentParent;
+}
+
+/**
+ * @brief Inserts scanned files into the model, automatically creating the folder hierarchy.
+ *
+ * The folder item is looked up once per folder of the batch, not once per file.
+ *
+ * @param batches: Scan results with file information
+ */
+void FileManager::addBatchesToModel(const ScanRecords &batches)
+{
+    if (batches.isEmpty())
+        return;
+
+    QList<QStandardItem *> folderById(batches.directoryCount(), nullptr);
+
+    for (qsizetype i = 0; i < batches.size(); ++i)
+    {
+        const int directoryId = batches.directoryId(i);
+        QStandardItem *&currentParent = folderById[directoryId];
+        if (!currentParent)
+            currentParent = folderItemForPath(batches.directoryPath(directoryId));
+
+        const QString filePath = batches.filePath(i);
+        const qint64 fileSize = batches.fileSize(i);
+        const FileHash &hash = batches.hash(i);
+        const int status = batches.status(i);
+        const int groupId = batches.groupId(i);
 
         // --- ADD FILE ---
         QList<QStandardItem *> row;
-        QStandardItem *nameItem = new QStandardItem(fileInfo.fileName());
-        nameItem->setData(batch.info.absoluteFilePath(), RoleFilePath);
-        nameItem->setData(batch.status, RoleFileStatus);
-        nameItem->setData(batch.info.size(), RoleFileSizeRaw);
-        nameItem->setData(batch.hash, RoleFileHash);
-        nameItem->setData(batch.groupId, RoleDuplicateId);
+        QStandardItem *nameItem = new QStandardItem(batches.fileName(i));
+        nameItem->setData(filePath, RoleFilePath);
+        nameItem->setData(status, RoleFileStatus);
+        nameItem->setData(fileSize, RoleFileSizeRaw);
+        nameItem->setData(QVariant::fromValue(hash), RoleFileHash);
+        if (const std::optional<ImportSong> song = batches.song(i))
+            nameItem->setData(QVariant::fromValue(*song), RoleSong);
+        nameItem->setData(groupId, RoleDuplicateId);
         nameItem->setData(ColFileType, RoleItemType);
         nameItem->setCheckable(true);
 
-        if (batch.info.size() > 0)
+        if (fileSize > 0)
         {
             nameItem->setCheckState(Qt::Checked);
-            nameItem->setToolTip(batch.hash);
+            nameItem->setToolTip(hash.toString());
             nameItem->setEnabled(true);
         }
         else
@@ -168,18 +191,54 @@ void FileManager::addBatchesToModel(const QList<ScanBatch> &batches)
             nameItem->setToolTip(toolTipStr);
         }
 
-        QStandardItem *sizeItem = new QStandardItem(FileUtils::formatBytes(batch.info.size()));
-        QStandardItem *statusItem = new QStandardItem(getStatusText(batch.status));
-        QStandardItem *groupIdItem = new QStandardItem(QString::number(batch.groupId));
+        QStandardItem *sizeItem = new QStandardItem(FileUtils::formatBytes(fileSize));
+        QStandardItem *statusItem = new QStandardItem(getStatusText(status));
+        QStandardItem *groupIdItem = new QStandardItem(QString::number(groupId));
 
         row << nameItem << sizeItem << statusItem << groupIdItem;
         currentParent->appendRow(row);
 
-        QString fileKey = QDir::cleanPath(batch.info.absoluteFilePath());
+        QString fileKey = QDir::cleanPath(filePath);
         pathCache_m.insert(fileKey, nameItem);
     }
 }
 
+/**
+ * @brief Marks already inserted files as duplicates (delta from a streaming scan).
+ *
+ * Only files that are still "ready" are changed; defects and files that are
+ * already in the database keep their status, as in a non-streaming scan.
+ *
+ * Every file whose sampled hash collided gets its verified hash, so files that only
+ * matched in their samples no longer compare equal; the real duplicates get their group.
+ *
+ * @param resolutionByPath: Verified hash and group id (0 = no duplicate) by absolute file path
+ */
+void FileManager::applyDuplicateGroups(const QHash<QString, DuplicateResolution> &resolutionByPath)
+{
+    for (auto it = resolutionByPath.cbegin(); it != resolutionByPath.cend(); ++it)
+    {
+        QStandardItem *nameItem = pathCache_m.value(QDir::cleanPath(it.key()));
+        if (!nameItem || nameItem->data(RoleFileStatus).toInt() != StatusReady)
+            continue;
+
+        const DuplicateResolution &resolution = it.value();
+        nameItem->setData(QVariant::fromValue(resolution.hash), RoleFileHash);
+        nameItem->setToolTip(resolution.hash.toString());
+        if (resolution.groupId == 0)
+            continue;
+
+        nameItem->setData(StatusDuplicate, RoleFileStatus);
+        nameItem->setData(resolution.groupId, RoleDuplicateId);
+
+        QStandardItem *parent = nameItem->parent() ? nameItem->parent() : model_m->invisibleRootItem();
+        if (QStandardItem *statusItem = parent->child(nameItem->row(), ColStatus))
+            statusItem->setText(getStatusText(StatusDuplicate));
+        if (QStandardItem *groupIdItem = parent->child(nameItem->row(), ColGroup))
+            groupIdItem->setText(QString::number(resolution.groupId));
+    }
+}
+
 /**
  * @brief Deletes all internal caches (pathCache_m and groupHeaderCache_m).
  *
@@ -1,6 +1,7 @@
 #ifndef FILEMANAGER_H
 #define FILEMANAGER_H
 
+#include "scanrecords.h"
 #include "sonarstructs.h"
 
 #include <QObject>
@@ -20,24 +21,26 @@ public:
     [[nodiscard]] static QColor getStatusColor(int status);
     [[nodiscard]] static QString getStatusText(int status);
 
-    void addBatchesToModel(const QList<ScanBatch> &batches);
+    void addBatchesToModel(const ScanRecords &batches);
+    void applyDuplicateGroups(const QHash<QString, DuplicateResolution> &resolutionByPath);
 
     void setModel(QStandardItemModel *model) {
         model_m = model;
     }
 
     void clearCaches();
-    void setExistingHashes(const QSet<QString> &hashes) { existingHashes_m = hashes; };
+    void setExistingHashes(const QSet<quint64> &hashes) { existingHashes_m = hashes; };
 
 private:
     [[nodiscard]] QStandardItem* findItemByPath(const QString& filePath);
+    [[nodiscard]] QStandardItem* folderItemForPath(const QString& folderPath);
     QStandardItemModel* model_m;
 
     QMap<int, QStringList> duplicateGroups_m;
     QHash<QString, QStandardItem*> pathCache_m;
     QHash<int, QStandardItem*> groupHeaderCache_m;
 
-    QSet<QString> existingHashes_m;
+    QSet<quint64> existingHashes_m;
 };
 
 #endif // FILEMANAGER_H
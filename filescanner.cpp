@@ -1,75 +1,489 @@
 #include "filescanner.h"
-#include "fnv1a.h"
+#include "boundedqueue.h"
+#include "gpparser.h"
+#include "samplehash.h"
 #include "algorithm"
 
+#include <QDebug>
+#include <QThreadPool>
+
+#include <utility>
+
+namespace {
+    // Pipeline item handed from the directory walk to the hashing workers.
+    // The sequence number restores the walk order after the parallel stage.
+    struct PendingFile {
+        qsizetype sequence{0};
+        ScanBatch file; // Folder and name; size and mtime only if the walker filled them
+    };
+
+    struct HashedFile {
+        qsizetype sequence{0};
+        ScanBatch data;
+    };
+
+    constexpr qsizetype kPendingQueueCapacity = 512; // Paths waiting for a worker
+    constexpr qsizetype kWorkerBatchSize = 32;       // Files a worker hashes before handing them over
+}
+
 bool FileScanner::isScanning() {
     return isScanning_m;
 }
 
+int FileScanner::workerCount() const {
+    return workerCount_m > 0 ? workerCount_m : qMax(1, QThread::idealThreadCount());
+}
+
 void FileScanner::doScan(const QStringList &paths, const QStringList &filters) {
     isScanning_m = true;
+    const ExtensionMatcher filter(filters); // Built once, shared read-only by the walkers
+    if (streamingBatchSize_m > 0) {
+        scanStreaming(paths, filter);
+    } else {
+        scanBuffered(paths, filter);
+    }
+    isScanning_m = false;
+}
+
+/**
+ * @brief Default mode: keeps every file until the end and emits the corrected list once.
+ */
+void FileScanner::scanBuffered(const QStringList &paths, const ExtensionMatcher &filter) {
     ReviewStats stats;
-    QList<ScanBatch> localBatch; // Saves EVERYTHING for later duplicate correction
-    QMap<QString, int> countMap; // Counts hashes across all files
-    QMap<QString, int> groupMap;
-    int nextGroupId = 1;
+    ScanRecords localBatch; // Saves EVERYTHING for later duplicate correction
+    HashGroupIndex index;        // Counts hashes across all files, hands out the group ids
 
     // 1. PHASE: Find and hash everything
+    const bool completed = collectFiles(paths, filter, stats, true, [&](ScanBatch &&data) {
+        index.add(data.hash); // Important for Phase 2
+        localBatch.append(data);
+    });
+    // 2. PHASE: Sampled hashes may collide for different files, compare the full content
+    if (!completed || !verifyCollisions(localBatch, index)) {
+        emitScanCacheUpdates();
+        emit finished(stats);
+        return;
+    }
+
+    // 3.PHASE: Finding the "truth" (correcting duplicates)
+    stats.duplicates = 0;
+
+    for (qsizetype i = 0; i < localBatch.size(); ++i) {
+        const FileHash &hash = localBatch.hash(i);
+        if (localBatch.status(i) == StatusReady && index.count(hash) > 1) {
+            localBatch.setStatus(i, StatusDuplicate);
+            localBatch.setGroupId(i, index.groupId(hash));
+            stats.duplicates++;
+        }
+    }
+
+    emit batchesFound(localBatch);
+    emitScanCacheUpdates();
+    emit finished(stats);
+    emit finishWithAllBatches(localBatch, stats);
+}
+
+/**
+ * @brief Streaming mode: emits batchesFound() every streamingBatchSize_m files as they are hashed.
+ *
+ * Files are emitted with their preliminary status. While hashing, only a count per
+ * sampled hash and per size of the "ready" files is kept (one 32-byte HashGroupIndex
+ * slot per distinct value, no paths). Once all files are known, collidingFiles() walks
+ * the folders again to find the files of the hashes that occur more than once; they are
+ * compared by their full content and duplicateGroupsResolved() delivers the verified
+ * hash and group id for each of them, so receivers can fix up the rows they already
+ * show. Group ids are assigned in directory-walk order.
+ * finishWithAllBatches() is not emitted.
+ *
+ * The scan cache updates (scanCacheUpdated()) go out with every chunk and are not kept.
+ */
+void FileScanner::scanStreaming(const QStringList &paths, const ExtensionMatcher &filter) {
+    ReviewStats stats;
+    ScanRecords chunk;
+    HashGroupIndex readyCounts; // Sampled hash (full hash 0) -> number of "ready" files
+    HashGroupIndex readySizes;  // File size (full hash 0) -> number of "ready" files
+
+    // 1. PHASE: Find, hash and hand out everything
+    const bool completed = collectFiles(paths, filter, stats, false, [&](ScanBatch &&data) {
+        if (data.status == StatusReady) {
+            readyCounts.add(FileHash{data.hash.sample, 0});
+            readySizes.add(FileHash{quint64(data.size), 0});
+        }
+
+        chunk.append(data);
+        if (chunk.size() >= streamingBatchSize_m) {
+            emit batchesFound(std::exchange(chunk, {}));
+            emitScanCacheUpdates();
+        }
+    });
+
+    if (!chunk.isEmpty()) {
+        emit batchesFound(chunk);
+    }
+    emitScanCacheUpdates();
+    if (!completed) {
+        emit finished(stats);
+        return;
+    }
+
+    // 2. PHASE: Compare the full content of all files whose sampled hash collides
+    QStringList suspects;
+    QList<quint64> suspectSamples;
+    if (!collidingFiles(paths, filter, readyCounts, readySizes, suspects, suspectSamples)) {
+        emit finished(stats);
+        return;
+    }
+
+    const QList<quint64> verified = fullHashes(suspects);
+    if (abort_m) {
+        emit finished(stats);
+        return;
+    }
+
+    // 3.PHASE: Resolve the duplicate groups and send them as a delta
+    HashGroupIndex index(suspects.size());
+    for (qsizetype i = 0; i < suspects.size(); ++i) {
+        if (verified.at(i) != 0) index.add(FileHash{suspectSamples.at(i), verified.at(i)});
+    }
+
+    QHash<QString, DuplicateResolution> resolutions;
+    resolutions.reserve(suspects.size());
+    stats.duplicates = 0;
+
+    for (qsizetype i = 0; i < suspects.size(); ++i) {
+        DuplicateResolution resolution;
+        resolution.hash = FileHash{suspectSamples.at(i), verified.at(i)};
+
+        if (index.count(resolution.hash) > 1) {
+            resolution.groupId = index.groupId(resolution.hash);
+            stats.duplicates++;
+        }
+        resolutions.insert(suspects.at(i), resolution); // groupId 0: unreadable or only the samples matched
+    }
+
+    emit duplicateGroupsResolved(resolutions);
+    emit finished(stats);
+}
+
+/**
+ * @brief Second walk of a streaming scan: the files whose sampled hash occurs more than once.
+ *
+ * Only files whose size occurs more than once among the "ready" files can collide;
+ * their sampled hash is taken from a still valid scan cache entry (see cachedHash()) or
+ * calculated again. Files that cannot be read any more are skipped.
+ *
+ * @param samples Gets the sampled hash of each file in filePaths.
+ * @return false if the scan was aborted.
+ */
+bool FileScanner::collidingFiles(const QStringList &paths, const ExtensionMatcher &filter,
+                                 const HashGroupIndex &readyCounts, const HashGroupIndex &readySizes,
+                                 QStringList &filePaths, QList<quint64> &samples) {
     for (const QString &path : paths) {
-        QDirIterator it(QDir(path).absolutePath(), QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            if (abort_m) { emit finished(stats); return; }
-            it.next();
-            QFileInfo info = it.fileInfo();
-
-            // Filter Check
-            bool match = std::any_of(filters.begin(), filters.end(), [&](const QString &f) {
-                return QDir::match(f, info.fileName());
-            });
-            if (!match) continue;
+        const bool completed = walker_m.walk(path, [&](ScanBatch &&file) {
+            if (abort_m) return false;
+            if (!filter.matches(file.fileName)) return true;
+            if (walker_m.defersStat() && !walker_m.stat(file)) return true;
+            if (readySizes.count(FileHash{quint64(file.size), 0}) < 2) return true;
 
+            const QString filePath = file.filePath();
+            quint64 sample = cachedHash(filePath, ScanCacheEntry{file.size, file.modified, file.inode, 0});
+            if (sample == 0) {
+                bool ok = false;
+                sample = SampleHash::calculate(filePath, &ok);
+                if (!ok) return true;
+            }
 
-            bool isDefect = (info.size() == 0);
-            QString hash = isDefect ? "0" : FNV1a::calculate(info.absoluteFilePath());
-            bool alreadyInDb = existingHashes_m.contains(hash);
+            if (sample != SampleHash::kEmptyFileHash && readyCounts.count(FileHash{sample, 0}) > 1) {
+                filePaths.append(filePath);
+                samples.append(sample);
+            }
+            return true;
+        });
+        if (!completed) return false;
+    }
+    return true;
+}
 
-            ScanBatch data;
-            data.info = info;
-            data.hash = hash;
-            data.status = alreadyInDb ? StatusAlreadyInDatabase : (isDefect ? StatusDefect : StatusReady);
+/**
+ * @brief Replaces the counts of colliding sampled hashes by counts of the full content hash.
+ *
+ * Every "ready" file whose sampled hash occurs more than once gets its full hash;
+ * afterwards the index counts the complete FileHash for them. Files that only matched
+ * in their samples, or could not be read completely, therefore no longer count as
+ * duplicates.
+ *
+ * @return false if the scan was aborted.
+ */
+bool FileScanner::verifyCollisions(ScanRecords &files, HashGroupIndex &index) {
+    QList<qsizetype> suspects;
+    QStringList suspectPaths;
+    for (qsizetype i = 0; i < files.size(); ++i) {
+        if (files.status(i) == StatusReady && index.count(files.hash(i)) > 1) {
+            suspects.append(i);
+            suspectPaths.append(files.filePath(i));
+        }
+    }
 
-            // Statistics for the "Live" display (without duplicates)
-            stats.addFile(info.size(), false, isDefect, alreadyInDb);
+    const QList<quint64> verified = fullHashes(suspectPaths);
+    if (abort_m) return false;
+
+    for (qsizetype i = 0; i < suspects.size(); ++i) {
+        const qsizetype row = suspects.at(i);
+        index.clear(files.hash(row));
+        files.setHash(row, FileHash{files.hash(row).sample, verified.at(i)});
+    }
+    for (const qsizetype row : std::as_const(suspects)) {
+        const FileHash &hash = files.hash(row);
+        if (hash.isVerified()) {
+            index.add(hash);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Hashes the complete content of the given files on workerCount() threads.
+ *
+ * @return The full hashes in the order of filePaths; 0 for files that could not be
+ *         read. Incomplete if the scan was aborted.
+ */
+QList<quint64> FileScanner::fullHashes(const QStringList &filePaths) {
+    QList<quint64> result(filePaths.size(), 0);
+    if (filePaths.isEmpty()) return result;
+
+    quint64 *out = result.data(); // Detached once here, the workers write disjoint slots
+    std::atomic<qsizetype> next{0};
+    const auto hashNext = [&]() {
+        for (qsizetype i = next++; i < filePaths.size() && !abort_m; i = next++) {
+            out[i] = SampleHash::calculateFull(filePaths.at(i));
+        }
+    };
+
+    const int workers = static_cast<int>(qMin<qsizetype>(workerCount(), filePaths.size()));
+    if (workers <= 1) {
+        hashNext();
+        return result;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+    for (int i = 0; i < workers; ++i) {
+        pool.start(hashNext);
+    }
+    pool.waitForDone();
+    return result;
+}
+
+bool FileScanner::collectFiles(const QStringList &paths, const ExtensionMatcher &filter, ReviewStats &stats,
+                               bool keepWalkOrder, const std::function<void (ScanBatch &&)> &collect) {
+    return workerCount() > 1 ? scanParallel(paths, filter, stats, keepWalkOrder, collect)
+                             : scanSerial(paths, filter, stats, collect);
+}
 
-            countMap[hash]++; // Important for Phase 2
+/**
+ * @brief Walks and hashes all files on the calling thread (one file at a time).
+ *
+ * @return false if the scan was aborted.
+ */
+bool FileScanner::scanSerial(const QStringList &paths, const ExtensionMatcher &filter, ReviewStats &stats,
+                             const std::function<void (ScanBatch &&)> &collect) {
+    qsizetype found = 0;
+    for (const QString &path : paths) {
+        const bool completed = walker_m.walk(path, [&](ScanBatch &&file) {
+            if (abort_m) return false;
+            if (!filter.matches(file.fileName)) return true;
+
+            ScanBatch data = hashFile(std::move(file));
+
+            // Statistics for the "Live" display (without duplicates)
+            stats.addFile(data.size, false, data.status == StatusDefect, data.status == StatusAlreadyInDatabase);
 
-            localBatch.append(data);
-            if (localBatch.size() % 20 == 0) {
+            collect(std::move(data));
+            if (++found % 20 == 0) {
                 emit progressStats(stats);
             }
+            return true;
+        });
+        if (!completed) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Walks and hashes all files with a three-stage pipeline.
+ *
+ * One pool thread enumerates the directories and feeds a bounded queue, which is
+ * drained by workerCount() hashing threads. Each worker hands its results over in
+ * small batches; the calling thread merges them, keeps the statistics and reports
+ * progress. With keepWalkOrder the results are sorted back into directory-walk order
+ * before they are collected, so the outcome is identical to scanSerial(); otherwise
+ * they are collected as soon as a worker hands them over.
+ *
+ * @return false if the scan was aborted.
+ */
+bool FileScanner::scanParallel(const QStringList &paths, const ExtensionMatcher &filter, ReviewStats &stats,
+                               bool keepWalkOrder, const std::function<void (ScanBatch &&)> &collect) {
+    const int workers = workerCount();
+
+    BoundedQueue<PendingFile> pending(kPendingQueueCapacity);
+    BoundedQueue<QList<HashedFile>> hashed(workers * 4);
+    std::atomic<int> activeWorkers{workers};
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers + 1);
+
+    // Stage 1: directory enumeration
+    pool.start([&]() {
+        qsizetype sequence = 0;
+        for (const QString &path : paths) {
+            const bool completed = walker_m.walk(path, [&](ScanBatch &&file) {
+                if (abort_m) return false;
+                if (!filter.matches(file.fileName)) return true;
+
+                return pending.push(PendingFile{sequence++, std::move(file)}); // false: closed by an aborting worker
+            });
+            if (!completed) break;
         }
+        pending.close();
+    });
+
+    // Stage 2: hashing workers
+    for (int i = 0; i < workers; ++i) {
+        pool.start([&]() {
+            QList<HashedFile> batch;
+            batch.reserve(kWorkerBatchSize);
+
+            PendingFile file;
+            while (!abort_m && pending.pop(file)) {
+                batch.append(HashedFile{file.sequence, hashFile(std::move(file.file))});
+                if (batch.size() >= kWorkerBatchSize) {
+                    hashed.push(std::exchange(batch, {}));
+                    batch.reserve(kWorkerBatchSize);
+                }
+            }
+
+            if (abort_m) {
+                pending.close(); // Release a walker blocked on a full queue
+            } else if (!batch.isEmpty()) {
+                hashed.push(std::move(batch));
+            }
+
+            if (activeWorkers.fetch_sub(1) == 1) {
+                hashed.close();
+            }
+        });
     }
 
-    // 2.PHASE: Finding the "truth" (correcting duplicates)
-    QList<ScanBatch> duplicateUpdates;
-    stats.duplicates = 0;
+    // Stage 3: merge on the scanning thread
+    QList<HashedFile> merged;
+    QList<HashedFile> batch;
+    while (hashed.pop(batch)) {
+        for (const HashedFile &file : std::as_const(batch)) {
+            // Statistics for the "Live" display (without duplicates)
+            stats.addFile(file.data.size, false, file.data.status == StatusDefect, file.data.status == StatusAlreadyInDatabase);
+        }
+        if (keepWalkOrder) {
+            merged.append(std::move(batch));
+        } else {
+            for (HashedFile &file : batch) {
+                collect(std::move(file.data));
+            }
+        }
+        emit progressStats(stats);
+    }
 
-    for (ScanBatch &file : localBatch) {
-        if (countMap.value(file.hash) > 1 && file.status == StatusReady) {
-            file.status = StatusDuplicate;
-            stats.duplicates++;
+    pool.waitForDone();
+    if (abort_m) return false;
+
+    std::sort(merged.begin(), merged.end(), [](const HashedFile &a, const HashedFile &b) {
+        return a.sequence < b.sequence;
+    });
+
+    for (HashedFile &file : merged) {
+        collect(std::move(file.data));
+    }
+    return true;
+}
+
+/**
+ * @brief Hashes a single file and classifies it (defect, already in database, ready).
+ *
+ * Reads the file metadata first if the walker left it out. Files that are unchanged
+ * since the scan cache entry was written reuse the cached hash without opening the
+ * file. With setParseMetadata(), the Guitar Pro header of files not in the database
+ * yet is read right after the hash, while the file is in the page cache.
+ *
+ * Safe to call from several worker threads at once; existingHashes_m and
+ * scanCache_m are not modified while a scan is running.
+ */
+ScanBatch FileScanner::hashFile(ScanBatch &&file) {
+    ScanBatch data = std::move(file);
+    if (walker_m.defersStat() && !walker_m.stat(data)) {
+        data.size = 0; // Vanished since the walk: defect
+    }
+    bool isDefect = (data.size == 0);
+    quint64 hash = SampleHash::kEmptyFileHash;
+
+    if (!isDefect) {
+        const QString filePath = data.filePath();
+
+        ScanCacheEntry current;
+        current.size = data.size;
+        current.mtime = data.modified;
+        current.inode = data.inode;
 
-            if (!groupMap.contains(file.hash)) {
-                groupMap.insert(file.hash, nextGroupId++);
+        hash = cachedHash(filePath, current);
+        if (hash == 0) {
+            bool ok = false;
+            hash = SampleHash::calculate(filePath, &ok);
+            if (ok) {
+                current.hash = hash;
+                QMutexLocker locker(&freshCacheMutex_m);
+                freshCacheEntries_m.insert(filePath, current);
             }
-            file.groupId = groupMap.value(file.hash);
+        }
+    }
+
+    bool alreadyInDb = existingHashes_m.contains(hash);
+
+    data.hash.sample = hash;
+    data.status = alreadyInDb ? StatusAlreadyInDatabase : (isDefect ? StatusDefect : StatusReady);
 
-            duplicateUpdates.append(file);
+    if (parseMetadata_m && data.status == StatusReady
+        && GpParser::isGuitarProSuffix(QFileInfo(data.fileName).suffix())) {
+        try {
+            data.song = GpParser::parseSong(data.filePath());
+        } catch (const std::exception &e) {
+            qWarning() << "[FileScanner] Guitar Pro header not read, the import reads it again:" << e.what();
         }
     }
+    return data;
+}
 
-    emit batchesFound(localBatch);
-    emit finished(stats);
-    emit finishWithAllBatches(localBatch, stats);
-    isScanning_m = false;
+/**
+ * @brief Returns the cached hash if size, modification time and (when known) inode still match.
+ *
+ * @return The cached sampled hash, or 0 if the file has to be hashed again.
+ */
+quint64 FileScanner::cachedHash(const QString &filePath, const ScanCacheEntry &current) const {
+    const auto it = scanCache_m.constFind(filePath);
+    if (it == scanCache_m.cend()) return 0;
+
+    const ScanCacheEntry &cached = it.value();
+    const bool sameInode = cached.inode == 0 || current.inode == 0 || cached.inode == current.inode;
+    if (cached.size != current.size || cached.mtime != current.mtime || !sameInode) {
+        return 0;
+    }
+    return cached.hash;
+}
+
+void FileScanner::emitScanCacheUpdates() {
+    ScanCache fresh;
+    {
+        QMutexLocker locker(&freshCacheMutex_m);
+        fresh.swap(freshCacheEntries_m);
+    }
+    if (!fresh.isEmpty()) {
+        emit scanCacheUpdated(fresh);
+    }
 }
@@ -2,7 +2,11 @@
 #ifndef FILESCANNER_H
 #define FILESCANNER_H
 
+#include "directorywalker.h"
+#include "extensionmatcher.h"
+#include "hashgroupindex.h"
 #include "reviewstruct.h"
+#include "scanrecords.h"
 #include "sonarstructs.h"
 
 #include <QFileInfo>
@@ -10,6 +14,9 @@
 #include <QDirIterator>
 #include <QElapsedTimer>
 #include <QThread>
+#include <QMutex>
+
+#include <functional>
 
 class FileScanner : public QObject {
     Q_OBJECT
@@ -18,19 +25,62 @@ public slots:
     void abort() { abort_m = true; }
 
 signals:
-    void batchesFound(const QList<ScanBatch> &batches);
+    void batchesFound(const ScanRecords &batches);
     void progressStats(const ReviewStats &stats);
     void finished(const ReviewStats &finalStats);
-    void finishWithAllBatches(const QList<ScanBatch> &allBatches, const ReviewStats &stats); // call in MainWindow
+    void finishWithAllBatches(const ScanRecords &allBatches, const ReviewStats &stats); // call in MainWindow
+    void duplicateGroupsResolved(const QHash<QString, DuplicateResolution> &resolutionByPath); // streaming mode only
+    void scanCacheUpdated(const ScanCache &entries); // files hashed in this scan, emitted before finished(); once per chunk when streaming
 
 public:
-    void setExistingHashes(const QSet<QString> &hashes) { existingHashes_m = hashes; };
+    void setExistingHashes(const QSet<quint64> &hashes) { existingHashes_m = hashes; };
+    void setScanCache(const ScanCache &cache) { scanCache_m = cache; }
     bool isScanning();
 
+    // Number of hashing workers; 0 = one per core, 1 = hash inline on the scanning thread.
+    void setWorkerCount(int count) { workerCount_m = qMax(0, count); }
+    [[nodiscard]] int workerCount() const;
+
+    // Emit batchesFound() every n hashed files instead of once at the end; 0 = off.
+    void setStreamingBatchSize(int files) { streamingBatchSize_m = qMax(0, files); }
+
+    // How directories are enumerated; unavailable backends fall back to QDirIterator.
+    void setWalkerBackend(DirectoryWalker::Backend backend) { walker_m = DirectoryWalker(backend); }
+    [[nodiscard]] DirectoryWalker::Backend walkerBackend() const { return walker_m.backend(); }
+
+    // Read the Guitar Pro header of new files while hashing (ScanBatch::song), so the
+    // import does not open them a second time. Off by default.
+    void setParseMetadata(bool parse) { parseMetadata_m = parse; }
+
 private:
+    void scanBuffered(const QStringList &paths, const ExtensionMatcher &filter);
+    void scanStreaming(const QStringList &paths, const ExtensionMatcher &filter);
+
+    [[nodiscard]] bool collectFiles(const QStringList &paths, const ExtensionMatcher &filter, ReviewStats &stats,
+                                    bool keepWalkOrder, const std::function<void (ScanBatch &&)> &collect);
+    [[nodiscard]] bool scanSerial(const QStringList &paths, const ExtensionMatcher &filter, ReviewStats &stats,
+                                  const std::function<void (ScanBatch &&)> &collect);
+    [[nodiscard]] bool scanParallel(const QStringList &paths, const ExtensionMatcher &filter, ReviewStats &stats,
+                                    bool keepWalkOrder, const std::function<void (ScanBatch &&)> &collect);
+    [[nodiscard]] ScanBatch hashFile(ScanBatch &&file);
+    [[nodiscard]] QList<quint64> fullHashes(const QStringList &filePaths);
+    [[nodiscard]] bool verifyCollisions(ScanRecords &files, HashGroupIndex &index);
+    [[nodiscard]] bool collidingFiles(const QStringList &paths, const ExtensionMatcher &filter,
+                                      const HashGroupIndex &readyCounts, const HashGroupIndex &readySizes,
+                                      QStringList &filePaths, QList<quint64> &samples);
+    [[nodiscard]] quint64 cachedHash(const QString &filePath, const ScanCacheEntry &current) const;
+    void emitScanCacheUpdates();
+
     std::atomic<bool> abort_m{false};
-    QSet<QString> existingHashes_m;
+    QSet<quint64> existingHashes_m; // Sampled hashes of the files in the database
+    ScanCache scanCache_m;
+    ScanCache freshCacheEntries_m; // Written by the hashing workers, taken by emitScanCacheUpdates()
+    QMutex freshCacheMutex_m;
     bool isScanning_m{false};
+    int workerCount_m{0};
+    int streamingBatchSize_m{0};
+    bool parseMetadata_m{false};
+    DirectoryWalker walker_m;
 };
 
 #endif
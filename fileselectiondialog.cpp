@@ -140,7 +140,7 @@ void FileSelectionDialog::showContextMenu(const QPoint &pos) {
     if (relPath.isEmpty()) return;
 
     // is managed
-    bool isManaged = (dbManager_m->getSetting("is_managed", QString("false")) == "true");
+    bool isManaged = dbManager_m->setting<bool>("is_managed");
     QString baseDir = isManaged ? dbManager_m->getManagedPath() : "";
     QString fullPath = QDir::cleanPath(isManaged ? baseDir + "/" + relPath : relPath);
 
@@ -0,0 +1,298 @@
+#include "filetransferengine.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+    constexpr size_t kChunkSize = 8 * 1024 * 1024; // Per system call; cancel is checked in between
+    constexpr size_t kBufferSize = 1024 * 1024;
+
+    // Closes the descriptor on every path out of copyFile()
+    class FileDescriptor {
+    public:
+        explicit FileDescriptor(int fd) : fd_m(fd) {}
+        ~FileDescriptor() { close(); }
+        FileDescriptor(const FileDescriptor &) = delete;
+        FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+        [[nodiscard]] int get() const { return fd_m; }
+        int close() {
+            const int result = fd_m >= 0 ? ::close(fd_m) : 0;
+            fd_m = -1;
+            return result;
+        }
+
+    private:
+        int fd_m;
+    };
+
+    enum class Outcome {
+        Done,
+        Unsupported, // Nothing was copied; the next method may be tried
+        Failed
+    };
+
+    // Errors of copy_file_range() and sendfile() for file systems or kernels that lack them
+    bool isUnsupported(int error) {
+        return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP || error == ETXTBSY;
+    }
+
+    /**
+     * @brief Calls step until it reports the end of the source (0).
+     *
+     * step copies at most its argument in bytes and returns like read(). errno is
+     * left set if the outcome is Failed.
+     */
+    template<typename Step>
+    Outcome copyChunks(Step step, const std::atomic<bool> *canceled, std::atomic<qint64> *bytes) {
+        bool copiedAny = false;
+        for (;;) {
+            if (canceled && *canceled) {
+                errno = ECANCELED;
+                return Outcome::Failed;
+            }
+
+            const ssize_t copied = step(kChunkSize);
+            if (copied == 0) return Outcome::Done;
+            if (copied < 0) {
+                if (errno == EINTR) continue;
+                return !copiedAny && isUnsupported(errno) ? Outcome::Unsupported : Outcome::Failed;
+            }
+
+            copiedAny = true;
+            if (bytes) *bytes += copied;
+        }
+    }
+
+    // read() into buffer, write() until all of it is out
+    ssize_t copyBuffered(int in, int out, QByteArray &buffer) {
+        ssize_t length;
+        do {
+            length = ::read(in, buffer.data(), buffer.size());
+        } while (length < 0 && errno == EINTR);
+        if (length <= 0) return length;
+
+        for (ssize_t written = 0; written < length;) {
+            const ssize_t result = ::write(out, buffer.constData() + written, length - written);
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            written += result;
+        }
+        return length;
+    }
+#endif
+}
+
+bool FileTransferEngine::run(const QList<Transfer> &transfers, const std::function<bool (const Result &)> &finished,
+                             const std::function<void (qint64 bytes)> &progress) {
+    bytes_m = 0;
+    busyNs_m = 0;
+    elapsedNs_m = -1;
+    timer_m.start();
+
+    const int workers = concurrency();
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+
+    // Shared with the copy threads
+    QMutex mutex;
+    QWaitCondition changed;
+    QList<Result> ended;
+    int running = 0;
+    qint64 bytesInFlight = 0;
+
+    qsizetype next = 0;
+    bool stopped = false;
+    qint64 lastProgressMs = 0;
+
+    for (;;) {
+        QList<Result> ready;
+        {
+            QMutexLocker locker(&mutex);
+            for (;;) {
+                // Start what the limits allow; one copy always runs, however large it is
+                while (!stopped && !(canceled_m && *canceled_m) && next < transfers.size() && running < workers
+                       && (running == 0 || bytesInFlight + transfers.at(next).size <= maxBytesInFlight_m)) {
+                    const qsizetype index = next++;
+                    const qint64 size = qMax<qint64>(0, transfers.at(index).size);
+                    ++running;
+                    bytesInFlight += size;
+
+                    pool.start([&, index, size]() {
+                        QElapsedTimer busy;
+                        busy.start();
+                        Result result = copyFile(transfers.at(index).source, transfers.at(index).target, canceled_m, &bytes_m);
+                        result.index = index;
+                        busyNs_m += busy.nsecsElapsed();
+
+                        QMutexLocker lock(&mutex);
+                        --running;
+                        bytesInFlight -= size;
+                        ended.append(std::move(result));
+                        changed.wakeOne();
+                    });
+                }
+
+                if (!ended.isEmpty() || running == 0) break;
+                if (!changed.wait(&mutex, kProgressIntervalMs) && progress) break; // Time for a progress report
+            }
+
+            ready.swap(ended);
+            if (ready.isEmpty() && running == 0) break;
+        }
+
+        for (const Result &result : std::as_const(ready)) {
+            if (!finished(result) || !result.success) {
+                stopped = true;
+            }
+        }
+
+        if (progress && timer_m.elapsed() - lastProgressMs >= kProgressIntervalMs) {
+            lastProgressMs = timer_m.elapsed();
+            progress(bytesTransferred());
+        }
+    }
+
+    pool.waitForDone();
+    elapsedNs_m = timer_m.nsecsElapsed();
+    return !stopped && next == transfers.size();
+}
+
+double FileTransferEngine::megabytesPerSecond() const {
+    const qint64 elapsedNs = elapsedNs_m >= 0 ? elapsedNs_m : (timer_m.isValid() ? timer_m.nsecsElapsed() : 0);
+    if (elapsedNs <= 0) return 0.0;
+    return double(bytesTransferred()) / (1024.0 * 1024.0) / (double(elapsedNs) / 1e9);
+}
+
+double FileTransferEngine::utilisation() const {
+    if (elapsedNs_m <= 0) return 0.0;
+    return qMin(1.0, double(busyNs_m.load(std::memory_order_relaxed)) / (double(elapsedNs_m) * concurrency()));
+}
+
+FileTransferEngine::Result FileTransferEngine::copyFile(const QString &source, const QString &target,
+                                                        const std::atomic<bool> *canceled, std::atomic<qint64> *bytes,
+                                                        Method firstMethod) {
+    Result result;
+
+#ifdef Q_OS_LINUX
+    const QByteArray targetPath = QFile::encodeName(target);
+    const QByteArray partialPath = QFile::encodeName(target + kPartialSuffix);
+    const auto fail = [&](const char *what, int error) {
+        result.error = QString("%1 error: %2 (%3)").arg(QString::fromLatin1(what), source,
+                                                        QString::fromLocal8Bit(std::strerror(error)));
+        return result;
+    };
+    if (canceled && *canceled) return fail("Copy", ECANCELED);
+
+    FileDescriptor in(::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC));
+    if (in.get() < 0) return fail("Open", errno);
+
+    struct stat info;
+    if (::fstat(in.get(), &info) != 0) return fail("Open", errno);
+
+    // Never overwrite, like QFile::copy()
+    if (::access(targetPath.constData(), F_OK) == 0) return fail("Copy", EEXIST);
+
+    // A partial file left by a crash is overwritten
+    FileDescriptor out(::open(partialPath.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & 0777));
+    if (out.get() < 0) return fail("Copy", errno);
+
+    const auto failAndRemove = [&](const char *what, int error) {
+        out.close();
+        ::unlink(partialPath.constData());
+        return fail(what, error);
+    };
+
+    Outcome outcome = Outcome::Unsupported;
+
+#ifdef FICLONE
+    // Fails with EXDEV, EOPNOTSUPP or EINVAL where extents cannot be shared; nothing is written then
+    if (firstMethod == Method::Reflink && ::ioctl(out.get(), FICLONE, in.get()) == 0) {
+        result.method = Method::Reflink;
+        if (bytes) *bytes += info.st_size;
+        outcome = Outcome::Done;
+    }
+#endif
+
+    if (outcome == Outcome::Unsupported && firstMethod <= Method::CopyFileRange) {
+        result.method = Method::CopyFileRange;
+        outcome = copyChunks([&](size_t length) {
+            return ::copy_file_range(in.get(), nullptr, out.get(), nullptr, length, 0);
+        }, canceled, bytes);
+    }
+
+    if (outcome == Outcome::Unsupported && firstMethod <= Method::Sendfile) {
+        result.method = Method::Sendfile;
+        outcome = copyChunks([&](size_t length) {
+            return ::sendfile(out.get(), in.get(), nullptr, length);
+        }, canceled, bytes);
+    }
+
+    if (outcome == Outcome::Unsupported) {
+        result.method = Method::Buffered;
+        QByteArray buffer(kBufferSize, Qt::Uninitialized);
+        outcome = copyChunks([&](size_t) {
+            return copyBuffered(in.get(), out.get(), buffer);
+        }, canceled, bytes);
+    }
+
+    if (outcome != Outcome::Done) {
+        return failAndRemove("Copy", errno);
+    }
+
+    // The mode given to open() was reduced by the umask
+    ::fchmod(out.get(), info.st_mode & 07777);
+    if (out.close() != 0) return failAndRemove("Copy", errno); // Delayed write errors (NFS, full disk)
+
+    // Publish the complete file; RENAME_NOREPLACE keeps a target that appeared meanwhile
+    if (::renameat2(AT_FDCWD, partialPath.constData(), AT_FDCWD, targetPath.constData(), RENAME_NOREPLACE) != 0) {
+        if (errno != EINVAL && errno != ENOSYS) return failAndRemove("Copy", errno);
+        if (::rename(partialPath.constData(), targetPath.constData()) != 0) return failAndRemove("Copy", errno);
+    }
+
+    result.success = true;
+#else
+    Q_UNUSED(firstMethod)
+    result.method = Method::Buffered;
+    const QString partial = target + kPartialSuffix;
+    QFile::remove(partial);
+    result.success = !(canceled && *canceled) && !QFile::exists(target) && QFile::copy(source, partial)
+                     && QFile::rename(partial, target);
+    if (!result.success) {
+        QFile::remove(partial);
+        result.error = "Copy error: " + source;
+    } else if (bytes) {
+        *bytes += QFile(target).size();
+    }
+#endif
+
+    return result;
+}
+
+QString FileTransferEngine::methodName(Method method) {
+    switch (method) {
+    case Method::Reflink: return QStringLiteral("reflink");
+    case Method::CopyFileRange: return QStringLiteral("copy_file_range");
+    case Method::Sendfile: return QStringLiteral("sendfile");
+    case Method::Buffered: return QStringLiteral("buffered");
+    }
+    return QString();
+}
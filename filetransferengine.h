@@ -0,0 +1,112 @@
+#ifndef FILETRANSFERENGINE_H
+#define FILETRANSFERENGINE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Copies many files at once with the cheapest method the file systems offer.
+ *
+ * Each file is copied by the first method that works for it:
+ * - Reflink: FICLONE shares the extents of the source (btrfs, XFS, bcachefs); O(1)
+ *   for any size, the data is only copied once either side is written to.
+ * - CopyFileRange: copy_file_range() copies inside the kernel, server side on NFS
+ *   and SMB, and across file systems since Linux 5.3.
+ * - Sendfile: sendfile() for kernels without copy_file_range().
+ * - Buffered: read()/write() with a 1 MiB buffer; QFile::copy() outside Linux.
+ *
+ * The data is written to <target>.sonarpart, which is renamed to the target when it is
+ * complete. After a crash a target is therefore either missing or whole, never half
+ * written; a left over partial file is overwritten by the next copy.
+ *
+ * run() keeps up to concurrency() copies running on a thread pool. A copy starts only
+ * while the bytes of the running copies stay below maxBytesInFlight(), so a few large
+ * videos do not compete with each other for the disk; a file larger than the limit
+ * runs alone.
+ */
+class FileTransferEngine {
+public:
+    enum class Method {
+        Reflink,
+        CopyFileRange,
+        Sendfile,
+        Buffered
+    };
+
+    struct Transfer {
+        QString source;
+        QString target; // Must not exist; its folder must
+        qint64 size{0}; // For the bytes-in-flight limit
+    };
+
+    struct Result {
+        qsizetype index{-1}; // Into the list given to run()
+        bool success{false};
+        Method method{Method::Buffered};
+        QString error;
+    };
+
+    // Parallel copies; 0 = kDefaultConcurrency
+    void setConcurrency(int transfers) { concurrency_m = qMax(0, transfers); }
+    [[nodiscard]] int concurrency() const { return concurrency_m > 0 ? concurrency_m : kDefaultConcurrency; }
+
+    void setMaxBytesInFlight(qint64 bytes) { maxBytesInFlight_m = qMax<qint64>(1, bytes); }
+    [[nodiscard]] qint64 maxBytesInFlight() const { return maxBytesInFlight_m; }
+
+    // Checked between chunks; a canceled copy fails and removes its partial target
+    void setCancelFlag(const std::atomic<bool> *canceled) { canceled_m = canceled; }
+
+    /**
+     * @brief Copies all transfers; returns when none is running anymore.
+     *
+     * finished is called on the calling thread for every copy that ended, in the order
+     * they end. Returning false from it starts no further copies; the running ones still
+     * end and are reported. progress, if set, is called on the calling thread about every
+     * kProgressIntervalMs with the bytes copied so far.
+     *
+     * @return false if finished returned false or a copy failed.
+     */
+    bool run(const QList<Transfer> &transfers, const std::function<bool (const Result &)> &finished,
+             const std::function<void (qint64 bytes)> &progress = nullptr);
+
+    // Of the last run(); a reflinked file counts with its full size
+    [[nodiscard]] qint64 bytesTransferred() const { return bytes_m.load(std::memory_order_relaxed); }
+    [[nodiscard]] double megabytesPerSecond() const;
+    // Share of the last run() the copy threads spent copying, 0..1
+    [[nodiscard]] double utilisation() const;
+
+    /**
+     * @brief Copies one file, trying the methods in the order listed above.
+     *
+     * Keeps the permission bits of the source. On failure the partial target is removed.
+     * bytes, if given, is increased while the data is copied. The methods before
+     * firstMethod are skipped (tests of the fallbacks).
+     */
+    [[nodiscard]] static Result copyFile(const QString &source, const QString &target,
+                                         const std::atomic<bool> *canceled = nullptr,
+                                         std::atomic<qint64> *bytes = nullptr,
+                                         Method firstMethod = Method::Reflink);
+
+    [[nodiscard]] static QString methodName(Method method);
+
+    static constexpr int kDefaultConcurrency = 4;
+    static constexpr qint64 kDefaultMaxBytesInFlight = 512LL * 1024 * 1024;
+    static constexpr int kProgressIntervalMs = 250;
+    static inline const QString kPartialSuffix = QStringLiteral(".sonarpart");
+
+private:
+    int concurrency_m{0};
+    qint64 maxBytesInFlight_m{kDefaultMaxBytesInFlight};
+    const std::atomic<bool> *canceled_m{nullptr};
+
+    std::atomic<qint64> bytes_m{0};
+    std::atomic<qint64> busyNs_m{0}; // Summed over the copy threads
+    QElapsedTimer timer_m;
+    qint64 elapsedNs_m{-1}; // Duration of the last run(); -1 while it runs
+};
+
+#endif // FILETRANSFERENGINE_H
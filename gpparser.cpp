@@ -515,3 +515,29 @@ GpParser::GPMetadata GpParser::parseMetadata(const QString &filePath)
 
     return meta;
 }
+
+std::optional<ImportSong> GpParser::parseSong(const QString &filePath)
+{
+    const GPMetadata meta = parseMetadata(filePath);
+    if (!meta.isValid)
+        return std::nullopt;
+
+    ImportSong song;
+    song.title = meta.title;
+    if (!meta.artist.isEmpty())
+        song.artist = meta.artist;
+    if (!meta.tuning.isEmpty())
+        song.tuning = meta.tuning;
+    if (meta.bpm > 300) {
+        qDebug() << "Wrong BPM Found File: " << filePath << " BPM: " << meta.bpm;
+        song.bpm = 0;
+    } else {
+        song.bpm = meta.bpm;
+    }
+    return song;
+}
+
+bool GpParser::isGuitarProSuffix(const QString &suffix)
+{
+    return suffix.startsWith("gp", Qt::CaseInsensitive);
+}
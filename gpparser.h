@@ -1,8 +1,12 @@
 #ifndef GPPARSER_H
 #define GPPARSER_H
 
+#include "sonarstructs.h"
+
 #include <QString>
 
+#include <optional>
+
 class GpParser
 {
 public:
@@ -32,6 +36,11 @@ public:
 
     [[nodiscard]] static GPMetadata parseMetadata(const QString &filePath);
 
+    // The fields SonarPractice keeps; std::nullopt if the file is no readable Guitar Pro file.
+    // The title is empty if the header has none.
+    [[nodiscard]] static std::optional<ImportSong> parseSong(const QString &filePath);
+    [[nodiscard]] static bool isGuitarProSuffix(const QString &suffix);
+
 private:
     [[nodiscard]] static QString readVersionString(QDataStream &in);
     [[nodiscard]] qint32 static scanBpm(QDataStream &in);
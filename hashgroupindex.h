@@ -0,0 +1,104 @@
+#ifndef HASHGROUPINDEX_H
+#define HASHGROUPINDEX_H
+
+#include "sonarstructs.h"
+
+#include <QList>
+
+#include <bit>
+#include <utility>
+
+/**
+ * @brief Counts FileHashes and hands out duplicate group ids (scanner phase 2/3).
+ *
+ * Open addressing with linear probing in one contiguous slot array: a lookup is a
+ * multiply, a shift and usually a single cache line, and inserting never allocates
+ * except when the table grows. Group ids are assigned in the order groupId() is
+ * first called for a hash, starting at 1.
+ *
+ * Entries are never removed; clear() only resets the count of a hash.
+ */
+class HashGroupIndex {
+public:
+    explicit HashGroupIndex(qsizetype expectedEntries = 0) { reserve(expectedEntries); }
+
+    void reserve(qsizetype expectedEntries) {
+        const qsizetype wanted = std::bit_ceil(static_cast<quint64>(qMax<qsizetype>(kMinCapacity, expectedEntries * 4 / 3 + 1)));
+        if (wanted > slots_m.size()) rehash(wanted);
+    }
+
+    // Increments the count of hash and returns the new count
+    int add(const FileHash &hash) {
+        if ((size_m + 1) * 4 > slots_m.size() * 3) rehash(slots_m.size() * 2);
+
+        Slot &slot = slots_m[find(hash)];
+        if (slot.count < 0) {
+            slot.key = hash;
+            slot.count = 0;
+            size_m++;
+        }
+        return ++slot.count;
+    }
+
+    [[nodiscard]] int count(const FileHash &hash) const {
+        const Slot &slot = slots_m.at(find(hash));
+        return slot.count > 0 ? slot.count : 0;
+    }
+
+    void clear(const FileHash &hash) {
+        Slot &slot = slots_m[find(hash)];
+        if (slot.count > 0) slot.count = 0;
+    }
+
+    // Group id of hash; the next free one if the hash has none yet. Only valid for added hashes.
+    [[nodiscard]] int groupId(const FileHash &hash) {
+        Slot &slot = slots_m[find(hash)];
+        Q_ASSERT(slot.count >= 0);
+        if (slot.groupId == 0) slot.groupId = ++groupCount_m;
+        return slot.groupId;
+    }
+
+    [[nodiscard]] qsizetype size() const { return size_m; }
+    [[nodiscard]] int groupCount() const { return groupCount_m; }
+
+private:
+    struct Slot {
+        FileHash key;
+        int count{-1}; // -1 = free slot
+        int groupId{0};
+    };
+
+    static constexpr qsizetype kMinCapacity = 16; // Power of two
+
+    // Slot holding hash, or the free slot where it belongs
+    [[nodiscard]] qsizetype find(const FileHash &hash) const {
+        const qsizetype mask = slots_m.size() - 1;
+        qsizetype i = indexOf(hash);
+        while (slots_m.at(i).count >= 0 && !(slots_m.at(i).key == hash)) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    // The sampled hash is already well mixed; Fibonacci hashing spreads the full hash in
+    // and takes the top bits, which also breaks up runs of nearby values
+    [[nodiscard]] qsizetype indexOf(const FileHash &hash) const {
+        const quint64 mixed = (hash.sample ^ std::rotl(hash.full, 29)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<qsizetype>(mixed >> shift_m);
+    }
+
+    void rehash(qsizetype capacity) {
+        QList<Slot> old = std::exchange(slots_m, QList<Slot>(capacity));
+        shift_m = 64 - std::countr_zero(static_cast<quint64>(capacity));
+        for (const Slot &slot : std::as_const(old)) {
+            if (slot.count >= 0) slots_m[find(slot.key)] = slot;
+        }
+    }
+
+    QList<Slot> slots_m;
+    qsizetype size_m{0};
+    int shift_m{64};
+    int groupCount_m{0};
+};
+
+#endif // HASHGROUPINDEX_H
@@ -4,6 +4,8 @@
 #include "sonarstructs.h"
 #include "uihelper.h"
 
+#include <QCloseEvent>
+#include <QDialogButtonBox>
 #include <QEvent>
 #include <QKeyEvent>
 #include <QLabel>
@@ -128,16 +130,16 @@ ImportDialog::ImportDialog(QWidget *parent) : QDialog(parent) {
     // Everything into the main layout of the page
     layout->addLayout(hTreeLayout);
 
-    auto *buttonBox = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
-    btnImport_m = buttonBox->button(QDialogButtonBox::Ok);
+    buttonBox_m = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    btnImport_m = buttonBox_m->button(QDialogButtonBox::Ok);
     if (btnImport_m) btnImport_m->setEnabled(false);
-    buttonBox->button(QDialogButtonBox::Ok)->setText(tr("Import"));
-    buttonBox->button(QDialogButtonBox::Cancel)->setText(tr("Cancel"));
+    buttonBox_m->button(QDialogButtonBox::Ok)->setText(tr("Import"));
+    buttonBox_m->button(QDialogButtonBox::Cancel)->setText(tr("Cancel"));
 
-    layout->addWidget(buttonBox);
+    layout->addWidget(buttonBox_m);
 
-    connect(buttonBox, &QDialogButtonBox::accepted, this, &ImportDialog::accept);
-    connect(buttonBox, &QDialogButtonBox::rejected, this, &ImportDialog::reject);
+    connect(buttonBox_m, &QDialogButtonBox::accepted, this, &ImportDialog::accept);
+    connect(buttonBox_m, &QDialogButtonBox::rejected, this, &ImportDialog::reject);
     connect(sourceModel_m, &QStandardItemModel::itemChanged, this, &ImportDialog::updateImportButtonState);
 
     if (!isConnectionsEstablished_m) {
@@ -156,8 +158,8 @@ void ImportDialog::setupTargetRoot() {
 
     // Get the information from the database / settings.
     dataBasePath_m = DatabaseManager::instance().getManagedPath();
-    isManaged_m = DatabaseManager::instance().getSetting("is_managed", QString("false")) == "true";
-    isMoved_m = DatabaseManager::instance().getSetting("is_moved", QString("false")) == "true";
+    isManaged_m = DatabaseManager::instance().setting<bool>("is_managed");
+    isMoved_m = DatabaseManager::instance().setting<bool>("is_moved");
 
     QString rootDisplay;
     if (isManaged_m) {
@@ -307,6 +309,17 @@ void ImportDialog::expandAllTree() {
 
 // block return by search line (don't delete this)
 bool ImportDialog::eventFilter(QObject *obj, QEvent *event) {
+    // Esc and the close button would hide the progress while the import still runs
+    if (obj == progress_m && processor_m) {
+        const bool escape = event->type() == QEvent::KeyPress
+                            && static_cast<QKeyEvent *>(event)->key() == Qt::Key_Escape;
+        if (escape || event->type() == QEvent::Close) {
+            event->ignore();
+            cancelImport();
+            return true;
+        }
+    }
+
     if (obj == searchLineEdit_m && event->type() == QEvent::KeyPress) {
         QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
 
@@ -553,6 +566,7 @@ QStandardItem* ImportDialog::deepCopyItem(QStandardItem* item) {
     QStandardItem* copy = item->clone();
     copy->setData(item->data(RoleFilePath), RoleFilePath);
     copy->setData(item->data(RoleFileHash), RoleFileHash);
+    copy->setData(item->data(RoleSong), RoleSong);
     copy->setData(item->data(RoleIsFolder), RoleIsFolder);
     copy->setData(item->data(RoleFileStatus), RoleFileStatus);
 
@@ -577,6 +591,7 @@ QStandardItem* ImportDialog::deepCopyItemForUnmap(QStandardItem* item) {
     QStandardItem* copy = item->clone();
     copy->setData(item->data(RoleFilePath), RoleFilePath);
     copy->setData(item->data(RoleFileHash), RoleFileHash);
+    copy->setData(item->data(RoleSong), RoleSong);
     copy->setData(item->data(RoleIsFolder), RoleIsFolder);
     copy->setData(item->data(RoleFileStatus), RoleFileStatus);
 
@@ -637,7 +652,9 @@ void ImportDialog::collectTasksFromModel(QStandardItem* parent, QString currentD
             ImportTask t;
             t.sourcePath = child->data(RoleFilePath).toString();
             t.itemName = child->text();
-            t.fileHash = child->data(RoleFileHash).toString();
+            t.fileHash = child->data(RoleFileHash).value<FileHash>();
+            if (child->data(RoleSong).isValid())
+                t.song = child->data(RoleSong).value<ImportSong>();
             t.fileSize = QFileInfo(t.sourcePath).size();
             t.fileSuffix = QFileInfo(t.sourcePath).suffix();
             t.categoryPath = currentDirPath; // The folder structure is contained within this.
@@ -654,6 +671,8 @@ void ImportDialog::collectTasksFromModel(QStandardItem* parent, QString currentD
 }
 
 void ImportDialog::accept() {
+    if (processor_m) return; // Import is running
+
     // 1. Check for remaining files
     int remaining = countFiles(sourceModel_m->invisibleRootItem());
     if (remaining > 0) {
@@ -673,22 +692,73 @@ void ImportDialog::accept() {
         return;
     }
 
-    QProgressDialog progress(tr("Files are being imported...."), tr("Cancel"), 0, tasks.size(), this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
+    buttonBox_m->setEnabled(false);
+
+    auto *progress = new QProgressDialog(tr("Files are being imported...."), tr("Cancel"), 0, tasks.size(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setAutoReset(false);
+    progress->setAutoClose(false);
+    progress->installEventFilter(this);
+    progress_m = progress;
+
+    // 5. Perform import in the background, the dialog only follows it.
+    // No parent: the job on the writer thread uses the processor until finished().
+    auto *processor = new ImportProcessor();
+    processor_m = processor;
+    connect(processor, &ImportProcessor::finished, processor, &QObject::deleteLater);
+    connect(processor, &ImportProcessor::progressUpdated, progress, &QProgressDialog::setValue);
+    connect(processor, &ImportProcessor::progressEta, progress, [progress, processor](qint64 remainingMs, double megabytesPerSecond) {
+        if (processor->wasCanceled()) return;
+        progress->setLabelText(tr("Files are being imported.... %1\n%2")
+                                   .arg(ImportProcessor::remainingText(remainingMs), ImportProcessor::rateText(megabytesPerSecond)));
+    });
+    // Connected after QProgressDialog's own cancel(), which hides the dialog
+    connect(progress, &QProgressDialog::canceled, this, &ImportDialog::cancelImport);
+
+    connect(processor, &ImportProcessor::finished, this, [this, processor, progress](bool success) {
+        processor_m = nullptr;
+        progress_m = nullptr;
+        progress->deleteLater();
+        buttonBox_m->setEnabled(true);
+
+        if (success) {
+            // If everything worked, close the dialog and report the result to MainWindow.
+            QDialog::accept();
+        } else if (!processor->wasCanceled()) {
+            QMessageBox::critical(this, tr("Error"), tr("The import process failed."));
+        }
+    });
 
-    // 5. Perform import
-    ImportProcessor processor;
-    connect(&processor, &ImportProcessor::progressUpdated, &progress, &QProgressDialog::setValue);
+    progress->show();
+    processor->start(tasks, dataBasePath_m, isManaged_m, isMoved_m);
+}
 
-    bool success = processor.executeImport(tasks, dataBasePath_m, isManaged_m, isMoved_m);
+void ImportDialog::reject() {
+    if (processor_m) {
+        cancelImport();
+        return;
+    }
+    QDialog::reject();
+}
 
-    if (success) {
-        // If everything worked, close the dialog and report the result to MainWindow.
-        QDialog::accept();
-    } else {
-        QMessageBox::critical(this, tr("Error"), tr("The import process failed."));
+void ImportDialog::closeEvent(QCloseEvent *event) {
+    if (processor_m) {
+        event->ignore();
+        cancelImport();
+        return;
     }
+    QDialog::closeEvent(event);
+}
+
+// The progress stays up while the import is undone; finished() closes it
+void ImportDialog::cancelImport() {
+    if (!processor_m) return;
+
+    processor_m->cancel();
+    progress_m->setLabelText(tr("Canceling the import..."));
+    if (auto *button = progress_m->findChild<QPushButton *>())
+        button->setEnabled(false); // Still emitting clicked(), so it is not removed here
+    progress_m->show();
 }
 
 int ImportDialog::countFiles(QStandardItem* item) {
@@ -708,18 +778,21 @@ int ImportDialog::countFiles(QStandardItem* item) {
     return count;
 }
 
-void ImportDialog::setImportData(const QList<ScanBatch>& batches) {
+void ImportDialog::setImportData(const ScanRecords& batches) {
     sourceModel_m->clear();
     sourceModel_m->setHorizontalHeaderLabels({tr("Source (verified)")});
 
-    QSet<QString> seenHashes;
+    QSet<FileHash> seenHashes;
 
-    for (const auto& batch : batches) {
-        if (batch.status == StatusDefect) continue;
+    for (qsizetype i = 0; i < batches.size(); ++i) {
+        if (batches.status(i) == StatusDefect) continue;
 
-        QStandardItem* fileItem = new QStandardItem(batch.info.fileName());
-        fileItem->setData(batch.info.absoluteFilePath(), RoleFilePath);
-        fileItem->setData(batch.hash, RoleFileHash);
+        const ScanBatch batch = batches.at(i);
+        QStandardItem* fileItem = new QStandardItem(batch.fileName);
+        fileItem->setData(batch.filePath(), RoleFilePath);
+        fileItem->setData(QVariant::fromValue(batch.hash), RoleFileHash);
+        if (batch.song)
+            fileItem->setData(QVariant::fromValue(*batch.song), RoleSong);
         fileItem->setData(batch.status, RoleFileStatus);
         fileItem->setData(false, RoleIsFolder);
 
@@ -746,7 +819,7 @@ void ImportDialog::setImportData(const QList<ScanBatch>& batches) {
             fileItem->setCheckState(Qt::Checked);
         }
 
-        QStandardItem* parent = reconstructPathInSource(batch.info.path());
+        QStandardItem* parent = reconstructPathInSource(batch.directory);
         parent->appendRow(fileItem);
     }
     sourceView_m->expandAll();
@@ -790,7 +863,7 @@ void ImportDialog::handleItemChanged(QStandardItem *item) {
     if (item->data(RoleFileStatus).toInt() == StatusDuplicate) {
 
         if (item->checkState() == Qt::Checked) {
-            QString hash = item->data(RoleFileHash).toString();
+            FileHash hash = item->data(RoleFileHash).value<FileHash>();
             QList<QStandardItem*> allDups;
             collectItemsByHashRecursive(sourceModel_m->invisibleRootItem(), hash, allDups);
 
@@ -808,10 +881,10 @@ void ImportDialog::handleItemChanged(QStandardItem *item) {
     updateImportButtonState();
 }
 
-void ImportDialog::collectItemsByHashRecursive(QStandardItem* parent, const QString &hash, QList<QStandardItem*> &result) {
+void ImportDialog::collectItemsByHashRecursive(QStandardItem* parent, const FileHash &hash, QList<QStandardItem*> &result) {
     for (int i = 0; i < parent->rowCount(); ++i) {
         QStandardItem* child = parent->child(i);
-        if (child->data(RoleFileHash).toString() == hash) {
+        if (child->data(RoleFileHash).value<FileHash>() == hash) {
             result.append(child);
         }
         if (child->hasChildren()) {
@@ -839,7 +912,7 @@ void ImportDialog::showSourceMenu(const QPoint &pos) {
 
     menu.addSeparator();
     if (item->data(RoleFileStatus).toInt() == StatusDuplicate) {
-        QString currentHash = item->data(RoleFileHash).toString();
+        FileHash currentHash = item->data(RoleFileHash).value<FileHash>();
         QList<QStandardItem*> dups;
         collectItemsByHashRecursive(sourceModel_m->invisibleRootItem(), currentHash, dups);
 
@@ -870,7 +943,7 @@ void ImportDialog::showSourceMenu(const QPoint &pos) {
 void ImportDialog::activateItemExclusively(QStandardItem* targetItem) {
     if (!targetItem) return;
 
-    QString hash = targetItem->data(RoleFileHash).toString();
+    FileHash hash = targetItem->data(RoleFileHash).value<FileHash>();
     sourceModel_m->blockSignals(true);
 
     QList<QStandardItem*> allDups;
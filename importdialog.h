@@ -2,6 +2,7 @@
 #define IMPORTDIALOG_H
 
 #include "importprocessor.h"
+#include "scanrecords.h"
 #include "sonarstructs.h"
 
 #include <QTreeView>
@@ -11,14 +12,16 @@
 #include <QDialog>
 #include <QRadioButton>
 
+class QDialogButtonBox;
 class QLineEdit;
+class QProgressDialog;
 class QPushButton;
 
 class ImportDialog : public QDialog {
     Q_OBJECT
 public:
     explicit ImportDialog(QWidget *parent = nullptr);
-    void setImportData(const QList<ScanBatch>& batches);
+    void setImportData(const ScanRecords& batches);
 
 private:
     void setupTargetRoot();
@@ -29,6 +32,10 @@ private:
     void sideConnection();
     void collectTasksFromModel(QStandardItem* parent, QString currentDirPath, QList<ImportTask>& tasks);
     void accept() override;
+    // While an import runs, the dialog stays open; Cancel, Esc and closing cancel the import
+    void reject() override;
+    void closeEvent(QCloseEvent *event) override;
+    void cancelImport();
 
     [[nodiscard]] QStandardItem* deepCopyItem(QStandardItem* item);
     [[nodiscard]] QStandardItem* deepCopyItemForUnmap(QStandardItem* item);
@@ -36,7 +43,7 @@ private:
     [[nodiscard]] QStandardItem* reconstructPathInSource(const QString &fullPath);
     [[nodiscard]] int countFiles(QStandardItem* item);
 
-    void collectItemsByHashRecursive(QStandardItem* parent, const QString &hash, QList<QStandardItem*> &result);
+    void collectItemsByHashRecursive(QStandardItem* parent, const FileHash &hash, QList<QStandardItem*> &result);
 
     void updateImportButtonState();
     bool hasCheckedItems(QStandardItem* item);
@@ -56,6 +63,7 @@ private:
     QPushButton* btnUnmap_m;
     QPushButton* btnNewDir_m;
 
+    QDialogButtonBox* buttonBox_m;
     QPushButton* btnImport_m;
     QLineEdit* searchLineEdit_m;
     QPushButton* collabsTree_m;
@@ -70,6 +78,10 @@ private:
 
     bool isConnectionsEstablished_m{false};
 
+    // The running import; it deletes itself after finished(), the dialog may be gone by then
+    ImportProcessor* processor_m{nullptr};
+    QProgressDialog* progress_m{nullptr};
+
 private slots:
     bool eventFilter(QObject *obj, QEvent *event) override;
     void expandAllTree();
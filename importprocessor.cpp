@@ -0,0 +1,641 @@
+#include "importprocessor.h"
+#include "boundedqueue.h"
+#include "databasemanager.h"
+#include "filetransferengine.h"
+#include "gpparser.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThreadPool>
+
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+    // Copy stage -> parse stage
+    struct CopiedFile {
+        qsizetype index{-1}; // Into ImportJob::tasks
+        QString filePath;    // Where the file is now
+    };
+
+    // Parse stage -> write stage
+    struct ParsedSong {
+        qsizetype index{-1};
+        ImportSong song;
+    };
+
+    // The target was reserved by a run that died before it journaled the file operation
+    bool isReserved(const ImportJournalEntry &entry)
+    {
+        return entry.state == ImportState::Pending && !entry.targetPath.isEmpty();
+    }
+}
+
+struct ImportProcessor::Pipeline {
+    explicit Pipeline(const ImportJob &importJob) : job(importJob) {}
+
+    // Stops all stages; queued items are dropped. The first message is kept.
+    void abort(const QString &message) {
+        {
+            QMutexLocker locker(&mutex);
+            if (error.isEmpty())
+                error = message;
+        }
+        aborted = true;
+        copied.close();
+        parsed.close();
+    }
+
+    [[nodiscard]] QString firstError() {
+        QMutexLocker locker(&mutex);
+        return error;
+    }
+
+    const ImportJob &job;
+    QList<qsizetype> pending; // Tasks not committed yet, in task order
+    BoundedQueue<CopiedFile> copied{kQueueCapacity};
+    BoundedQueue<ParsedSong> parsed{kQueueCapacity};
+    std::atomic<bool> aborted{false};
+    std::atomic<int> activeParsers{kParserThreads};
+
+    std::atomic<double> megabytesPerSecond{0.0};
+    std::atomic<qint64> parseNs{0};
+    qint64 writeNs{0};            // Write stage only
+    double copyUtilisation{0.0};  // Set by the copy stage before it ends
+
+    QMutex mutex;
+    QString error;
+};
+
+void ImportProcessor::start(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved)
+{
+    run([this, tasks, basePath, isManaged, isMoved]() {
+        return executeImport(tasks, basePath, isManaged, isMoved);
+    });
+}
+
+void ImportProcessor::resume(qlonglong jobId)
+{
+    run([this, jobId]() { return executeResume(jobId); });
+}
+
+void ImportProcessor::discard(qlonglong jobId)
+{
+    run([this, jobId]() { return executeDiscard(jobId); });
+}
+
+void ImportProcessor::run(std::function<bool ()> import)
+{
+    canceled_m = false;
+
+    DatabaseManager::instance()
+        .enqueueWrite(std::move(import))
+        .then(this, [this](bool success) {
+            // The import added artists and tunings on the writer connection
+            DatabaseManager::instance().reloadNameDictionaries();
+            emit finished(success);
+        });
+}
+
+bool ImportProcessor::executeImport(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved)
+{
+    // Recorded before the first file is touched, so a crash from here on can be resumed
+    const qlonglong jobId = DatabaseManager::instance().createImportJob(tasks, basePath, isManaged, isMoved);
+    if (jobId == 0) {
+        qCritical() << "[ImportProcessor] the import could not be recorded in the import journal";
+        emit error(tr("The import could not be started."));
+        return false;
+    }
+
+    ImportJob job{jobId, basePath, isManaged, isMoved, tasks, {}};
+    job.entries.reserve(tasks.size());
+    for (qsizetype i = 0; i < tasks.size(); ++i) {
+        ImportJournalEntry entry;
+        entry.task = i;
+        job.entries.append(entry);
+    }
+    return runJob(job);
+}
+
+bool ImportProcessor::executeResume(qlonglong jobId)
+{
+    const std::optional<ImportJob> job = DatabaseManager::instance().loadImportJob(jobId);
+    if (!job) {
+        emit error(tr("The interrupted import could not be read."));
+        return false;
+    }
+    return runJob(*job);
+}
+
+bool ImportProcessor::executeDiscard(qlonglong jobId)
+{
+    if (!undoJob(jobId)) {
+        emit error(tr("The interrupted import could not be undone."));
+        return false;
+    }
+    emit dataChanged();
+    return true;
+}
+
+/**
+ * @brief Runs the pipeline for the tasks of job that are not committed yet.
+ *
+ * The settings are written in the first checkpoint, so the songs of a resumed job find
+ * the managed folder even if the application dies again. The job is removed from the
+ * journal in the last one.
+ */
+bool ImportProcessor::runJob(const ImportJob &job)
+{
+    auto &db = DatabaseManager::instance();
+
+    {
+        QMutexLocker locker(&fileOperationsMutex_m);
+        fileOperations_m.clear();
+    }
+    journaledOperations_m = 0;
+    utilisation_m = {};
+
+    Pipeline pipeline(job);
+    for (const ImportJournalEntry &entry : job.entries) {
+        if (entry.state != ImportState::Committed)
+            pipeline.pending.append(entry.task);
+    }
+
+    if (job.isManaged && !reserveTargets(pipeline)) {
+        return fail(job.id, tr("The import could not be started."));
+    }
+
+    if (!db.beginTransaction()) {
+        qCritical() << "[ImportProcessor] could not start the first checkpoint of import" << job.id;
+        emit error(tr("The import could not be started."));
+        return false;
+    }
+
+    // --- Settings ---
+
+    if (job.isManaged) {
+
+        if (!db.setSetting("is_managed", QVariant(job.isManaged))) {
+            qCritical() << "CRITICAL: is_managed could not be saved to DB:" << job.isManaged;
+        }
+
+        if (!db.setSetting("managed_path", QVariant(job.basePath))) {
+            qCritical() << "CRITICAL: managed_path could not be saved to DB:" << job.basePath;
+        }
+    }
+
+    if(job.isMoved) {
+        if (!db.setSetting("is_moved", QVariant(job.isMoved))) {
+            qCritical() << "CRITICAL: is_moved could not be saved to DB:" << job.isMoved;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(kParserThreads + 1);
+    pool.start([&]() { copyStage(pipeline); });
+    for (int i = 0; i < kParserThreads; ++i) {
+        pool.start([&]() { parseStage(pipeline); });
+    }
+
+    // The write stage runs here, it needs the connection of this thread
+    const bool written = writeStage(pipeline);
+    pool.waitForDone(); // fileOperations_m is complete from here on
+
+    const double wallNs = qMax<double>(1.0, double(timer.nsecsElapsed()));
+    utilisation_m.copy = pipeline.copyUtilisation;
+    utilisation_m.parse = qMin(1.0, double(pipeline.parseNs) / (wallNs * kParserThreads));
+    utilisation_m.write = qMin(1.0, double(pipeline.writeNs) / wallNs);
+    qDebug() << "[ImportProcessor] stage utilisation: copy" << utilisation_m.copy
+             << "parse" << utilisation_m.parse << "write" << utilisation_m.write;
+
+    if (canceled_m) {
+        return fail(job.id, tr("The import was canceled."));
+    }
+    if (!written) {
+        return fail(job.id, pipeline.firstError());
+    }
+
+    if (!db.setSetting("last_import_date", QVariant(QDateTime::currentDateTime().toString(Qt::ISODate)))) {
+        qCritical() << "CRITICAL: last_import_date could not be saved to DB:" << QDateTime::currentDateTime().toString(Qt::ISODate);
+    }
+
+    if (!db.removeImportJob(job.id, false) || !db.commit()) {
+        return fail(job.id, tr("The import could not be committed."));
+    }
+
+    {
+        QMutexLocker locker(&fileOperationsMutex_m);
+        fileOperations_m.clear();
+    }
+    emit dataChanged();
+    return true;
+}
+
+QString ImportProcessor::remainingText(qint64 remainingMs)
+{
+    if (remainingMs < 0)
+        return QString();
+
+    const qint64 seconds = (remainingMs + 999) / 1000;
+    if (seconds < 60)
+        return tr("about %1 s left").arg(seconds);
+    if (seconds < 3600)
+        return tr("about %1 min left").arg((seconds + 59) / 60);
+    return tr("about %1 h %2 min left").arg(seconds / 3600).arg((seconds % 3600) / 60);
+}
+
+QString ImportProcessor::rateText(double megabytesPerSecond)
+{
+    if (megabytesPerSecond <= 0.0)
+        return QString();
+    return tr("%1 MB/s").arg(megabytesPerSecond, 0, 'f', 1);
+}
+
+/**
+ * @brief Journals the targets of the pending tasks that do not exist yet.
+ *
+ * Committed before the copy stage starts, so the journal knows every file this job may
+ * create. An existing target without a reservation was there before the import; it is
+ * never adopted or removed.
+ */
+bool ImportProcessor::reserveTargets(const Pipeline &pipeline)
+{
+    auto &db = DatabaseManager::instance();
+    const ImportJob &job = pipeline.job;
+
+    QList<ImportJournalEntry> entries;
+    for (const qsizetype i : pipeline.pending) {
+        const ImportJournalEntry &entry = job.entries.at(i);
+        if (entry.operation != ImportFileOperation::None || isReserved(entry))
+            continue;
+
+        const QString target = QDir::cleanPath(QDir(job.basePath).absoluteFilePath(job.tasks.at(i).relativePath));
+        if (!QFile::exists(target))
+            entries.append({i, ImportState::Pending, target, ImportFileOperation::None, 0});
+    }
+    if (entries.isEmpty())
+        return true;
+
+    if (!db.beginTransaction())
+        return false;
+    if (!db.updateImportJournal(job.id, entries) || !db.commit()) {
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stage 1: puts the files into the managed folder and hands them to the parsers.
+ *
+ * Files that need no copy (unmanaged imports, targets that exist, renames) are handed on
+ * at once; the others are copied by a FileTransferEngine afterwards. A full queue blocks
+ * the engine's report, so no further copies start until the parsers caught up.
+ *
+ * An existing target that an earlier run of the job reserved was put there by that run
+ * after its last checkpoint; it is recorded as this run's file operation, so a discard
+ * or failure removes it again.
+ */
+void ImportProcessor::copyStage(Pipeline &pipeline)
+{
+    const ImportJob &job = pipeline.job;
+    QList<FileTransferEngine::Transfer> transfers;
+    QList<qsizetype> transferTasks; // Task of each transfer
+
+    for (const qsizetype i : std::as_const(pipeline.pending)) {
+        if (pipeline.aborted || canceled_m)
+            break;
+
+        const ImportTask &task = job.tasks.at(i);
+        if (!job.isManaged) {
+            if (!pipeline.copied.push({i, QDir::cleanPath(task.sourcePath)}))
+                break;
+            continue;
+        }
+
+        const QString finalDest = QDir::cleanPath(QDir(job.basePath).absoluteFilePath(task.relativePath));
+
+        // Create target directory
+        QDir().mkpath(QFileInfo(finalDest).absolutePath());
+        QFile::remove(finalDest + FileTransferEngine::kPartialSuffix); // Left by a copy a crash interrupted
+
+        // Existed before, or was put there by an earlier run of a resumed import
+        if (QFile::exists(finalDest)) {
+            if (isReserved(job.entries.at(i))) {
+                // In move mode the run may have died between the copy and removing the source
+                if (job.isMoved && QFile::exists(task.sourcePath) && !QFile::remove(task.sourcePath)) {
+                    recordFileOperation({i, task.sourcePath, finalDest, false});
+                    pipeline.abort("Remove error after copy: " + task.sourcePath);
+                    break;
+                }
+                recordFileOperation({i, task.sourcePath, finalDest, job.isMoved});
+            }
+            if (!pipeline.copied.push({i, finalDest}))
+                break;
+            continue;
+        }
+
+        // Try moving it (faster and saves space); across drives it is copied and removed below
+        if (job.isMoved && QFile::rename(task.sourcePath, finalDest)) {
+            recordFileOperation({i, task.sourcePath, finalDest, true});
+            if (!pipeline.copied.push({i, finalDest}))
+                break;
+            continue;
+        }
+
+        transfers.append({task.sourcePath, finalDest, task.fileSize});
+        transferTasks.append(i);
+    }
+
+    if (!transfers.isEmpty() && !pipeline.aborted && !canceled_m) {
+        FileTransferEngine engine;
+        engine.setCancelFlag(&canceled_m);
+
+        engine.run(transfers, [&](const FileTransferEngine::Result &result) {
+            if (!result.success) {
+                pipeline.abort(result.error);
+                return false;
+            }
+
+            const qsizetype index = transferTasks.at(result.index);
+            const ImportTask &task = job.tasks.at(index);
+            const QString &target = transfers.at(result.index).target;
+
+            if (job.isMoved && !QFile::remove(task.sourcePath)) {
+                recordFileOperation({index, task.sourcePath, target, false}); // The source is still there
+                pipeline.abort("Remove error after copy: " + task.sourcePath);
+                return false;
+            }
+            recordFileOperation({index, task.sourcePath, target, job.isMoved});
+
+            pipeline.megabytesPerSecond = engine.megabytesPerSecond();
+            return pipeline.copied.push({index, target}); // false once another stage aborted
+        }, [&](qint64) {
+            pipeline.megabytesPerSecond = engine.megabytesPerSecond();
+        });
+
+        pipeline.copyUtilisation = engine.utilisation();
+    }
+
+    pipeline.copied.close();
+}
+
+// Stage 2: reads the GP metadata of the files in place; the last parser closes the queue
+void ImportProcessor::parseStage(Pipeline &pipeline)
+{
+    CopiedFile file;
+    QElapsedTimer busy;
+    while (!pipeline.aborted && pipeline.copied.pop(file)) {
+        busy.start();
+        ParsedSong parsed{file.index, {}};
+        try {
+            parsed.song = readSong(pipeline.job.tasks.at(file.index), file.filePath);
+        } catch (const std::exception &e) {
+            pipeline.abort(QString::fromStdString(e.what()));
+            break;
+        }
+        pipeline.parseNs += busy.nsecsElapsed();
+
+        if (!pipeline.parsed.push(std::move(parsed)))
+            break;
+    }
+
+    if (pipeline.activeParsers.fetch_sub(1) == 1) {
+        pipeline.parsed.close();
+    }
+}
+
+/**
+ * @brief Stage 3: inserts the parsed songs in batches and reports the progress.
+ *
+ * A batch is written when it has kInsertBatchRows rows or kInsertBatchMs passed since
+ * the last one, so a slow copy does not hold back rows that are ready. Every batch is
+ * a checkpoint().
+ *
+ * @return false if the import was canceled or a stage failed; pipeline.firstError() says why.
+ */
+bool ImportProcessor::writeStage(Pipeline &pipeline)
+{
+    const ImportJob &job = pipeline.job;
+
+    // The ETA follows the bytes when files are copied, else the number of files
+    qint64 totalWork = 0;
+    for (const qsizetype i : std::as_const(pipeline.pending)) {
+        totalWork += job.isManaged ? job.tasks.at(i).fileSize : 1;
+    }
+    qint64 doneWork = 0;
+    qint64 lastEtaMs = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    int count = int(job.tasks.size() - pipeline.pending.size()); // Committed by an earlier run
+    QList<qsizetype> batch;
+    QList<ImportSong> batchSongs;
+    batch.reserve(kInsertBatchRows);
+    batchSongs.reserve(kInsertBatchRows);
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+
+    const auto flush = [&]() {
+        QElapsedTimer busy;
+        busy.start();
+        const bool committed = batch.isEmpty() || checkpoint(pipeline, batch, batchSongs);
+        pipeline.writeNs += busy.nsecsElapsed();
+
+        batch.clear();
+        batchSongs.clear();
+        sinceFlush.restart();
+        return committed;
+    };
+
+    ParsedSong parsed;
+    for (;;) {
+        if (canceled_m) {
+            pipeline.abort(tr("The import was canceled."));
+        }
+        if (pipeline.aborted) {
+            return false;
+        }
+
+        const auto status = pipeline.parsed.pop(parsed, QDeadlineTimer(qMax<qint64>(0, kInsertBatchMs - sinceFlush.elapsed())));
+        if (status == BoundedQueue<ParsedSong>::PopStatus::Closed)
+            break;
+
+        if (status == BoundedQueue<ParsedSong>::PopStatus::Item) {
+            batch.append(parsed.index);
+            batchSongs.append(std::move(parsed.song));
+            doneWork += job.isManaged ? job.tasks.at(parsed.index).fileSize : 1;
+
+            // --- Progress ---
+            emit progressUpdated(++count);
+        }
+
+        const qint64 elapsedMs = timer.elapsed();
+        if (elapsedMs - lastEtaMs >= kEtaIntervalMs) {
+            lastEtaMs = elapsedMs;
+            emit progressEta(doneWork > 0 ? qint64(double(elapsedMs) * (totalWork - doneWork) / doneWork) : -1,
+                             pipeline.megabytesPerSecond);
+        }
+
+        if ((batch.size() >= kInsertBatchRows || sinceFlush.elapsed() >= kInsertBatchMs) && !flush()) {
+            return false;
+        }
+    }
+
+    return !pipeline.aborted && flush();
+}
+
+/**
+ * @brief Inserts a batch and commits it together with its journal entries.
+ *
+ * The journal gets the batch as committed and the files put in place since the last
+ * checkpoint as copied; then the next checkpoint's transaction is started.
+ */
+bool ImportProcessor::checkpoint(Pipeline &pipeline, const QList<qsizetype> &batch, const QList<ImportSong> &songs)
+{
+    auto &db = DatabaseManager::instance();
+    const ImportJob &job = pipeline.job;
+
+    QList<ImportTask> tasks;
+    tasks.reserve(batch.size());
+    for (const qsizetype i : batch) {
+        tasks.append(job.tasks.at(i));
+    }
+
+    QList<qlonglong> songIds;
+    if (!db.bulkImport(tasks, songs, job.isManaged, &songIds)) {
+        pipeline.abort(tr("The songs could not be written to the database."));
+        return false;
+    }
+
+    QList<ImportJournalEntry> entries;
+    qsizetype operationsEnd = 0;
+    {
+        QMutexLocker locker(&fileOperationsMutex_m);
+        operationsEnd = fileOperations_m.size();
+        for (qsizetype i = journaledOperations_m; i < operationsEnd; ++i) {
+            const FileOperation &operation = fileOperations_m.at(i);
+            entries.append({operation.task, ImportState::Copied, operation.target,
+                            operation.moved ? ImportFileOperation::Moved : ImportFileOperation::Copied, 0});
+        }
+    }
+    for (qsizetype i = 0; i < batch.size(); ++i) {
+        entries.append({batch.at(i), ImportState::Committed, QString(), ImportFileOperation::None, songIds.at(i)});
+    }
+
+    if (!db.updateImportJournal(job.id, entries) || !db.commit()) {
+        pipeline.abort(tr("The import could not be committed."));
+        return false;
+    }
+    journaledOperations_m = operationsEnd;
+
+    if (!db.beginTransaction()) {
+        pipeline.abort(tr("The import could not be committed."));
+        return false;
+    }
+    return true;
+}
+
+ImportSong ImportProcessor::readSong(const ImportTask &task, const QString &filePath)
+{
+    // The scan read the header already; only parse if it is a GP file.
+    std::optional<ImportSong> parsed = task.song;
+    if (!parsed && GpParser::isGuitarProSuffix(task.fileSuffix)) {
+        parsed = GpParser::parseSong(QFileInfo(filePath).absoluteFilePath());
+    }
+
+    ImportSong song = parsed.value_or(ImportSong());
+    if (song.title.isEmpty())
+        song.title = task.itemName; // Fallback to filename
+    return song;
+}
+
+void ImportProcessor::recordFileOperation(const FileOperation &operation)
+{
+    QMutexLocker locker(&fileOperationsMutex_m);
+    fileOperations_m.append(operation);
+}
+
+void ImportProcessor::undoFileOperations()
+{
+    QMutexLocker locker(&fileOperationsMutex_m);
+    for (qsizetype i = fileOperations_m.size() - 1; i >= journaledOperations_m; --i) {
+        std::ignore = undoFile(fileOperations_m.at(i));
+    }
+    fileOperations_m.clear();
+    journaledOperations_m = 0;
+}
+
+bool ImportProcessor::undoFile(const FileOperation &operation)
+{
+    bool undone = false;
+    if (operation.moved) {
+        undone = QFile::rename(operation.target, operation.source)
+                 || (QFile::copy(operation.target, operation.source) && QFile::remove(operation.target));
+    } else {
+        undone = QFile::remove(operation.target);
+    }
+
+    if (!undone) {
+        qWarning() << "[ImportProcessor] could not undo the import of" << operation.source << "to" << operation.target;
+    }
+    return undone;
+}
+
+/**
+ * @brief Undoes what the journal of a job records and removes the job.
+ *
+ * Files are undone newest task first. For tasks still pending it also cleans up after a
+ * crash that came before their next checkpoint: a reserved target is removed with its
+ * partial copy, or moved back if its source is gone.
+ */
+bool ImportProcessor::undoJob(qlonglong jobId)
+{
+    auto &db = DatabaseManager::instance();
+    const std::optional<ImportJob> job = db.loadImportJob(jobId);
+    if (!job)
+        return false;
+
+    for (qsizetype i = job->entries.size() - 1; i >= 0; --i) {
+        const ImportJournalEntry &entry = job->entries.at(i);
+        const ImportTask &task = job->tasks.at(i);
+
+        if (entry.operation != ImportFileOperation::None) {
+            std::ignore = undoFile({i, task.sourcePath, entry.targetPath, entry.operation == ImportFileOperation::Moved});
+        } else if (job->isManaged && isReserved(entry)) {
+            QFile::remove(entry.targetPath + FileTransferEngine::kPartialSuffix);
+            if (QFile::exists(entry.targetPath)) {
+                const bool moved = job->isMoved && !QFile::exists(task.sourcePath);
+                std::ignore = undoFile({i, task.sourcePath, entry.targetPath, moved});
+            }
+        }
+    }
+
+    if (!db.beginTransaction())
+        return false;
+    if (!db.removeImportJob(jobId, true) || !db.commit()) {
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool ImportProcessor::fail(qlonglong jobId, const QString &message)
+{
+    qCritical() << "[ImportProcessor] import failed:" << message;
+    DatabaseManager::instance().rollback(); // The open checkpoint
+    undoFileOperations();                   // Those of the open checkpoint
+    if (!undoJob(jobId)) {
+        qWarning() << "[ImportProcessor] import" << jobId << "stays in the import journal, it is offered again on the next start";
+    }
+    emit error(message);
+    return false;
+}
@@ -1,171 +1,127 @@
 #ifndef IMPORTPROCESSOR_H
 #define IMPORTPROCESSOR_H
 
-#include "databasemanager.h"
-#include "gpparser.h"
-
-#include <QCoreApplication>
-#include <QDir>
-#include <qvariant.h>
-
-struct ImportTask {
-    QString sourcePath;     // Full source path (C:/...)
-    QString relativePath;   // Target path relative to the base directory (Ordner/Datei.gp5)
-    QString itemName;       // Display name/File name
-    qint64 fileSize;
-    QString fileSuffix;
-    QString categoryPath; // So that the processor knows where to go (e.g. "Exercises/Technique")
-    QString fileHash;     // For your duplicate check
-};
-
+#include "sonarstructs.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Imports ImportTasks: copies or moves the files into the managed folder, reads
+ * the GP metadata and writes songs and media files.
+ *
+ * The import is a pipeline of three stages connected by bounded queues, so copying,
+ * parsing and inserting overlap and a slow stage holds back the ones before it:
+ * - copy: moves within one file system are renames; all other files are copied by a
+ *   FileTransferEngine, several at once and with reflinks or in-kernel copies where the
+ *   file systems support them.
+ * - parse: kParserThreads threads read the GP metadata of the files already in place,
+ *   unless the scan read it already (ImportTask::song).
+ * - write: the thread running the import inserts the songs with bulkImport(), every
+ *   kInsertBatchRows rows or after kInsertBatchMs, whichever comes first.
+ * stageUtilisation() tells afterwards which stage was the bottleneck.
+ *
+ * Every import is recorded in the import journal of DatabaseManager before it starts.
+ * Each batch of the write stage is a checkpoint: its songs are committed together with
+ * the journal entries of the batch and of the files put in place since the last one.
+ * If the application dies during an import, the job stays in the journal; resume()
+ * continues it with the tasks not committed yet, discard() undoes it.
+ *
+ * start() runs the import as a job on the writer connection of DatabaseManager (its own
+ * thread and connection), so dialogs only observe it through the signals and the GUI
+ * thread never waits for the import. cancel() stops it before the next file.
+ *
+ * A failed or canceled import leaves nothing behind: the open checkpoint is rolled back,
+ * the songs of the committed ones are deleted and the file operations are undone
+ * (copies removed, moved files moved back).
+ *
+ * The processor must live until finished() was emitted.
+ */
 class ImportProcessor : public QObject {
     Q_OBJECT
 public:
     explicit ImportProcessor(QObject *parent = nullptr) : QObject(parent) {}
 
-    [[nodiscard]] bool executeImport(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved) {
-        if (!DatabaseManager::instance().beginTransaction()) {
-            qDebug() << "executeImport: instance false";
-            return false;
-        }
-
-        int count = 0;
-
-        QMap<QString, qlonglong> createdSongs;
-
-        for (const auto &task : tasks) {
-            count++;
-            try {
-                // --- File system operations ---
-                QString finalDest;
-                if (isManaged) {
-                    finalDest = QDir::cleanPath(QDir(basePath).absoluteFilePath(task.relativePath));
-
-                    // Create target directory
-                    QDir().mkpath(QFileInfo(finalDest).absolutePath());
-
-                    if (!QFile::exists(finalDest)) {
-                        if (isMoved) {
-                            // Try moving it (faster and saves space)
-                            if (!QFile::rename(task.sourcePath, finalDest)) {
-                                // If rename fails (e.g., different drive), copy + remove
-                                if (QFile::copy(task.sourcePath, finalDest)) {
-                                    if (!QFile::remove(task.sourcePath)) {
-                                        throw std::runtime_error("Remove error after copy: " + task.sourcePath.toStdString());
-                                    }
-                                } else {
-                                    throw std::runtime_error("Copy error: " + task.sourcePath.toStdString());
-                                }
-                            }
-                        } else {
-                            // Copy-only mode
-                            if (!QFile::copy(task.sourcePath, finalDest)) [[unlikely]] {
-                                throw std::runtime_error("Copy error: " + task.sourcePath.toStdString());
-                            }
-                        }
-                    }
-                    QCoreApplication::processEvents();
-                } else {
-                    finalDest = QDir::cleanPath(task.sourcePath);
-                }
-
-                emit progressUpdated(count);
-
-                // --- Progress ---
-                if (count % 20 == 0) {
-                    QCoreApplication::processEvents();
-                }
-
-                // --- Database logic (DRY & grouping) ---
-                QString fileName = QFileInfo(finalDest).fileName();
-                qlonglong songId;
-
-                QString title = task.itemName; // Fallback to filename
-                QString artist = "Unknown Artist";
-                QString tuning = "E-Standard";
-                int bpm = 0;
-
-                // Only parse if it is a GP file.
-                if (task.fileSuffix.startsWith("gp", Qt::CaseInsensitive)) {
-                    GpParser parser;
-                    GpParser::GPMetadata meta = parser.parseMetadata(QFileInfo(finalDest).absoluteFilePath());
-                    if (meta.isValid) {
-                        if (!meta.title.isEmpty())
-                            title = meta.title;
-                        if (!meta.artist.isEmpty())
-                            artist = meta.artist;
-                        if (!meta.tuning.isEmpty())
-                            tuning = meta.tuning;
-                        if (meta.bpm > 300) {
-                            qDebug() << "Wrong BPM Found File: " << task.itemName.toStdString()
-                                     << " BPM: " << meta.bpm;
-                            bpm = 0;
-                        } else {
-                            bpm = meta.bpm;
-                        }
-                    }
-                }
-
-                auto it = createdSongs.find(fileName);
-                if (it == createdSongs.end()) {
-                    // songId = DatabaseManager::instance().createSong(fileName);
-                    songId = DatabaseManager::instance().createSong(title, artist, tuning, bpm);
-                    if (songId == -1) throw std::runtime_error("DB Song Error");
-                    // createdSongs.insert(fileName, songId);
-                    bool ok = DatabaseManager::instance().addFileToSong(songId,
-                                                                        isManaged
-                                                                            ? task.relativePath
-                                                                            : finalDest,
-                                                                        isManaged,
-                                                                        task.fileSuffix,
-                                                                        task.fileSize,
-                                                                        task.fileHash);
-                    if (!ok) {
-                        qCritical() << "[ImportProcessor] executeImport failed for file: "
-                                    << task.itemName.toStdString();
-                    }
-                }
-
-            } catch (const std::exception &e) {
-                qDebug() << "Import failed:" << e.what();
-                DatabaseManager::instance().rollback();
-                return false;
-            }
-        }
-
-        // --- Settings ---
-        auto &db = DatabaseManager::instance();
-
-        if (isManaged) {
-
-            if (!db.setSetting("is_managed", QVariant(isManaged))) {
-                qCritical() << "CRITICAL: isManaged could not be saved to DB:" << isManaged;
-            }
-
-            if (!db.setSetting("managed_path", QVariant(basePath))) {
-                qCritical() << "CRITICAL: managed_path could not be saved to DB:" << basePath;
-            }
-        }
-
-        if(isMoved) {
-            if (!db.setSetting("is_moved", QVariant(isMoved))) {
-                qCritical() << "CRITICAL: isManaged could not be saved to DB:" << isManaged;
-            }
-        }
-
-        if (!db.setSetting("last_import_date", QVariant(QDateTime::currentDateTime().toString(Qt::ISODate)))) {
-            qCritical() << "CRITICAL: last_import_date could not be saved to DB:" << QDateTime::currentDateTime().toString(Qt::ISODate);
-        }
-
-        emit dataChanged();
-
-        return DatabaseManager::instance().commit();
-    }
+    // Return at once; finished() reports the result on the thread of the processor
+    void start(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved);
+    void resume(qlonglong jobId);  // An import interrupted by a crash (DatabaseManager::unfinishedImportJob())
+    void discard(qlonglong jobId); // Undoes it instead
+    void cancel() { canceled_m = true; } // Any thread
+    [[nodiscard]] bool wasCanceled() const { return canceled_m; }
+
+    // The import itself, on the connection of the calling thread
+    [[nodiscard]] bool executeImport(const QList<ImportTask> &tasks, const QString &basePath, bool isManaged, bool isMoved);
+    [[nodiscard]] bool executeResume(qlonglong jobId);
+    [[nodiscard]] bool executeDiscard(qlonglong jobId);
+
+    // "about 3 min left" for progressEta(); empty while unknown
+    [[nodiscard]] static QString remainingText(qint64 remainingMs);
+    // "120.5 MB/s" for progressEta(); empty while nothing is copied
+    [[nodiscard]] static QString rateText(double megabytesPerSecond);
+
+    // Share of the last import each stage spent working, 0..1 (busy time / (wall time × threads))
+    struct StageUtilisation {
+        double copy{0.0};
+        double parse{0.0};
+        double write{0.0};
+    };
+    [[nodiscard]] StageUtilisation stageUtilisation() const { return utilisation_m; }
 
 signals:
     void progressUpdated(int value);
+    // From the throughput so far; -1 = not known yet. megabytesPerSecond is the rate of
+    // all running copies together, 0 if the import copies nothing.
+    void progressEta(qint64 remainingMs, double megabytesPerSecond);
     void error(const QString &message);
     void dataChanged();
+    void finished(bool success);
+
+private:
+    // A file the import put into the managed folder
+    struct FileOperation {
+        qsizetype task{-1}; // Index into ImportJob::tasks
+        QString source;
+        QString target;
+        bool moved{false};
+    };
+
+    struct Pipeline; // Queues and state shared by the stages
+
+    // Starts one of the execute functions on the writer connection
+    void run(std::function<bool ()> import);
+    [[nodiscard]] bool runJob(const ImportJob &job);
+    [[nodiscard]] bool reserveTargets(const Pipeline &pipeline);
+
+    void copyStage(Pipeline &pipeline);
+    void parseStage(Pipeline &pipeline);
+    [[nodiscard]] bool writeStage(Pipeline &pipeline);
+    [[nodiscard]] bool checkpoint(Pipeline &pipeline, const QList<qsizetype> &batch, const QList<ImportSong> &songs);
+
+    [[nodiscard]] static ImportSong readSong(const ImportTask &task, const QString &filePath);
+    void recordFileOperation(const FileOperation &operation);
+    // Newest first, like a stack; journaled ones are undone by undoJob()
+    void undoFileOperations();
+    [[nodiscard]] static bool undoFile(const FileOperation &operation);
+    // Undoes the file operations and songs the journal of job records, and removes the job
+    [[nodiscard]] bool undoJob(qlonglong jobId);
+    [[nodiscard]] bool fail(qlonglong jobId, const QString &message);
+
+    static constexpr qint64 kEtaIntervalMs = 500;
+    static constexpr int kParserThreads = 2;
+    static constexpr qsizetype kQueueCapacity = 256; // Per queue; the backpressure between the stages
+    static constexpr qsizetype kInsertBatchRows = 500;
+    static constexpr qint64 kInsertBatchMs = 250;
+
+    std::atomic<bool> canceled_m{false};
+    QMutex fileOperationsMutex_m;          // The copy stage appends while the write stage journals
+    QList<FileOperation> fileOperations_m; // Done by the running import, newest last
+    qsizetype journaledOperations_m{0};    // fileOperations_m before this are in a committed checkpoint
+    StageUtilisation utilisation_m;
 };
 
 #endif // IMPORTPROCESSOR_H
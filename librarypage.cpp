@@ -24,8 +24,6 @@
 #include <QListWidgetItem>
 #include <QMenu>
 #include <QTimer>
-#include <QCoreApplication>
-#include <QProgressDialog>
 #include <QInputDialog>
 #include <QClipboard>
 #include <QGuiApplication>
@@ -36,6 +34,11 @@ LibraryPage::LibraryPage(QWidget *parent, DatabaseManager *dbManager)
     // UI initialize
     setupUI();
 
+    // Media catalog, streamed in by loadCatalogFromDatabase()
+    catalogWatcher_m = new QFutureWatcher<DatabaseManager::CatalogEntry>(this);
+    connect(catalogWatcher_m, &QFutureWatcherBase::resultsReadyAt, this, &LibraryPage::appendCatalogEntries);
+    connect(catalogWatcher_m, &QFutureWatcherBase::finished, this, &LibraryPage::onCatalogLoaded);
+
     // Place the master model on media_files
     QSqlDatabase db = QSqlDatabase::database();
 
@@ -205,65 +208,72 @@ void LibraryPage::onItemSelected(const QModelIndex &current)
     refreshRelatedFilesList();
 }
 
-// Fill catalog
+// Fill catalog; the entries arrive in chunks from the background connection
 void LibraryPage::loadCatalogFromDatabase()
 {
-    // Preparation: Pause UI updates for speed
-    catalogTreeView_m->setUpdatesEnabled(false);
+    catalogWatcher_m->cancel(); // A load still running is replaced
     catalogModel_m->clear();
     catalogModel_m->setHorizontalHeaderLabels({tr("Media catalog")});
 
-    // Execute query
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery query("SELECT id, file_path, song_id FROM media_files ORDER BY file_path ASC", db);
-
-    // Initialize the progress dialog
-    int totalFiles = 0;
-    if (query.last())
-    { // Jump to the end briefly to count the number
-        totalFiles = query.at() + 1;
-        query.first();    // Back to the beginning
-        query.previous(); // Preparation for the while(query.next()) loop
-    }
+    // Placeholder until the first entries are there
+    auto *placeholder = new QStandardItem(tr("Media catalog is loading..."));
+    placeholder->setEnabled(false);
+    catalogModel_m->appendRow(placeholder);
+    isCatalogPlaceholder_m = true;
 
-    QProgressDialog progress(tr("Media catalog is loading..."), tr("Cancel"), 0, totalFiles, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setMinimumDuration(500); // Only appears if it lasts longer than 0.5 seconds.
-    progress.setValue(0);
-
-    int count = 0;
-    while (query.next())
-    {
-        count++;
-        if (count % 100 == 0)
-        { // Update only every 100 items for better performance
-            progress.setValue(count);
-            QCoreApplication::processEvents(); // Important: To prevent the UI from freezing
-            if (progress.wasCanceled())
-                break;
-        }
+    catalogWatcher_m->setFuture(dbManager_m->getCatalogAsync());
+}
 
-        int id = query.value("id").toInt();
-        int sId = query.value("song_id").toInt();
-        QString path = query.value("file_path").toString();
+void LibraryPage::appendCatalogEntries(int begin, int end)
+{
+    removeCatalogPlaceholder();
+
+    const QIcon fileIcon = style()->standardIcon(QStyle::SP_FileIcon);
+    QList<QStandardItem *> items;
+    items.reserve(end - begin);
+
+    for (int i = begin; i < end; ++i) {
+        const DatabaseManager::CatalogEntry entry = catalogWatcher_m->resultAt(i);
+
+        QStandardItem *item = new QStandardItem(QFileInfo(entry.filePath).fileName());
+        item->setData(entry.fileId, LibraryPage::FileIdRole);
+        item->setData(entry.filePath, Qt::ToolTipRole);
+        item->setData(entry.filePath, LibraryPage::FilePathRole);
+        item->setData(entry.songId, LibraryPage::SongIdRole);
+        item->setIcon(fileIcon);
+        items.append(item);
+    }
 
-        QStandardItem *item = new QStandardItem(QFileInfo(path).fileName());
-        item->setData(id, LibraryPage::FileIdRole);
-        item->setData(path, Qt::ToolTipRole);
-        item->setData(path, LibraryPage::FilePathRole);
-        item->setData(sId, LibraryPage::SongIdRole);
-        item->setIcon(style()->standardIcon(QStyle::SP_FileIcon));
+    // One insertion per chunk instead of one per row
+    const int firstRow = catalogModel_m->rowCount();
+    catalogModel_m->invisibleRootItem()->appendRows(items);
 
-        catalogModel_m->appendRow(item);
+    // Rows arriving after a search was typed are filtered as well
+    const QString text = searchEdit_m->text();
+    if (!text.isEmpty()) {
+        for (int i = firstRow; i < catalogModel_m->rowCount(); ++i) {
+            bool match = catalogModel_m->item(i)->text().contains(text, Qt::CaseInsensitive);
+            catalogTreeView_m->setRowHidden(i, QModelIndex(), !match);
+        }
     }
+}
 
-    // Diploma
-    progress.setValue(totalFiles);
-    catalogTreeView_m->setUpdatesEnabled(true);
+void LibraryPage::onCatalogLoaded()
+{
+    removeCatalogPlaceholder(); // Empty catalog
 
     qDebug() << "[LibraryPage] Catalog loaded. Entries:" << catalogModel_m->rowCount();
 }
 
+void LibraryPage::removeCatalogPlaceholder()
+{
+    if (!isCatalogPlaceholder_m)
+        return;
+
+    catalogModel_m->removeRow(0);
+    isCatalogPlaceholder_m = false;
+}
+
 void LibraryPage::onAddRelationClicked()
 {
     // Retrieve the ID of the "master file" marked on the left in the catalog.
@@ -425,7 +435,7 @@ void LibraryPage::showCatalogContextMenu(const QPoint &pos)
     {
         QString fullPath = selectedIndexes.first().data(LibraryPage::FilePathRole).toString();
         qDebug() << "FullPath: " << fullPath;
-        if (dbManager_m->getSetting("is_managed", QString("false")) == "true")
+        if (dbManager_m->setting<bool>("is_managed"))
         {
             fullPath = dbManager_m->getManagedPath() + "/" + fullPath;
             qDebug() << "FullPath managed: " << fullPath;
@@ -447,7 +457,7 @@ void LibraryPage::handleRenameFile(const QModelIndex &index)
     int songId = index.data(LibraryPage::SongIdRole).toInt();
     QString oldRelPath = index.data(LibraryPage::FilePathRole).toString();
 
-    bool isManaged = (dbManager_m->getSetting("is_managed", QString("false")) == "true");
+    bool isManaged = dbManager_m->setting<bool>("is_managed");
     QString baseDir = isManaged ? dbManager_m->getManagedPath() : "";
     QString oldFullPath = QDir::cleanPath(isManaged ? baseDir + "/" + oldRelPath : oldRelPath);
 
@@ -506,7 +516,7 @@ void LibraryPage::handleDeleteFiles(const QModelIndexList &indexes)
     for (const QModelIndex &index : sortedIndexes)
     {
         QString path = index.data(LibraryPage::FilePathRole).toString();
-        if (dbManager_m->getSetting("is_managed", QString("false")) == "true")
+        if (dbManager_m->setting<bool>("is_managed"))
         {
             path = dbManager_m->getManagedPath() + "/" + path;
             qDebug() << "FullPath managed: " << path;
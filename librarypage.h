@@ -5,6 +5,7 @@
 #include "databasemanager.h"
 
 #include <QCheckBox>
+#include <QFutureWatcher>
 #include <QListWidget>
 #include <QStandardItemModel>
 #include <QTreeView>
@@ -44,6 +45,9 @@ private:
     void onRemoveRelationClicked();
     void refreshRelatedFilesList();
     void loadCatalogFromDatabase();
+    void appendCatalogEntries(int begin, int end);
+    void onCatalogLoaded();
+    void removeCatalogPlaceholder();
     void showCatalogContextMenu(const QPoint &pos);
     void handleRenameFile(const QModelIndex &index);
     void handleDeleteFiles(const QModelIndexList &indexes);
@@ -61,6 +65,7 @@ private:
     QTreeView* catalogTreeView_m;
 
     QStandardItemModel* catalogModel_m;
+    QFutureWatcher<DatabaseManager::CatalogEntry>* catalogWatcher_m;
 
     QWidget* detailWidget_m;
     QLabel* detailTitleLabel_m;
@@ -80,6 +85,7 @@ private:
     QCheckBox* expertModeCheck_m;
 
     bool isCatalogLoaded_m = false; // load media catalog only once
+    bool isCatalogPlaceholder_m = false; // "loading" row at the top of catalogModel_m
 
 protected:
     void showEvent(QShowEvent *event) override;
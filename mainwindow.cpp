@@ -4,8 +4,9 @@
 #include "sonarlessonpage.h"
 #include "sonarmenuhelper.h"
 #include "importdialog.h"
-#include "fnv1a.h"
+#include "samplehash.h"
 #include "filescanner.h"
+#include "importprocessor.h"
 
 #include <QMainWindow>
 #include <QGuiApplication>
@@ -21,6 +22,9 @@
 #include <QProgressDialog>
 #include <QThread>
 #include <QShortcut>
+#include <QMessageBox>
+#include <QTimer>
+#include <QFutureWatcher>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -104,6 +108,10 @@ MainWindow::MainWindow(QWidget *parent)
 
     QShortcut *shortcut = new QShortcut(QKeySequence(Qt::Key_F5), this);
     connect(shortcut, &QShortcut::activated, this, &MainWindow::reloadStyle);
+
+    // Once the window is shown; the writer runs the jobs in this order
+    QTimer::singleShot(0, this, &MainWindow::updateFileHashes);
+    QTimer::singleShot(0, this, &MainWindow::resumeUnfinishedImport);
 }
 
 MainWindow::~MainWindow() {}
@@ -119,6 +127,79 @@ void MainWindow::reloadStyle() {
     }
 }
 
+void MainWindow::updateFileHashes() {
+    // Only shown if it takes a while; the window stays usable
+    auto *progress = new QProgressDialog(tr("Updating the file hashes of the library..."), tr("Cancel"), 0, 0, this);
+    progress->setWindowModality(Qt::NonModal);
+    progress->setMinimumDuration(2000);
+    progress->setAutoReset(false);
+    progress->setAutoClose(false);
+
+    auto *watcher = new QFutureWatcher<int>(this);
+    connect(watcher, &QFutureWatcher<int>::progressRangeChanged, progress, &QProgressDialog::setRange);
+    connect(watcher, &QFutureWatcher<int>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcher<int>::cancel);
+
+    connect(watcher, &QFutureWatcher<int>::finished, this, [watcher, progress]() {
+        progress->deleteLater();
+        watcher->deleteLater();
+
+        if (watcher->future().resultCount() == 0) {
+            qWarning() << "[MainWindow] file hashes could not be updated";
+        } else if (const int unhashed = watcher->result(); unhashed > 0) {
+            qWarning() << "[MainWindow]" << unhashed << "media files have no hash, they are not recognised in imports";
+        }
+    });
+
+    watcher->setFuture(DatabaseManager::instance().rehashMediaFilesAsync());
+}
+
+void MainWindow::resumeUnfinishedImport() {
+    const qlonglong jobId = dbManager_m->unfinishedImportJob();
+    if (jobId == 0) return;
+
+    const std::optional<ImportJob> job = dbManager_m->loadImportJob(jobId);
+    const int files = job ? int(job->tasks.size()) : 0;
+
+    const auto answer = QMessageBox::question(
+        this, tr("Unfinished import"),
+        tr("The last import of %n file(s) was interrupted. Do you want to continue it?\n\n"
+           "If not, the files imported so far are removed from the library again.", nullptr, files),
+        QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+    const bool resume = answer == QMessageBox::Yes;
+
+    auto *progress = new QProgressDialog(resume ? tr("Files are being imported....") : tr("Undoing the import...."),
+                                         resume ? tr("Cancel") : QString(), 0, resume ? files : 0, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setAutoReset(false);
+    progress->show();
+
+    auto *processor = new ImportProcessor(this);
+    connect(processor, &ImportProcessor::progressUpdated, progress, &QProgressDialog::setValue);
+    connect(processor, &ImportProcessor::progressEta, progress, [progress](qint64 remainingMs, double megabytesPerSecond) {
+        progress->setLabelText(tr("Files are being imported.... %1\n%2")
+                                   .arg(ImportProcessor::remainingText(remainingMs), ImportProcessor::rateText(megabytesPerSecond)));
+    });
+    connect(progress, &QProgressDialog::canceled, processor, &ImportProcessor::cancel);
+
+    connect(processor, &ImportProcessor::finished, this, [this, processor, progress](bool success) {
+        progress->deleteLater();
+        processor->deleteLater();
+
+        if (success) {
+            emit dataChanged();
+        } else if (!processor->wasCanceled()) {
+            QMessageBox::critical(this, tr("Error"), tr("The import process failed."));
+        }
+    });
+
+    if (resume) {
+        processor->resume(jobId);
+    } else {
+        processor->discard(jobId);
+    }
+}
+
 // void MainWindow::reloadStyle() {
 //     QString diskPath = "C:/Users/smk/Develop/03_Projects/SonarPractice/styles/base.qss";
 
@@ -163,14 +244,14 @@ void MainWindow::onImportFileTriggered() {
         return;
     }
 
-    QSet<QString> dbHashes = dbManager_m->getAllFileHashes();
+    QSet<quint64> dbHashes = dbManager_m->getAllFileHashes();
 
-    QList<ScanBatch> batches;
+    ScanRecords batches;
+    batches.reserve(selectedFiles.size());
     for (const QString &filePath : std::as_const(selectedFiles)) {
-        ScanBatch batch;
-        batch.info = QFileInfo(filePath);
-        batch.hash = FNV1a::calculate(filePath);
-        if (!dbHashes.contains(batch.hash)) {
+        ScanBatch batch = ScanBatch::fromFileInfo(QFileInfo(filePath));
+        batch.hash.sample = SampleHash::calculate(filePath);
+        if (!dbHashes.contains(batch.hash.sample)) {
             batch.status = StatusReady;
         } else {
             batch.status = StatusAlreadyInDatabase;
@@ -197,10 +278,12 @@ void MainWindow::onImportDirectoryTriggered() {
     QProgressDialog *progress = new QProgressDialog(tr("Scanning and hashing files..."), tr("Cancel"), 0, 0, this);
     progress->setWindowModality(Qt::WindowModal);
 
-    QSet<QString> dbHashes = dbManager_m->getAllFileHashes();
+    QSet<quint64> dbHashes = dbManager_m->getAllFileHashes();
 
     FileScanner *scanner = new FileScanner();
     scanner->setExistingHashes(dbHashes);
+    scanner->setScanCache(dbManager_m->loadScanCache());
+    scanner->setParseMetadata(true); // The import does not open the tabs again
 
     QThread *thread = new QThread();
     scanner->moveToThread(thread);
@@ -210,11 +293,22 @@ void MainWindow::onImportDirectoryTriggered() {
 
     // ProgressDialog
     int totalFound = 0;
-    connect(scanner, &FileScanner::batchesFound, this, [progress, totalFound](const QList<ScanBatch>& batches) mutable {
+    connect(scanner, &FileScanner::batchesFound, this, [progress, totalFound](const ScanRecords& batches) mutable {
         totalFound += batches.size();
         progress->setLabelText(tr("%1 files processed...").arg(totalFound));
     });
 
+    // Remember the hashes, so the next import does not read unchanged files again
+    // Nothing waits for the scan cache until the next scan, so it is written in the background
+    connect(scanner, &FileScanner::scanCacheUpdated, this, [this](const ScanCache &entries) {
+        dbManager_m->enqueueWrite([db = dbManager_m, entries]() { return db->storeScanCache(entries); })
+            .then(this, [](bool stored) {
+                if (!stored) {
+                    qWarning() << "[MainWindow] scan cache could not be stored";
+                }
+            });
+    });
+
     // abort logic
     connect(progress, &QProgressDialog::canceled, this, [scanner, progress]() {
         scanner->abort();
@@ -223,7 +317,7 @@ void MainWindow::onImportDirectoryTriggered() {
         progress->setEnabled(false);
     });
 
-    connect(scanner, &FileScanner::finishWithAllBatches, this, [this, progress](const QList<ScanBatch>& all){
+    connect(scanner, &FileScanner::finishWithAllBatches, this, [this, progress](const ScanRecords& all){
         progress->close();
         progress->deleteLater();
 
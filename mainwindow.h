@@ -26,6 +26,10 @@ private:
 
 private slots:
     void reloadStyle();
+    // Offers to continue an import the application died in
+    void resumeUnfinishedImport();
+    // Hashes the media files that have no hash yet (after a hash algorithm change), in the background
+    void updateFileHashes();
 
 signals:
     void dataChanged();
@@ -212,6 +212,17 @@ void MappingPage::expandAllTree() {
 // block return by search line (don't delete this)
 bool MappingPage::eventFilter(QObject *obj, QEvent *event) {
     // qDebug() << "[ReviewPage] eventFilter START";
+    // Esc and the close button would hide the progress while the import still runs
+    if (obj == progress_m && processor_m) {
+        const bool escape = event->type() == QEvent::KeyPress
+                            && static_cast<QKeyEvent *>(event)->key() == Qt::Key_Escape;
+        if (escape || event->type() == QEvent::Close) {
+            event->ignore();
+            cancelImport();
+            return true;
+        }
+    }
+
     if (obj == searchLineEdit_m && event->type() == QEvent::KeyPress) {
         QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
 
@@ -257,6 +268,7 @@ void MappingPage::fillMappingSourceFromModel(QStandardItem* sourceParent, QStand
             QStandardItem* fileItem = new QStandardItem(sourceItem->icon(), sourceItem->text());
             fileItem->setData(sourceItem->data(RoleFilePath), RoleFilePath);
             fileItem->setData(sourceItem->data(RoleFileHash), RoleFileHash);
+            fileItem->setData(sourceItem->data(RoleSong), RoleSong);
             fileItem->setData(false, RoleIsFolder); // Es ist eine Datei
             targetParent->appendRow(fileItem);
         }
@@ -432,6 +444,7 @@ QStandardItem* MappingPage::deepCopyItem(QStandardItem* item) {
     // Clone all custom roles (clone() usually only copies standard roles)
     copy->setData(item->data(RoleFilePath), RoleFilePath);
     copy->setData(item->data(RoleFileHash), RoleFileHash);
+    copy->setData(item->data(RoleSong), RoleSong);
     copy->setData(item->data(RoleIsFolder), RoleIsFolder);
     copy->setData(item->data(RoleFileStatus), RoleFileStatus);
 
@@ -463,9 +476,11 @@ void MappingPage::cleanupEmptyFolders(QStandardItem *parent) {
 }
 
 // -------------
+// The import runs in the background: validatePage() starts it and returns false, the
+// finished() slot moves on (restart with the new database) or shows the error.
 bool MappingPage::validatePage() {
-    static bool isRestart = false;
-    if(isRestart) return true;
+    if (importDone_m) return true;
+    if (processor_m) return false; // Import is running
 
     int remaining = countFiles(sourceModel_m->invisibleRootItem());
 
@@ -481,18 +496,16 @@ bool MappingPage::validatePage() {
         }
     }
 
-    this->setEnabled(false);
-
     QString appDataDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
     QDir().mkpath(appDataDir);
 
     #ifdef QT_DEBUG
-        QString finalDbPath = appDataDir + "/sonar_practice_debug.db";
+        finalDbPath_m = appDataDir + "/sonar_practice_debug.db";
     #else
-        QString finalDbPath = appDataDir + "/sonar_practice.db";
+        finalDbPath_m = appDataDir + "/sonar_practice.db";
     #endif
 
-    QString tempDbPath = finalDbPath + ".tmp";
+    tempDbPath_m = finalDbPath_m + ".tmp";
 
     // Path for the music files (chosen by the user)
     QString musicBasePath = wiz()->field("cbTargetPath").toString();
@@ -509,50 +522,92 @@ bool MappingPage::validatePage() {
     }
 
     // Connection to temporary database & table creation
-    // initDatabase automatically calls createInitialTables() if version < 1
-    if (!DatabaseManager::instance().initDatabase(tempDbPath)) {
+    // initDatabase runs the schema migrations, a new database gets all tables
+    if (!DatabaseManager::instance().initDatabase(tempDbPath_m)) {
         QMessageBox::critical(this, "Error", "Database initialization failed.");
         return false;
     }
 
-    // Preparing for dialogue
-    QProgressDialog progress(tr("Import files..."), tr("Cancel"), 0, tasks.size(), this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
-
-    bool success = false;
-    {
-        // Open connection
-        if (!DatabaseManager::instance().initDatabase(tempDbPath)) return false;
+    // No navigation while the import runs; SetupWizard::reject() cancels it instead
+    setImportRunning(true);
+
+    auto *progress = new QProgressDialog(tr("Import files..."), tr("Cancel"), 0, tasks.size(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setAutoReset(false);
+    progress->setAutoClose(false);
+    progress->installEventFilter(this);
+    progress_m = progress;
+
+    // No parent: the job on the writer thread uses the processor until finished()
+    auto *processor = new ImportProcessor();
+    processor_m = processor;
+    connect(processor, &ImportProcessor::finished, processor, &QObject::deleteLater);
+    connect(processor, &ImportProcessor::progressUpdated, progress, &QProgressDialog::setValue);
+    connect(processor, &ImportProcessor::progressEta, progress, [progress, processor](qint64 remainingMs, double megabytesPerSecond) {
+        if (processor->wasCanceled()) return;
+        progress->setLabelText(tr("Import files... %1\n%2")
+                                   .arg(ImportProcessor::remainingText(remainingMs), ImportProcessor::rateText(megabytesPerSecond)));
+    });
+    // Connected after QProgressDialog's own cancel(), which hides the dialog
+    connect(progress, &QProgressDialog::canceled, this, &MappingPage::cancelImport);
+    connect(processor, &ImportProcessor::finished, this, [this, processor](bool success) {
+        finishImport(success, processor->wasCanceled());
+    });
 
-        // Create processor locally
-        ImportProcessor processor;
-        connect(&processor, &ImportProcessor::progressUpdated, &progress, &QProgressDialog::setValue);
+    progress->show();
+    processor->start(tasks, musicBasePath, isManaged, isMoved);
+    return false;
+}
 
-        // Carry out
-        success = processor.executeImport(tasks, musicBasePath, isManaged, isMoved);
-    }
+void MappingPage::finishImport(bool success, bool canceled) {
+    processor_m = nullptr;
+    progress_m->deleteLater();
+    progress_m = nullptr;
 
     if (success) {
+        // Keep the hashes of the review scan, a later import of the same folders is then much faster
+        if (!DatabaseManager::instance().storeScanCache(wiz()->scanCacheUpdates())) {
+            qWarning() << "[MappingPage] scan cache could not be stored";
+        }
+
         DatabaseManager::instance().closeDatabase();
 
-        if (QFile::exists(finalDbPath)) QFile::remove(finalDbPath);
+        if (QFile::exists(finalDbPath_m)) QFile::remove(finalDbPath_m);
 
-        if (QFile::rename(tempDbPath, finalDbPath)) {
-            if(!isRestart) {
-                isRestart = true;
-                wiz()->restartApp();
-            }
-            return true;
+        importDone_m = true;
+        if (QFile::rename(tempDbPath_m, finalDbPath_m)) {
+            wiz()->restartApp();
         }
-    } else {
-        DatabaseManager::instance().closeDatabase();
-        if (QFile::exists(tempDbPath)) QFile::remove(tempDbPath);
+        wizard()->accept();
+        return;
     }
 
-    // In case of an error, also close
     DatabaseManager::instance().closeDatabase();
-    return true;
+    if (QFile::exists(tempDbPath_m)) QFile::remove(tempDbPath_m);
+
+    // Stay on the page, the user can change the mapping and try again
+    setImportRunning(false);
+    if (!canceled) {
+        QMessageBox::critical(this, tr("Error"), tr("The import process failed."));
+    }
+}
+
+void MappingPage::setImportRunning(bool running) {
+    setEnabled(!running);
+    for (const QWizard::WizardButton button : {QWizard::BackButton, QWizard::FinishButton, QWizard::CancelButton}) {
+        if (QAbstractButton *widget = wizard()->button(button)) widget->setEnabled(!running);
+    }
+}
+
+// The progress stays up while the import is undone; finished() closes it
+void MappingPage::cancelImport() {
+    if (!processor_m) return;
+
+    processor_m->cancel();
+    progress_m->setLabelText(tr("Canceling the import..."));
+    if (auto *button = progress_m->findChild<QPushButton *>())
+        button->setEnabled(false); // Still emitting clicked(), so it is not removed here
+    progress_m->show();
 }
 
 void MappingPage::collectTasksFromModel(QStandardItem* parent, QString currentCategoryPath, QList<ImportTask>& tasks) {
@@ -585,7 +640,9 @@ void MappingPage::collectTasksFromModel(QStandardItem* parent, QString currentCa
             ImportTask t;
             t.sourcePath = child->data(RoleFilePath).toString();
             t.itemName = child->text();
-            t.fileHash = child->data(RoleFileHash).toString();
+            t.fileHash = child->data(RoleFileHash).value<FileHash>();
+            if (child->data(RoleSong).isValid())
+                t.song = child->data(RoleSong).value<ImportSong>();
             t.fileSize = QFileInfo(t.sourcePath).size();
             t.fileSuffix = QFileInfo(t.sourcePath).suffix();
             t.categoryPath = currentCategoryPath; // Hier steckt die Ordner-Struktur drin
@@ -594,7 +651,7 @@ void MappingPage::collectTasksFromModel(QStandardItem* parent, QString currentCa
 
             /* qDebug() << "[MappingPage] collectTasksFromModel t.sourcePath: " << t.sourcePath;
             qDebug() << "[MappingPage] collectTasksFromModel t.itemName: " << t.itemName;
-            qDebug() << "[MappingPage] collectTasksFromModel t.fileHash: " << t.fileHash;
+            qDebug() << "[MappingPage] collectTasksFromModel t.fileHash: " << t.fileHash.toString();
             qDebug() << "[MappingPage] collectTasksFromModel t.fileSize: " << t.fileSize;
             qDebug() << "[MappingPage] collectTasksFromModel t.fileSuffix: " << t.fileSuffix;
             qDebug() << "[MappingPage] collectTasksFromModel t.categoryPath: " << t.categoryPath;
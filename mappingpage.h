@@ -9,6 +9,7 @@
 #include <QCheckBox>
 
 class QLineEdit;
+class QProgressDialog;
 class QPushButton;
 
 class MappingPage : public BasePage {
@@ -16,6 +17,9 @@ class MappingPage : public BasePage {
 public:
     explicit MappingPage(QWidget *parent = nullptr);
     void initializePage() override;
+    void cancelImport();
+
+    [[nodiscard]] bool isImporting() const { return processor_m != nullptr; }
 
 private:
     // Model-Handling
@@ -29,6 +33,8 @@ private:
     [[nodiscard]] QStandardItem* reconstructPathInSource(const QString &fullPath);
     [[nodiscard]] bool validatePage() override;
     [[nodiscard]] int countFiles(QStandardItem* item);
+    void finishImport(bool success, bool canceled);
+    void setImportRunning(bool running);
 
     QTreeView* sourceView_m;
     QTreeView* targetView_m;
@@ -45,6 +51,13 @@ private:
 
     bool isConnectionsEstablished_m{false};
 
+    // Background import started by validatePage()
+    ImportProcessor* processor_m{nullptr};
+    QProgressDialog* progress_m{nullptr};
+    QString tempDbPath_m;
+    QString finalDbPath_m;
+    bool importDone_m{false};
+
 private slots:
     bool eventFilter(QObject *obj, QEvent *event) override;
     void expandAllTree();
@@ -0,0 +1,40 @@
+#include "namedictionary.h"
+
+#include <algorithm>
+
+void NameDictionary::load(const QHash<QString, int> &ids) {
+    ids_m = ids;
+    QStringList names = ids.keys();
+    std::sort(names.begin(), names.end());
+    model_m.setStringList(names);
+    loaded_m = true;
+}
+
+void NameDictionary::clear() {
+    ids_m.clear();
+    model_m.setStringList({});
+    loaded_m = false;
+}
+
+void NameDictionary::insert(const QString &name, int id) {
+    if (ids_m.contains(name)) return;
+
+    ids_m.insert(name, id);
+    const int at = row(name);
+    model_m.insertRows(at, 1);
+    model_m.setData(model_m.index(at), name);
+}
+
+void NameDictionary::rename(int id, const QString &newName) {
+    const QString oldName = ids_m.key(id);
+    if (oldName.isNull() || oldName == newName) return;
+
+    ids_m.remove(oldName);
+    model_m.removeRows(row(oldName), 1);
+    insert(newName, id);
+}
+
+int NameDictionary::row(const QString &name) const {
+    const QStringList names = model_m.stringList(); // Shared, no copy of the strings
+    return int(std::lower_bound(names.cbegin(), names.cend(), name) - names.cbegin());
+}
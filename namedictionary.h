@@ -0,0 +1,38 @@
+#ifndef NAMEDICTIONARY_H
+#define NAMEDICTIONARY_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringListModel>
+
+/**
+ * @brief In-memory copy of a name table (artists, tunings): name -> id, plus a sorted model.
+ *
+ * DatabaseManager loads it once per database and writes every insert and rename
+ * through to it, so lookups never reach SQLite. model() holds the names in the same
+ * order as "ORDER BY name" and can be set on a combo box or QCompleter directly;
+ * it stays valid for the lifetime of the dictionary and is updated in place.
+ */
+class NameDictionary {
+public:
+    [[nodiscard]] bool isLoaded() const { return loaded_m; }
+    void load(const QHash<QString, int> &ids);
+    void clear(); // Forgets the content, the next use loads it again
+
+    [[nodiscard]] int id(const QString &name) const { return ids_m.value(name, 0); } // 0 = unknown
+    void insert(const QString &name, int id);
+    void rename(int id, const QString &newName);
+
+    [[nodiscard]] QStringList names() const { return model_m.stringList(); }
+    [[nodiscard]] QStringListModel *model() { return &model_m; }
+
+private:
+    [[nodiscard]] int row(const QString &name) const; // Sorted insert position of name
+
+    QHash<QString, int> ids_m;
+    QStringListModel model_m;
+    bool loaded_m{false};
+};
+
+#endif // NAMEDICTIONARY_H
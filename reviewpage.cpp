@@ -222,7 +222,7 @@ void ReviewPage::showTreeContextMenu(const QPoint &pos, const QModelIndex &proxy
     QModelIndex sourceIndex = wiz()->proxyModel()->mapToSource(proxyIndex);
 
     QModelIndex nameIndex = sourceIndex.siblingAtColumn(ColName);
-    QString currentHash = nameIndex.data(RoleFileHash).toString();
+    FileHash currentHash = nameIndex.data(RoleFileHash).value<FileHash>();
     QString currentPath = nameIndex.data(RoleFilePath).toString();
 
     QMenu menu(this);
@@ -241,10 +241,10 @@ void ReviewPage::handleItemChanged(QStandardItem *item) {
 
     // 1. When a user selects a duplicate
     if (item->checkState() == Qt::Checked) {
-        QString hash = item->data(RoleFileHash).toString();
+        FileHash hash = item->data(RoleFileHash).value<FileHash>();
 
         // If it is indeed a duplicate (hash present and not empty)
-        if (!hash.isEmpty() && hash != "0") {
+        if (hash.isValid()) {
             QList<QStandardItem*> duplicates;
             auto *wiz = qobject_cast<SetupWizard*>(wizard());
             collectItemsByHashRecursive(wiz->filesModel()->invisibleRootItem(), hash, duplicates);
@@ -340,6 +340,7 @@ void ReviewPage::setupConnections() {
 
     // 3. Connect scanner signals (Qt::UniqueConnection prevents multiple connections)
     connect(wiz->fileScanner(), &FileScanner::batchesFound, wiz->fileManager(), &FileManager::addBatchesToModel, Qt::UniqueConnection);
+    connect(wiz->fileScanner(), &FileScanner::duplicateGroupsResolved, wiz->fileManager(), &FileManager::applyDuplicateGroups, Qt::UniqueConnection);
 
     connect(wiz->fileScanner(), &FileScanner::progressStats, this, [this](const ReviewStats &stats) {
         statusLabel_m->setText(tr("Scanning files: %1").arg(stats.totalFiles));
@@ -371,7 +372,7 @@ bool ReviewPage::isComplete() const {
     // Sync proxy
     wiz->proxyModel()->invalidate();
 
-    QMap<QString, int> selectionCounts;
+    QHash<FileHash, int> selectionCounts;
     int totalSelected = 0;
     bool collisionFound = false;
 
@@ -382,8 +383,8 @@ bool ReviewPage::isComplete() const {
 
             if (item->checkState() == Qt::Checked) {
                 totalSelected++;
-                QString hash = item->data(RoleFileHash).toString();
-                if (!hash.isEmpty() && hash != "0") {
+                FileHash hash = item->data(RoleFileHash).value<FileHash>();
+                if (hash.isValid()) {
                     selectionCounts[hash]++;
                     if (selectionCounts[hash] > 1) {
                         collisionFound = true;
@@ -495,7 +496,7 @@ void ReviewPage::applySmartCheck() {
     if (!wiz) return;
 
     QStandardItemModel* model = wiz->filesModel();
-    QSet<QString> seenHashes;
+    QSet<FileHash> seenHashes;
 
     // Block the signal to prevent handleItemChanged from running amok.
     model->blockSignals(true);
@@ -506,7 +507,7 @@ void ReviewPage::applySmartCheck() {
             QStandardItem* item = parent->child(i, ColName);
             if (!item) continue;
 
-            QString hash = item->data(RoleFileHash).toString();
+            FileHash hash = item->data(RoleFileHash).value<FileHash>();
             int status = item->data(RoleFileStatus).toInt();
 
             if (status == StatusDuplicate) {
@@ -530,7 +531,7 @@ void ReviewPage::applySmartCheck() {
     updateUIStats();
 }
 
-void ReviewPage::collectHashesRecursive(QStandardItem* parent, QStringList &hashes) {
+void ReviewPage::collectHashesRecursive(QStandardItem* parent, QList<FileHash> &hashes) {
     if (!parent) return;
 
     for (int i = 0; i < parent->rowCount(); ++i) {
@@ -539,8 +540,8 @@ void ReviewPage::collectHashesRecursive(QStandardItem* parent, QStringList &hash
 
         // If it is a file, it normally has no children (rowCount == 0)
         // But to be safe, check the hash again.
-        QString h = child->data(RoleFileHash).toString();
-        if (!h.isEmpty()) {
+        FileHash h = child->data(RoleFileHash).value<FileHash>();
+        if (h.isValid()) {
             hashes << h;
         }
 
@@ -682,8 +683,8 @@ void ReviewPage::onItemChanged(QStandardItem *item) {
 // =============================================================================
 
 void ReviewPage::addDuplicateSectionToMenu(QMenu *menu, const QModelIndex &nameIndex,
-                                           const QString &currentHash, const QString &currentPath) {
-    if (currentHash.isEmpty())  {
+                                           const FileHash &currentHash, const QString &currentPath) {
+    if (!currentHash.isValid())  {
         return;
     }
 
@@ -696,7 +697,7 @@ void ReviewPage::addDuplicateSectionToMenu(QMenu *menu, const QModelIndex &nameI
     menu->addSeparator();
 }
 
-void ReviewPage::addJumpToDuplicateActions(QMenu *jumpMenu, const QString &currentHash,
+void ReviewPage::addJumpToDuplicateActions(QMenu *jumpMenu, const FileHash &currentHash,
                                            const QString &currentPath) {
     QModelIndexList partners = findDuplicatePartners(currentHash);
     if (partners.isEmpty()) return;
@@ -712,11 +713,11 @@ void ReviewPage::addJumpToDuplicateActions(QMenu *jumpMenu, const QString &curre
 }
 
 
-QModelIndexList ReviewPage::findDuplicatePartners(const QString &hash) {
+QModelIndexList ReviewPage::findDuplicatePartners(const FileHash &hash) {
     return wiz()->filesModel()->match(
         wiz()->filesModel()->index(0, 0),
         RoleFileHash,
-        hash,
+        QVariant::fromValue(hash),
         -1,
         Qt::MatchExactly | Qt::MatchRecursive
         );
@@ -741,8 +742,8 @@ void ReviewPage::jumpToDuplicate(const QModelIndex &sourceIndex) {
     }
 }
 
-void ReviewPage::refreshDuplicateStatus(const QString &hash) {
-    if (hash.isEmpty()) return;
+void ReviewPage::refreshDuplicateStatus(const FileHash &hash) {
+    if (!hash.isValid()) return;
 
     QList<QStandardItem*> remainingItems;
     collectItemsByHashRecursive(wiz()->filesModel()->invisibleRootItem(), hash, remainingItems);
@@ -770,12 +771,12 @@ void ReviewPage::refreshDuplicateStatus(const QString &hash) {
     }
 }
 
-void ReviewPage::collectItemsByHashRecursive(QStandardItem* parent, const QString &hash, QList<QStandardItem*> &result) {
+void ReviewPage::collectItemsByHashRecursive(QStandardItem* parent, const FileHash &hash, QList<QStandardItem*> &result) {
     for (int i = 0; i < parent->rowCount(); ++i) {
         QStandardItem* child = parent->child(i, ColName);
         if (!child) continue;
 
-        if (child->data(RoleFileHash).toString() == hash) {
+        if (child->data(RoleFileHash).value<FileHash>() == hash) {
             result.append(child);
         }
 
@@ -810,7 +811,7 @@ void ReviewPage::discardItemFromModel(const QModelIndex &proxyIndex) {
 
     // --- execution ---
     // Collect hashes for status healing (optional, but recommended for accuracy)
-    QStringList affectedHashes;
+    QList<FileHash> affectedHashes;
     collectHashesRecursive(item, affectedHashes);
 
     // Remove from the model
@@ -821,7 +822,7 @@ void ReviewPage::discardItemFromModel(const QModelIndex &proxyIndex) {
     }
 
     // Status healing of the remaining duplicates
-    for (const QString &h : std::as_const(affectedHashes)) {
+    for (const FileHash &h : std::as_const(affectedHashes)) {
         refreshDuplicateStatus(h);
     }
     emit completeChanged();
@@ -837,7 +838,7 @@ void ReviewPage::deleteItemPhysically(const QModelIndex &proxyIndex) {
     QString rawPath = item->data(RoleFilePath).toString();
     QString cleanPath = QDir::cleanPath(rawPath);
 
-    QString fileHash = item->data(RoleFileHash).toString();
+    FileHash fileHash = item->data(RoleFileHash).value<FileHash>();
     QFileInfo fileInfo(cleanPath);
     bool isFolder = fileInfo.isDir();
 
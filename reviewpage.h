@@ -2,6 +2,8 @@
 #define REVIEWPAGE_H
 
 #include "basepage.h"
+#include "sonarstructs.h"
+
 #include <QProgressBar>
 
 // Forward Declarations (beschleunigt die Kompilierung)
@@ -30,10 +32,10 @@ private slots:
     void handleItemChanged(QStandardItem *item);
     void onFilterChanged();
     void showTreeContextMenu(const QPoint &pos, const QModelIndex &proxyIndex);
-    void addDuplicateSectionToMenu(QMenu *menu, const QModelIndex &nameIndex, const QString &currentHash, const QString &currentPath);
+    void addDuplicateSectionToMenu(QMenu *menu, const QModelIndex &nameIndex, const FileHash &currentHash, const QString &currentPath);
 
-    void addJumpToDuplicateActions(QMenu *jumpMenu, const QString &currentHash, const QString &currentPath);
-    [[nodiscard]] QModelIndexList findDuplicatePartners(const QString &hash);
+    void addJumpToDuplicateActions(QMenu *jumpMenu, const FileHash &currentHash, const QString &currentPath);
+    [[nodiscard]] QModelIndexList findDuplicatePartners(const FileHash &hash);
     void jumpToDuplicate(const QModelIndex &sourceIndex);
     void setCheckStateRecursive(QStandardItem* item, Qt::CheckState state);
 
@@ -50,8 +52,8 @@ private:
     void addFileActionsSectionToMenu(QMenu *menu, const QModelIndex &proxyIndex, const QString &currentPath);
 
     void discardItemFromModel(const QModelIndex &proxyIndex);
-    void collectHashesRecursive(QStandardItem* parent, QStringList &hashes);
-    void refreshDuplicateStatus(const QString &hash);
+    void collectHashesRecursive(QStandardItem* parent, QList<FileHash> &hashes);
+    void refreshDuplicateStatus(const FileHash &hash);
 
     bool finishDialog();
     [[nodiscard]] QStringList getUnresolvedDuplicateNames();
@@ -59,7 +61,7 @@ private:
                                           QMap<int, bool>& groupHasSelection,
                                           QMap<int, QString>& groupExampleName);
 
-    void collectItemsByHashRecursive(QStandardItem* parent, const QString &hash, QList<QStandardItem*> &result);
+    void collectItemsByHashRecursive(QStandardItem* parent, const FileHash &hash, QList<QStandardItem*> &result);
     void deleteItemPhysically(const QModelIndex &proxyIndex);
     [[nodiscard]] QStringList getUnrecognizedFiles(const QString &folderPath);
 
@@ -0,0 +1,241 @@
+#include "samplehash.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace {
+    constexpr quint64 kPrime32_1 = 0x9E3779B1U;
+    constexpr quint64 kPrime32_2 = 0x85EBCA77U;
+    constexpr quint64 kPrime32_3 = 0xC2B2AE3DU;
+    constexpr quint64 kPrime64_1 = 0x9E3779B185EBCA87ULL;
+    constexpr quint64 kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr quint64 kPrime64_3 = 0x165667B19E3779F9ULL;
+    constexpr quint64 kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr quint64 kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+    constexpr int kLanes = 8;
+    constexpr qsizetype kStripeSize = kLanes * sizeof(quint64); // 64 bytes, a sample window is 5 stripes
+
+    // Mixing keys: the xxHash3 default secret
+    alignas(8) constexpr uchar kSecret[192] = {
+        0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+        0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+        0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+        0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+        0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+        0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+        0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+        0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+        0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+        0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+        0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+        0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+    };
+    constexpr qsizetype kSecretConsumeRate = 8; // The key of the next stripe starts 8 bytes further
+    constexpr int kStripesPerBlock = int((sizeof(kSecret) - kStripeSize) / kSecretConsumeRate); // 16
+
+    /**
+     * @brief 8 independent 64-bit lanes, updated one 64-byte stripe at a time.
+     *
+     * As in xxHash3, every stripe of a block is mixed with its own key (a window of
+     * the secret that moves by kSecretConsumeRate per stripe), and the lanes are
+     * scrambled after each block of kStripesPerBlock stripes. The hash therefore
+     * depends on where a stripe is, not only on which stripes there are.
+     *
+     * The lanes do not depend on each other, so the loop in stripe() compiles to
+     * SIMD code (SSE2/AVX2/NEON) without any intrinsics.
+     */
+    class Accumulator {
+    public:
+        void update(const uchar *data, qsizetype length) {
+            while (length >= kStripeSize) {
+                stripe(data);
+                data += kStripeSize;
+                length -= kStripeSize;
+            }
+            if (length > 0) {
+                // Zero padded; the padding is told apart by the file size in digest()
+                alignas(kStripeSize) uchar last[kStripeSize] = {};
+                std::memcpy(last, data, length);
+                stripe(last);
+            }
+        }
+
+        [[nodiscard]] quint64 digest(qint64 fileSize) const {
+            quint64 hash = static_cast<quint64>(fileSize) * kPrime64_1;
+            for (int i = 0; i < kLanes; ++i) {
+                hash ^= std::rotl(acc_m[i] * kPrime64_2, 31) * kPrime64_1;
+                hash = hash * kPrime64_1 + kPrime64_4;
+            }
+
+            // Avalanche
+            hash ^= hash >> 37;
+            hash *= 0x165667919E3779F9ULL;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+    private:
+        void stripe(const uchar *data) {
+            const uchar *secret = kSecret + stripeInBlock_m * kSecretConsumeRate;
+            for (int i = 0; i < kLanes; ++i) {
+                const quint64 value = qFromLittleEndian<quint64>(data + i * sizeof(quint64));
+                const quint64 key = value ^ qFromLittleEndian<quint64>(secret + i * sizeof(quint64));
+                acc_m[i ^ 1] += value;
+                acc_m[i] += (key & 0xFFFFFFFFULL) * (key >> 32);
+            }
+
+            if (++stripeInBlock_m == kStripesPerBlock) {
+                scramble();
+                stripeInBlock_m = 0;
+            }
+        }
+
+        void scramble() {
+            const uchar *secret = kSecret + sizeof(kSecret) - kStripeSize;
+            for (int i = 0; i < kLanes; ++i) {
+                quint64 lane = acc_m[i];
+                lane ^= lane >> 47;
+                lane ^= qFromLittleEndian<quint64>(secret + i * sizeof(quint64));
+                acc_m[i] = lane * kPrime32_1;
+            }
+        }
+
+        alignas(kStripeSize) quint64 acc_m[kLanes] = {
+            kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3, kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1
+        };
+        int stripeInBlock_m{0};
+    };
+
+    constexpr qint64 kReadBlockSize = 1024 * 1024; // Multiple of kStripeSize
+
+    [[nodiscard]] quint64 finalHash(const Accumulator &accumulator, qint64 fileSize) {
+        const quint64 hash = accumulator.digest(fileSize);
+        return hash == SampleHash::kEmptyFileHash ? 1 : hash; // Keep 0 reserved for empty files
+    }
+}
+
+/**
+ * @brief Hashes the sample windows of a file through a read-only memory map.
+ *
+ * Files up to kSampleCount * kSampleSize bytes are hashed completely. If the file
+ * cannot be mapped (e.g. no address space left on 32-bit systems), the windows are
+ * read into a stack buffer instead; the result is the same.
+ */
+quint64 SampleHash::calculate(const QString &filePath, bool *ok)
+{
+    if (ok) *ok = false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) [[unlikely]] {
+        return kEmptyFileHash;
+    }
+
+    const qint64 fileSize = file.size();
+    if (fileSize == 0) {
+        if (ok) *ok = true;
+        return kEmptyFileHash;
+    }
+
+    Accumulator accumulator;
+
+    if (uchar *data = file.map(0, fileSize)) {
+        if (fileSize <= kWholeFileLimit) {
+            accumulator.update(data, fileSize);
+        } else {
+            for (int i = 0; i < kSampleCount; ++i) {
+                accumulator.update(data + sampleOffset(fileSize, i), kSampleSize);
+            }
+        }
+        file.unmap(data);
+    } else {
+        std::array<uchar, kWholeFileLimit> buffer;
+        char *target = reinterpret_cast<char *>(buffer.data());
+
+        if (fileSize <= kWholeFileLimit) {
+            if (file.read(target, fileSize) != fileSize) return kEmptyFileHash;
+            accumulator.update(buffer.data(), fileSize);
+        } else {
+            for (int i = 0; i < kSampleCount; ++i) {
+                if (!file.seek(sampleOffset(fileSize, i)) || file.read(target, kSampleSize) != kSampleSize) {
+                    return kEmptyFileHash;
+                }
+                accumulator.update(buffer.data(), kSampleSize);
+            }
+        }
+    }
+
+    if (ok) *ok = true;
+    return finalHash(accumulator, fileSize);
+}
+
+QString SampleHash::calculateHex(const QString &filePath)
+{
+    bool ok = false;
+    const quint64 hash = calculate(filePath, &ok);
+    return ok ? toHex(hash) : QString();
+}
+
+/**
+ * @brief Hashes the whole file with the same accumulator as calculate().
+ *
+ * The stripe keys and scrambles follow the position in the file, so moved or
+ * swapped content changes the hash just like changed bytes do.
+ * Every block except the last is a multiple of the stripe size, so the blocks can
+ * be fed one after another without keeping any remainder.
+ */
+quint64 SampleHash::calculateFull(const QString &filePath, bool *ok)
+{
+    if (ok) *ok = false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) [[unlikely]] {
+        return kEmptyFileHash;
+    }
+
+    const qint64 fileSize = file.size();
+    if (fileSize == 0) {
+        if (ok) *ok = true;
+        return kEmptyFileHash;
+    }
+
+    QByteArray block(qMin(fileSize, kReadBlockSize), Qt::Uninitialized);
+    Accumulator accumulator;
+
+    qint64 remaining = fileSize;
+    while (remaining > 0) {
+        const qint64 wanted = qMin(remaining, kReadBlockSize);
+        if (file.read(block.data(), wanted) != wanted) {
+            return kEmptyFileHash; // Truncated while reading or read error
+        }
+        accumulator.update(reinterpret_cast<const uchar *>(block.constData()), wanted);
+        remaining -= wanted;
+    }
+
+    if (ok) *ok = true;
+    return finalHash(accumulator, fileSize);
+}
+
+QString SampleHash::calculateFullHex(const QString &filePath)
+{
+    bool ok = false;
+    const quint64 hash = calculateFull(filePath, &ok);
+    return ok ? toHex(hash) : QString();
+}
+
+QString SampleHash::toHex(quint64 hash)
+{
+    static constexpr char digits[] = "0123456789ABCDEF";
+
+    QString hex(16, Qt::Uninitialized);
+    QChar *out = hex.data();
+    for (int i = 15; i >= 0; --i) {
+        out[i] = QLatin1Char(digits[hash & 0xF]);
+        hash >>= 4;
+    }
+    return hex;
+}
@@ -0,0 +1,59 @@
+#ifndef SAMPLEHASH_H
+#define SAMPLEHASH_H
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Fast identity hash for media files (replaces FNV1a::calculate).
+ *
+ * Like FNV1a, only 10 windows of 320 bytes spread evenly over the file are hashed
+ * (small files completely), together with the file size. The file is memory-mapped,
+ * so the windows are read straight from the page cache without any allocation,
+ * and the windows are hashed with an xxHash3-style 8-lane accumulator that the
+ * compiler can vectorise. Like in xxHash3, each stripe is keyed by its position,
+ * so the same bytes in a different order hash differently.
+ *
+ * The result is NOT compatible with FNV1a hashes; databases written with FNV1a
+ * are re-hashed in the background (see DatabaseManager::resetFileHashes()).
+ */
+class SampleHash
+{
+public:
+    static constexpr int kSampleCount = 10;
+    static constexpr qint64 kSampleSize = 320;
+    static constexpr qint64 kWholeFileLimit = kSampleCount * kSampleSize; // Smaller files are hashed completely
+    static constexpr quint64 kEmptyFileHash = 0; // Never returned for files with content
+
+    // Stored in the settings table, so existing hashes can be migrated when it changes
+    static constexpr const char *kAlgorithmName = "sample-xxh3-v2";
+
+    /**
+     * @brief Hashes the sample windows of a file.
+     * @param ok Set to false if the file could not be opened or read.
+     * @return The hash, kEmptyFileHash for empty files and on errors.
+     */
+    [[nodiscard]] static quint64 calculate(const QString &filePath, bool *ok = nullptr);
+
+    // Same as calculate(), formatted as 16 uppercase hex digits; empty string on errors
+    [[nodiscard]] static QString calculateHex(const QString &filePath);
+
+    /**
+     * @brief Hashes the complete content of a file, read sequentially in 1 MiB blocks.
+     *
+     * Used to verify files whose sampled hashes collide. For files up to
+     * kWholeFileLimit bytes the result equals calculate().
+     * @param ok Set to false if the file could not be opened or read.
+     */
+    [[nodiscard]] static quint64 calculateFull(const QString &filePath, bool *ok = nullptr);
+    [[nodiscard]] static QString calculateFullHex(const QString &filePath);
+
+    [[nodiscard]] static QString toHex(quint64 hash);
+
+    // Offset of sample window i (0 ... kSampleCount - 1) in a file of fileSize bytes
+    [[nodiscard]] static constexpr qint64 sampleOffset(qint64 fileSize, int i) {
+        return fileSize > kSampleSize ? (fileSize - kSampleSize) * i / (kSampleCount - 1) : 0;
+    }
+};
+
+#endif // SAMPLEHASH_H
@@ -0,0 +1,97 @@
+#include "scanrecords.h"
+
+void ScanRecords::reserve(qsizetype files) {
+    directoryIds_m.reserve(files);
+    nameEnds_m.reserve(files);
+    sizes_m.reserve(files);
+    modified_m.reserve(files);
+    hashes_m.reserve(files);
+    groupIds_m.reserve(files);
+    statuses_m.reserve(files);
+}
+
+void ScanRecords::append(const ScanBatch &file) {
+    // Files arrive folder by folder, so the last folder is almost always the right one
+    const int last = directories_m.size() - 1;
+    directoryIds_m.append(last >= 0 && directories_m.at(last) == file.directory ? last : internDirectory(file.directory));
+
+    namePool_m.append(file.fileName);
+    nameEnds_m.append(namePool_m.size());
+    sizes_m.append(file.size);
+    modified_m.append(file.modified);
+    hashes_m.append(file.hash);
+    groupIds_m.append(file.groupId);
+    statuses_m.append(static_cast<qint8>(file.status));
+    if (file.song)
+        songs_m.insert(statuses_m.size() - 1, *file.song);
+}
+
+void ScanRecords::append(const ScanRecords &other) {
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
+
+    // Folder ids of other are only valid in other
+    QList<int> mapped(other.directories_m.size());
+    for (qsizetype id = 0; id < other.directories_m.size(); ++id) {
+        mapped[id] = internDirectory(other.directories_m.at(id));
+    }
+
+    reserve(size() + other.size());
+    const qsizetype fileOffset = size();
+    const qsizetype nameOffset = namePool_m.size();
+    namePool_m.append(other.namePool_m);
+
+    for (qsizetype i = 0; i < other.size(); ++i) {
+        directoryIds_m.append(mapped.at(other.directoryIds_m.at(i)));
+        nameEnds_m.append(nameOffset + other.nameEnds_m.at(i));
+    }
+    sizes_m.append(other.sizes_m);
+    modified_m.append(other.modified_m);
+    hashes_m.append(other.hashes_m);
+    groupIds_m.append(other.groupIds_m);
+    statuses_m.append(other.statuses_m);
+    for (auto it = other.songs_m.cbegin(); it != other.songs_m.cend(); ++it) {
+        songs_m.insert(fileOffset + it.key(), it.value());
+    }
+}
+
+ScanBatch ScanRecords::at(qsizetype i) const {
+    ScanBatch file;
+    file.directory = directories_m.at(directoryIds_m.at(i));
+    file.fileName = fileName(i);
+    file.size = sizes_m.at(i);
+    file.modified = modified_m.at(i);
+    file.hash = hashes_m.at(i);
+    file.groupId = groupIds_m.at(i);
+    file.status = statuses_m.at(i);
+    file.song = song(i);
+    return file;
+}
+
+std::optional<ImportSong> ScanRecords::song(qsizetype i) const {
+    const auto it = songs_m.constFind(i);
+    if (it == songs_m.cend()) return std::nullopt;
+    return it.value();
+}
+
+QString ScanRecords::fileName(qsizetype i) const {
+    const qsizetype begin = i > 0 ? nameEnds_m.at(i - 1) : 0;
+    return namePool_m.mid(begin, nameEnds_m.at(i) - begin);
+}
+
+QString ScanRecords::filePath(qsizetype i) const {
+    const QString &directory = directories_m.at(directoryIds_m.at(i));
+    return directory.endsWith(u'/') ? directory + fileName(i) : directory + u'/' + fileName(i);
+}
+
+int ScanRecords::internDirectory(const QString &path) {
+    const auto it = directoryLookup_m.constFind(path);
+    if (it != directoryLookup_m.cend()) return it.value();
+
+    const int id = directories_m.size();
+    directories_m.append(path);
+    directoryLookup_m.insert(path, id);
+    return id;
+}
@@ -0,0 +1,78 @@
+#ifndef SCANRECORDS_H
+#define SCANRECORDS_H
+
+#include "sonarstructs.h"
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+/**
+ * @brief Result table of a scan, stored column by column (struct of arrays).
+ *
+ * A scan of a large library keeps hundreds of thousands of files in memory and hands
+ * them across threads. Instead of one QFileInfo per file (shared data, cached stat
+ * fields and several copies of the path), every folder path is stored once and
+ * referenced by its index, and all file names share one string pool. A file costs
+ * about 50 bytes plus the characters of its name; the songs parsed from Guitar Pro
+ * headers are kept apart, by file index.
+ *
+ * All columns are implicitly shared Qt containers, so passing a ScanRecords through a
+ * queued signal copies no per-file data.
+ */
+class ScanRecords {
+public:
+    void reserve(qsizetype files);
+    void append(const ScanBatch &file);
+    void append(const ScanRecords &other);
+
+    [[nodiscard]] qsizetype size() const { return statuses_m.size(); }
+    [[nodiscard]] bool isEmpty() const { return statuses_m.isEmpty(); }
+
+    // Expands one record (allocates the strings); prefer the column accessors in loops
+    [[nodiscard]] ScanBatch at(qsizetype i) const;
+
+    [[nodiscard]] int directoryId(qsizetype i) const { return directoryIds_m.at(i); }
+    [[nodiscard]] const QString &directoryPath(int directoryId) const { return directories_m.at(directoryId); }
+    [[nodiscard]] qsizetype directoryCount() const { return directories_m.size(); }
+
+    [[nodiscard]] QString fileName(qsizetype i) const;
+    [[nodiscard]] QString filePath(qsizetype i) const;
+    [[nodiscard]] qint64 fileSize(qsizetype i) const { return sizes_m.at(i); }
+    [[nodiscard]] qint64 modified(qsizetype i) const { return modified_m.at(i); }
+    [[nodiscard]] const FileHash &hash(qsizetype i) const { return hashes_m.at(i); }
+    [[nodiscard]] int groupId(qsizetype i) const { return groupIds_m.at(i); }
+    [[nodiscard]] int status(qsizetype i) const { return statuses_m.at(i); }
+    [[nodiscard]] std::optional<ImportSong> song(qsizetype i) const;
+
+    void setHash(qsizetype i, const FileHash &hash) { hashes_m[i] = hash; }
+    void setGroupId(qsizetype i, int groupId) { groupIds_m[i] = groupId; }
+    void setStatus(qsizetype i, int status) { statuses_m[i] = static_cast<qint8>(status); }
+
+private:
+    [[nodiscard]] int internDirectory(const QString &path);
+
+    QStringList directories_m;
+    QHash<QString, int> directoryLookup_m; // Path -> index in directories_m
+    QString namePool_m;                    // All file names, back to back
+
+    // One entry per file
+    QList<int> directoryIds_m;
+    QList<qsizetype> nameEnds_m; // End of the name in namePool_m; it starts at the previous end
+    QList<qint64> sizes_m;
+    QList<qint64> modified_m;
+    QList<FileHash> hashes_m;
+    QList<int> groupIds_m;
+    QList<qint8> statuses_m; // FileStatus
+
+    // Sparse: only Guitar Pro files the scan parsed have a song
+    QHash<qsizetype, ImportSong> songs_m;
+};
+
+Q_DECLARE_METATYPE(ScanRecords)
+
+#endif // SCANRECORDS_H
@@ -0,0 +1,77 @@
+#include "schemamigrator.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include <utility>
+
+void SchemaMigrator::addStep(int version, const QString &description, std::function<bool()> apply) {
+    Q_ASSERT(steps_m.isEmpty() || version > steps_m.constLast().version);
+    steps_m.append({version, description, std::move(apply)});
+}
+
+int SchemaMigrator::currentVersion() const {
+    QSqlQuery q(db_m);
+    if (!q.exec("PRAGMA user_version") || !q.next()) {
+        qCritical() << "[SchemaMigrator] user_version error: " << q.lastError().text();
+        return -1;
+    }
+    return q.value(0).toInt();
+}
+
+bool SchemaMigrator::migrate() {
+    report_m.clear();
+
+    const int version = currentVersion();
+    if (version < 0) return false;
+
+    if (version > targetVersion()) {
+        // Written by a newer release; its additions are unknown here but do not hurt
+        qWarning() << "[SchemaMigrator] database version" << version << "is newer than" << targetVersion();
+        return true;
+    }
+
+    for (const Step &step : std::as_const(steps_m)) {
+        if (step.version <= version) continue;
+        if (!runStep(step)) return false;
+    }
+    return true;
+}
+
+bool SchemaMigrator::runStep(const Step &step) {
+    QElapsedTimer timer;
+    timer.start();
+
+    bool ok = db_m.transaction();
+    if (!ok) {
+        qCritical() << "[SchemaMigrator] step" << step.version << "could not start transaction: "
+                    << db_m.lastError().text();
+    } else {
+        QSqlQuery q(db_m);
+        // PRAGMA user_version cannot be used with bind values
+        ok = step.apply() && q.exec(QString("PRAGMA user_version = %1").arg(step.version));
+        if (!ok && q.lastError().isValid()) {
+            qCritical() << "[SchemaMigrator] step" << step.version << "user_version error: " << q.lastError().text();
+        }
+        q.finish();
+        if (ok) {
+            ok = db_m.commit();
+        } else {
+            db_m.rollback();
+        }
+    }
+
+    const qint64 elapsedMs = timer.elapsed();
+    report_m.append({step.version, step.description, elapsedMs, ok});
+
+    if (ok) {
+        qInfo().noquote() << QString("[SchemaMigrator] step %1 (%2) applied in %3 ms")
+                                 .arg(step.version).arg(step.description).arg(elapsedMs);
+    } else {
+        qCritical().noquote() << QString("[SchemaMigrator] step %1 (%2) failed after %3 ms, rolled back")
+                                     .arg(step.version).arg(step.description).arg(elapsedMs);
+    }
+    return ok;
+}
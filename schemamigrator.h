@@ -0,0 +1,56 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QList>
+#include <QSqlDatabase>
+#include <QString>
+
+#include <functional>
+
+/**
+ * @brief Brings a database schema up to date, one numbered step after the other.
+ *
+ * The schema version is PRAGMA user_version. migrate() applies every step whose
+ * version is higher than the stored one, in ascending order. Each step runs in its
+ * own transaction together with the update of user_version, so a failing step leaves
+ * the database at the previous version and the next start tries again.
+ *
+ * Steps must be idempotent (CREATE ... IF NOT EXISTS, conversions that check the
+ * current state first): a fresh database gets the complete schema in step 1 and runs
+ * the later steps on top of it.
+ */
+class SchemaMigrator {
+public:
+    struct StepReport {
+        int version{0};
+        QString description;
+        qint64 elapsedMs{0};
+        bool ok{false};
+    };
+
+    explicit SchemaMigrator(const QSqlDatabase &db) : db_m(db) {}
+
+    // Versions must be added in ascending order; apply() runs inside the step's transaction
+    void addStep(int version, const QString &description, std::function<bool()> apply);
+
+    [[nodiscard]] int currentVersion() const; // -1 if it cannot be read
+    [[nodiscard]] int targetVersion() const { return steps_m.isEmpty() ? 0 : steps_m.constLast().version; }
+
+    [[nodiscard]] bool migrate();
+    [[nodiscard]] const QList<StepReport> &report() const { return report_m; } // Steps run by migrate()
+
+private:
+    struct Step {
+        int version{0};
+        QString description;
+        std::function<bool()> apply;
+    };
+
+    [[nodiscard]] bool runStep(const Step &step);
+
+    QSqlDatabase db_m;
+    QList<Step> steps_m;
+    QList<StepReport> report_m;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,44 @@
+#include "settingscache.h"
+
+#include <QMutexLocker>
+
+bool SettingsCache::isLoaded() const {
+    QMutexLocker locker(&mutex_m);
+    return loaded_m;
+}
+
+bool SettingsCache::load(const std::function<bool (QHash<QString, QString> &)> &read) {
+    QMutexLocker locker(&mutex_m);
+    if (loaded_m) return true;
+
+    QHash<QString, QString> values;
+    if (!read(values)) return false;
+
+    values_m = values;
+    loaded_m = true;
+    return true;
+}
+
+void SettingsCache::clear() {
+    QMutexLocker locker(&mutex_m);
+    values_m.clear();
+    loaded_m = false;
+}
+
+std::optional<QString> SettingsCache::value(const QString &key) const {
+    QMutexLocker locker(&mutex_m);
+    const auto it = values_m.constFind(key);
+    if (!loaded_m || it == values_m.cend()) return std::nullopt;
+    return it.value();
+}
+
+bool SettingsCache::insert(const QString &key, const QString &value) {
+    QMutexLocker locker(&mutex_m);
+    if (!loaded_m) return true; // The next load reads it from the table
+
+    const auto it = values_m.find(key);
+    if (it != values_m.end() && it.value() == value) return false;
+
+    values_m.insert(key, value);
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef SETTINGSCACHE_H
+#define SETTINGSCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+#include <optional>
+
+/**
+ * @brief In-memory copy of the settings table (key -> text value).
+ *
+ * DatabaseManager loads all rows on the first read and writes every setSetting()
+ * through to it, so reading a setting never reaches SQLite. The cache is shared by
+ * the GUI thread and the DatabaseWorker threads, hence the mutex.
+ *
+ * load() reads under the same lock insert() takes. A write committed while the rows
+ * are read is therefore either part of the read or inserted after it, never lost.
+ */
+class SettingsCache {
+public:
+    [[nodiscard]] bool isLoaded() const;
+    // Fills the cache with the rows read() returns; false (and still unloaded) if read() fails
+    [[nodiscard]] bool load(const std::function<bool (QHash<QString, QString> &)> &read);
+    void clear(); // Forgets the content, the next read loads it again
+
+    [[nodiscard]] std::optional<QString> value(const QString &key) const;
+    // Returns whether the value of key changed (always true while unloaded)
+    bool insert(const QString &key, const QString &value);
+
+private:
+    mutable QMutex mutex_m;
+    QHash<QString, QString> values_m;
+    bool loaded_m{false};
+};
+
+#endif // SETTINGSCACHE_H
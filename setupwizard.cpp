@@ -19,6 +19,8 @@ SetupWizard::SetupWizard(QWidget *parent)
     : QWizard(parent)
 {
     fileScanner_m = new FileScanner(); // without this, no parent use in a thread
+    fileScanner_m->setStreamingBatchSize(250); // ReviewPage fills the tree while hashing
+    fileScanner_m->setParseMetadata(true);       // The import does not open the tabs again
     scannerThread_m = new QThread(this);
     fileScanner_m->moveToThread(scannerThread_m);
 
@@ -77,6 +79,10 @@ void SetupWizard::setupConnections() {
         QMessageBox::aboutQt(nullptr);
     });
 
+    connect(fileScanner_m, &FileScanner::scanCacheUpdated, this, [this](const ScanCache &entries) {
+        scanCacheUpdates_m.insert(entries);
+    });
+
     connect(scannerThread_m, &QThread::finished, fileScanner_m, &QObject::deleteLater);
     scannerThread_m->start();
 }
@@ -90,10 +96,21 @@ void SetupWizard::setProxyModelHeader() {
 void SetupWizard::prepareScannerWithDatabaseData() {
     // If the database exists, load hashes
     auto &db = DatabaseManager::instance();
-    QSet<QString> knwonHahes = db.getAllFileHashes();
+    QSet<quint64> knwonHahes = db.getAllFileHashes();
     if (fileScanner_m) {
         fileManager_m->setExistingHashes(knwonHahes);
+        fileScanner_m->setScanCache(db.loadScanCache());
+    }
+}
+
+// Esc, Cancel and the close button end up here; a running import is canceled first,
+// the wizard stays open until it has been undone
+void SetupWizard::reject() {
+    if (mappingPage_m && mappingPage_m->isImporting()) {
+        mappingPage_m->cancelImport();
+        return;
     }
+    QWizard::reject();
 }
 
 void SetupWizard::restartApp() {
@@ -4,6 +4,8 @@
 #include <QWizard>
 #include <QStandardItemModel>
 
+#include "sonarstructs.h"
+
 class FileManager;
 class FileScanner;
 class FileFilterProxyModel;
@@ -45,8 +47,12 @@ public:
 
     void prepareScannerWithDatabaseData();
 
+    // Hashes computed during the review scan, MappingPage stores them in the new database
+    [[nodiscard]] ScanCache scanCacheUpdates() const { return scanCacheUpdates_m; }
+
 public slots:
     void restartApp();
+    void reject() override;
 
 private:
     void setupUiLayout();
@@ -72,6 +78,7 @@ private:
 
     QStringList sourcePaths_m;
     QStringList activeFilters_m;
+    ScanCache scanCacheUpdates_m;
 };
 
 #endif
@@ -17,7 +17,7 @@
 #include "fileutils.h"
 #include "uihelper.h"
 #include "songeditdialog.h"
-#include "fnv1a.h"
+#include "samplehash.h"
 
 #include <QCalendarWidget>
 #include <QComboBox>
@@ -424,12 +424,8 @@ void SonarLessonPage::onEditSongClicked() {
     // 2. Dialog
     SongEditDialog dialog(this);
 
-    // 3. Retrieve lists from the database for the dropdowns.
-    QStringList artists = dbManager_m->getAllArtists();
-    QStringList tunings = dbManager_m->getAllTunings();
-
-    // 4. Pass data to dialog
-    dialog.setSongData(title, artist, tuning, bpm, artists, tunings);
+    // 3. + 4. Pass data and the artist/tuning lists (kept in memory by the DatabaseManager) to dialog
+    dialog.setSongData(title, artist, tuning, bpm, dbManager_m->artistModel(), dbManager_m->tuningModel());
 
     // 5. Show dialog
     if (dialog.exec() == QDialog::Accepted) {
@@ -629,9 +625,19 @@ void SonarLessonPage::onEditReminder(int reminderId, const QString title) {
 }
 
 void SonarLessonPage::updateReminderTable(const QDate &date)
+{
+    // Evaluated on a read connection, so it does not wait for a journal autosave
+    const quint64 request = ++reminderRequest_m;
+    dbManager_m->getRemindersForDateAsync(date).then(this, [this, request](const QVariantList &reminders) {
+        if (request == reminderRequest_m) {
+            fillReminderTable(reminders);
+        }
+    });
+}
+
+void SonarLessonPage::fillReminderTable(const QVariantList &reminders)
 {
     reminderTable_m->setRowCount(0);
-    auto reminders = dbManager_m->getRemindersForDate(date);
 
     for (const auto &ref : std::as_const(reminders)) {
         QVariantMap r = ref.toMap();
@@ -962,6 +968,9 @@ void SonarLessonPage::sitesConnects() {
 
     connect(saveBtn_m, &QPushButton::pressed, this, &SonarLessonPage::onSaveClicked);
 
+    // Highlights are loaded per page, so load them when another month is shown
+    connect(calendar_m, &QCalendarWidget::currentPageChanged, this, &SonarLessonPage::updateCalendarHighlights);
+
     connect(calendar_m, &QCalendarWidget::selectionChanged, this, [this]() {
         // Retrieve the newly selected date from the calendar.
         QDate selectedDate = calendar_m->selectedDate();
@@ -1617,24 +1626,49 @@ int SonarLessonPage::getCurrentFileId() {
 
 // Calendar update Overload
 void SonarLessonPage::updateCalendarHighlights() {
-    QTextCharFormat hasDataFormat;
-    hasDataFormat.setBackground(QColor(60, 100, 60)); // Dark green for experienced days
-    hasDataFormat.setFontWeight(QFont::Bold);
+    // Only the page on display: the 6 x 7 grid starts in the week before the 1st
+    // (a full week if the 1st is the first day of a week)
+    const QDate first(calendar_m->yearShown(), calendar_m->monthShown(), 1);
+    const int leading = (first.dayOfWeek() - int(calendar_m->firstDayOfWeek()) + 7) % 7;
+    const QDate from = first.addDays(-(leading == 0 ? 7 : leading));
+    const QDate to = from.addDays(6 * 7 - 1);
+
+    // Days, songs, repetitions and BPM of the whole page in one query, run on the
+    // background connection; the page keeps its old highlights until the result is there
+    const int year = calendar_m->yearShown();
+    const int month = calendar_m->monthShown();
+    dbManager_m->getPracticeCalendarAsync(from, to).then(this, [this, year, month](const QMap<QDate, PracticeDay> &days) {
+        // Turned to another page meanwhile; its own update is queued behind this one
+        if (calendar_m->yearShown() != year || calendar_m->monthShown() != month)
+            return;
 
-    // Retrieve all days on which exercise entries exist.
-    QList<QDate> allDates = dbManager_m->getAllPracticeDates();
+        QTextCharFormat hasDataFormat;
+        hasDataFormat.setBackground(QColor(60, 100, 60)); // Dark green for experienced days
+        hasDataFormat.setFontWeight(QFont::Bold);
 
-    for (const QDate &date : std::as_const(allDates)) {
-        // Generate the tooltip content
-        QString summary = dbManager_m->getPracticeSummaryForDay(date);
+        // Entries may have been removed since the last update
+        calendar_m->setDateTextFormat(QDate(), QTextCharFormat());
 
-        // Copy format and set tooltip
-        QTextCharFormat dayFormat = hasDataFormat;
-        dayFormat.setToolTip(summary);
+        for (auto it = days.cbegin(); it != days.cend(); ++it) {
+            const PracticeDay &day = it.value();
 
-        // Add to the calendar for this date
-        calendar_m->setDateTextFormat(date, dayFormat);
-    }
+            // Generate the tooltip content
+            QStringList lines;
+            for (const QString &title : day.songTitles) {
+                lines << "• " + title;
+            }
+            if (day.totalReps > 0 || day.maxBpm > 0) {
+                lines << tr("%1 repetitions, up to %2 BPM").arg(day.totalReps).arg(day.maxBpm);
+            }
+
+            // Copy format and set tooltip
+            QTextCharFormat dayFormat = hasDataFormat;
+            dayFormat.setToolTip(lines.join("\n"));
+
+            // Add to the calendar for this date
+            calendar_m->setDateTextFormat(it.key(), dayFormat);
+        }
+    });
 }
 
 void SonarLessonPage::loadTableDataForDay(int songId, QDate date) {
@@ -1899,10 +1933,11 @@ void SonarLessonPage::updateFileHashIfNeeded(int songId) {
     QString currentPath = currentSongPath_m;
 
     if (songId > 0 && QFile::exists(currentPath)) {
-        QString newHash = FNV1a::calculate(currentPath);
+        bool ok = false;
+        const quint64 newHash = SampleHash::calculate(currentPath, &ok);
 
-        if (dbManager_m->updateFileHash(songId, newHash)) {
-            qDebug() << "Hash updated for file: " << currentPath << ", songId: " << songId << ", new Hash: " << newHash;
+        if (ok && dbManager_m->updateFileHash(songId, newHash)) {
+            qDebug() << "Hash updated for file: " << currentPath << ", songId: " << songId << ", new Hash: " << SampleHash::toHex(newHash);
         }
     }
     isFileUsed_m = false;
@@ -92,6 +92,7 @@ private:
     void updateFilterButtonsForFile(const QString& filePath);
 
     void updateReminderTable(const QDate &date);
+    void fillReminderTable(const QVariantList &reminders);
     [[nodiscard]] QString getReminderTooltip(const QVariantMap &item);
 
     [[nodiscard]] int findOrCreateEmptyTableRow();
@@ -178,6 +179,7 @@ private:
     bool isConnectionsEstablished_m{false};
 
     bool reloadingPage_m{false};
+    quint64 reminderRequest_m{0}; // Latest updateReminderTable() call; results of older ones are dropped
     bool isChangingSong_m{false};
 
     // Data
@@ -2,23 +2,147 @@
 #define SONARSTRUCTS_H
 
 #include <QFileInfo>
+#include <QHash>
+#include <QMetaType>
 #include <QStandardItem>
 #include <QString>
 
+#include <bit>
+#include <optional>
+
+// Content identity of a file: the sampled hash (SampleHash::calculate) and, only for
+// files whose sampled hash collided during a scan, the full content hash.
+struct FileHash {
+    quint64 sample{0}; // 0 = empty file or not hashed
+    quint64 full{0};   // 0 = not verified
+
+    [[nodiscard]] bool isValid() const { return sample != 0; }
+    [[nodiscard]] bool isVerified() const { return full != 0; }
+
+    // 16 hex digits (tooltips, logs); verified hashes get the full hash appended
+    [[nodiscard]] QString toString() const {
+        const auto hex = [](quint64 value) { return QString::number(value, 16).rightJustified(16, u'0').toUpper(); };
+        return isVerified() ? hex(sample) + u'/' + hex(full) : hex(sample);
+    }
+
+    // SQLite only knows signed 64-bit integers, the bits are stored unchanged
+    [[nodiscard]] static qint64 toDatabase(quint64 value) { return std::bit_cast<qint64>(value); }
+    [[nodiscard]] static quint64 fromDatabase(const QVariant &value) { return std::bit_cast<quint64>(value.toLongLong()); }
+
+    friend bool operator==(const FileHash &, const FileHash &) = default;
+};
+
+inline size_t qHash(const FileHash &hash, size_t seed = 0) noexcept {
+    return qHashMulti(seed, hash.sample, hash.full);
+}
+
+Q_DECLARE_METATYPE(FileHash)
+
 // Wizard
 struct DuplicateGroup {
-    QString hash;
+    FileHash hash;
     QStringList filePaths;
     qint64 size;
 };
 
+// Import: the song created for an ImportTask (from the Guitar Pro metadata, if any)
+struct ImportSong {
+    QString title;
+    QString artist{"Unknown Artist"};
+    QString tuning{"E-Standard"};
+    int bpm{0};
+};
+
+Q_DECLARE_METATYPE(ImportSong)
+
+// One scanned file. Only used while a file is hashed or handed over; scan results
+// are kept in a ScanRecords table (scanrecords.h).
 struct ScanBatch {
-    QFileInfo info;
-    QString hash;
+    QString directory; // Absolute path of the folder, without trailing separator (except roots)
+    QString fileName;
+    qint64 size{0};
+    qint64 modified{0}; // Modification time, msecs since epoch
+    quint64 inode{0};   // 0 = unknown; not kept in ScanRecords
+    FileHash hash;
     int groupId{0};
     int status{0};
+    std::optional<ImportSong> song; // Guitar Pro header, if the scan parsed it (FileScanner::setParseMetadata())
+
+    [[nodiscard]] QString filePath() const {
+        return directory.endsWith(u'/') ? directory + fileName : directory + u'/' + fileName;
+    }
+
+    [[nodiscard]] static ScanBatch fromFileInfo(const QFileInfo &info) {
+        ScanBatch batch;
+        batch.directory = info.absolutePath();
+        batch.fileName = info.fileName();
+        batch.size = info.size();
+        batch.modified = info.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch();
+        return batch;
+    }
+};
+
+// Outcome of the full content comparison for one file of a streaming scan
+struct DuplicateResolution {
+    FileHash hash; // Including the full hash
+    int groupId{0}; // 0 = only the samples matched, not a duplicate
+};
+
+// Import: one file to import (filled by ImportDialog and MappingPage)
+struct ImportTask {
+    QString sourcePath;     // Full source path (C:/...)
+    QString relativePath;   // Target path relative to the base directory (Ordner/Datei.gp5)
+    QString itemName;       // Display name/File name
+    qint64 fileSize;
+    QString fileSuffix;
+    QString categoryPath; // So that the processor knows where to go (e.g. "Exercises/Technique")
+    FileHash fileHash;    // For your duplicate check
+    std::optional<ImportSong> song; // Parsed by the scan; read from the file during the import otherwise
+};
+
+// Import journal: how far one task of an import got (import_journal.state)
+enum class ImportState {
+    Pending = 0,
+    Copied = 1,   // The file is in the managed folder; song not committed yet
+    Committed = 2 // Song and media file are committed
+};
+
+// Import journal: what the import did to put a file in place (undone when it is discarded)
+enum class ImportFileOperation {
+    None = 0, // Unmanaged import, or the target existed before
+    Copied = 1,
+    Moved = 2
+};
+
+// Import journal: one row of import_journal
+struct ImportJournalEntry {
+    qsizetype task{-1}; // Index into ImportJob::tasks
+    ImportState state{ImportState::Pending};
+    QString targetPath; // Where the file goes; reserved while Pending, before the import creates it
+    ImportFileOperation operation{ImportFileOperation::None};
+    qlonglong songId{0}; // Committed only
+};
+
+// Import journal: an import that has not finished yet (import_jobs)
+struct ImportJob {
+    qlonglong id{0};
+    QString basePath;
+    bool isManaged{false};
+    bool isMoved{false};
+    QList<ImportTask> tasks;
+    QList<ImportJournalEntry> entries; // entries[i] belongs to tasks[i]
+};
+
+// Scan cache: hash of a file as it looked when it was last hashed
+struct ScanCacheEntry {
+    qint64 size{0};
+    qint64 mtime{0};  // Modification time, msecs since epoch
+    quint64 inode{0}; // 0 = unknown (not every directory walker reports it)
+    quint64 hash{0}; // Sampled hash
 };
 
+using ScanCache = QHash<QString, ScanCacheEntry>; // Key: absolute file path
+
 enum Column {
     ColName = 0,
     ColSize,
@@ -33,12 +157,13 @@ enum Column {
 enum ItemRole {
     RoleFileInfo = Qt::UserRole + 1, // The complete QFileInfo object
     RoleFileSizeRaw,                 // qint64 (raw value for calculations)
-    RoleFileHash,                    // QString (The calculated hash)
+    RoleFileHash,                    // FileHash (The calculated hash)
     RoleItemType,                    // int (0 = file, 1 = directroy)
     RoleFileStatus,                  // int (Enum: OK, defect, duplicate)
     RoleFilePath,                    // saves the path
     RoleDuplicateId,                 // Mark groups in the model.
-    RoleIsFolder                     // Stores information about whether this is a folder.
+    RoleIsFolder,                    // Stores information about whether this is a folder.
+    RoleSong                         // ImportSong from the Guitar Pro header; unset if the scan did not parse it
 };
 
 // Additional enum for status (for RoleFileStatus)
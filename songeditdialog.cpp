@@ -49,14 +49,12 @@ void SongEditDialog::setSongData(const QString &title,
                                  const QString &artist,
                                  const QString &tuning,
                                  int bpm,
-                                 const QStringList &allArtists,
-                                 const QStringList &allTunings)
+                                 QAbstractItemModel *allArtists,
+                                 QAbstractItemModel *allTunings)
 {
-    artistCombo_m->clear();
-    artistCombo_m->addItems(allArtists);
-
-    tuningCombo_m->clear();
-    tuningCombo_m->addItems(allTunings);
+    // Shared models (DatabaseManager); NoInsert keeps typed names out of them
+    artistCombo_m->setModel(allArtists);
+    tuningCombo_m->setModel(allTunings);
 
     titleEdit_m->setText(title);
     artistCombo_m->setEditText(artist);
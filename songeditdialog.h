@@ -5,7 +5,6 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QSpinBox>
-#include <QStringList>
 
 class SongEditDialog : public QDialog {
     Q_OBJECT
@@ -17,8 +16,8 @@ public:
                      const QString &artist,
                      const QString &tuning,
                      int bpm,
-                     const QStringList &allArtists,
-                     const QStringList &allTunings);
+                     QAbstractItemModel *allArtists,
+                     QAbstractItemModel *allTunings);
 
     [[nodiscard]] QString title() const { return titleEdit_m->text(); }
     [[nodiscard]] QString artist() const { return artistCombo_m->currentText(); }
@@ -0,0 +1,76 @@
+#include "statementcache.h"
+
+#include <QMutexLocker>
+
+#include <utility>
+
+StatementCache::Handle::Handle(StatementCache *cache, QSharedPointer<Entry> entry)
+    : cache_m(cache), entry_m(std::move(entry)), query_m(&entry_m->query) {}
+
+StatementCache::Handle::Handle(QSqlQuery &&uncached)
+    : uncached_m(QSharedPointer<QSqlQuery>::create(std::move(uncached))), query_m(uncached_m.data()) {}
+
+StatementCache::Handle::Handle(Handle &&other) noexcept
+    : cache_m(std::exchange(other.cache_m, nullptr)),
+      entry_m(std::move(other.entry_m)),
+      uncached_m(std::move(other.uncached_m)),
+      query_m(std::exchange(other.query_m, nullptr)) {}
+
+StatementCache::Handle::~Handle() {
+    if (!query_m) return; // Moved from
+
+    query_m->finish(); // Reset the statement, keep it prepared
+    if (cache_m && entry_m) {
+        cache_m->release(*entry_m);
+    }
+}
+
+StatementCache::Handle StatementCache::acquire(const QSqlDatabase &db, const QString &sql) {
+    QMutexLocker locker(&mutex_m);
+
+    QHash<QString, QSharedPointer<Entry>> &statements = statements_m[db.connectionName()];
+    const QSharedPointer<Entry> cached = statements.value(sql);
+    if (cached && !cached->inUse) {
+        cached->inUse = true;
+        hits_m++;
+        return Handle(this, cached);
+    }
+
+    misses_m++;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql) || cached) {
+        return Handle(std::move(query)); // Failed (not cached) or the cached one is busy
+    }
+
+    auto entry = QSharedPointer<Entry>::create();
+    entry->query = std::move(query);
+    entry->inUse = true;
+    statements.insert(sql, entry);
+    return Handle(this, entry);
+}
+
+void StatementCache::clear(const QString &connectionName) {
+    QMutexLocker locker(&mutex_m);
+    statements_m.remove(connectionName);
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    QMutexLocker locker(&mutex_m);
+    qsizetype statements = 0;
+    for (const auto &perConnection : statements_m) {
+        statements += perConnection.size();
+    }
+    return {hits_m, misses_m, statements};
+}
+
+void StatementCache::resetStats() {
+    QMutexLocker locker(&mutex_m);
+    hits_m = 0;
+    misses_m = 0;
+}
+
+void StatementCache::release(Entry &entry) {
+    QMutexLocker locker(&mutex_m);
+    entry.inUse = false;
+}
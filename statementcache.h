@@ -0,0 +1,76 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+/**
+ * @brief Prepared statements per connection, keyed by their SQL text.
+ *
+ * acquire() prepares a statement on first use and afterwards hands out the same
+ * QSqlQuery again, so SQLite parses and plans it only once. The returned Handle
+ * resets the statement when it goes out of scope; a half-read SELECT would otherwise
+ * keep SQLite's implicit transaction open.
+ *
+ * A statement is only used by one Handle at a time. If the same SQL is acquired again
+ * while its Handle is still alive (nested calls), a separately prepared query is
+ * returned. Statements that fail to prepare are not cached; the Handle then holds the
+ * unprepared query so that exec() reports the error as before.
+ */
+class StatementCache {
+    struct Entry {
+        QSqlQuery query;
+        bool inUse{false};
+    };
+
+public:
+    struct Stats {
+        quint64 hits{0};     // Statement taken from the cache
+        quint64 misses{0};   // Statement had to be prepared
+        qsizetype statements{0};
+    };
+
+    class Handle {
+    public:
+        Handle(Handle &&other) noexcept;
+        Handle(const Handle &) = delete;
+        Handle &operator=(const Handle &) = delete;
+        Handle &operator=(Handle &&) = delete;
+        ~Handle();
+
+        QSqlQuery *operator->() const { return query_m; }
+        QSqlQuery &operator*() const { return *query_m; }
+
+    private:
+        friend class StatementCache;
+        Handle(StatementCache *cache, QSharedPointer<Entry> entry);
+        explicit Handle(QSqlQuery &&uncached);
+
+        StatementCache *cache_m{nullptr};
+        QSharedPointer<Entry> entry_m;
+        QSharedPointer<QSqlQuery> uncached_m;
+        QSqlQuery *query_m{nullptr};
+    };
+
+    [[nodiscard]] Handle acquire(const QSqlDatabase &db, const QString &sql);
+
+    // Must be called before the connection is closed or removed
+    void clear(const QString &connectionName);
+
+    [[nodiscard]] Stats stats() const;
+    void resetStats();
+
+private:
+    void release(Entry &entry);
+
+    mutable QMutex mutex_m;
+    QHash<QString, QHash<QString, QSharedPointer<Entry>>> statements_m; // Connection name -> SQL -> statement
+    quint64 hits_m{0};
+    quint64 misses_m{0};
+};
+
+#endif // STATEMENTCACHE_H